@@ -1,6 +1,7 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "CombaxProjectile.h"
+#include "CombaxProjectilePool.h"
 #include "GameFramework/ProjectileMovementComponent.h"
 #include "Components/SphereComponent.h"
 
@@ -38,6 +39,79 @@ void ACombaxProjectile::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor,
 	{
 		OtherComp->AddImpulseAtLocation(GetVelocity() * 100.0f, GetActorLocation());
 
+		ReleaseProjectile();
+	}
+}
+
+void ACombaxProjectile::ActivateProjectile(const FVector& Location, const FRotator& Rotation)
+{
+	bProjectileActive = true;
+
+	// A replicated pooled projectile sleeps between shots, wake it so the replication graph picks it up again
+	if (GetIsReplicated())
+	{
+		SetNetDormancy(DORM_Awake);
+	}
+
+	SetActorLocationAndRotation(Location, Rotation, false, nullptr, ETeleportType::ResetPhysics);
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+
+	// The movement component lets go of its updated component when it stops, so hand it back
+	ProjectileMovement->SetUpdatedComponent(CollisionComp);
+
+	// Forget how the last shot ended, or it carries on sliding or bouncing off a surface it left long ago
+	ProjectileMovement->bIsSliding = false;
+	ProjectileMovement->PreviousHitTime = 1.f;
+	ProjectileMovement->PreviousHitNormal = FVector::UpVector;
+	ProjectileMovement->ClearPendingForce(true);
+	ProjectileMovement->ResetInterpolation();
+	ProjectileMovement->Velocity = Rotation.Vector() * ProjectileMovement->InitialSpeed;
+	ProjectileMovement->UpdateComponentVelocity();
+	ProjectileMovement->SetComponentTickEnabled(true);
+
+	// Same lifetime as a freshly spawned projectile
+	SetLifeSpan(GetDefault<ACombaxProjectile>(GetClass())->InitialLifeSpan);
+}
+
+void ACombaxProjectile::DeactivateProjectile()
+{
+	bProjectileActive = false;
+	SetLifeSpan(0.0f);
+
+	ProjectileMovement->StopMovementImmediately();
+	ProjectileMovement->SetComponentTickEnabled(false);
+
+	SetActorEnableCollision(false);
+	SetActorHiddenInGame(true);
+
+	// Hidden state goes out one last time, then the projectile costs the replication graph nothing until it is fired again
+	if (GetIsReplicated())
+	{
+		SetNetDormancy(DORM_DormantAll);
+	}
+}
+
+void ACombaxProjectile::ReleaseProjectile()
+{
+	if (UCombaxProjectilePool* Pool = OwningPool.Get())
+	{
+		Pool->Release(this);
+	}
+	else
+	{
 		Destroy();
 	}
+}
+
+void ACombaxProjectile::LifeSpanExpired()
+{
+	if (OwningPool.IsValid())
+	{
+		ReleaseProjectile();
+	}
+	else
+	{
+		Super::LifeSpanExpired();
+	}
 }
\ No newline at end of file
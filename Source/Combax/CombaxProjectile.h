@@ -8,6 +8,7 @@
 
 class USphereComponent;
 class UProjectileMovementComponent;
+class UCombaxProjectilePool;
 
 UCLASS(config=Game)
 class ACombaxProjectile : public AActor
@@ -29,9 +30,29 @@ public:
 	UFUNCTION()
 	void OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
 
+	//** Puts a pooled projectile back into play, launched from Location along Rotation */
+	void ActivateProjectile(const FVector& Location, const FRotator& Rotation);
+
+	//** Hides and stops a pooled projectile until it is activated again */
+	void DeactivateProjectile();
+
+	//** Hands the projectile back to its pool, or destroys it if it didn't come from one */
+	void ReleaseProjectile();
+
+	bool IsProjectileActive() const { return bProjectileActive; }
+
+	void SetOwningPool(UCombaxProjectilePool* Pool) { OwningPool = Pool; }
+
+	virtual void LifeSpanExpired() override;
+
 	//** Returns CollisionComp subobject **/
 	USphereComponent* GetCollisionComp() const { return CollisionComp; }
 	//** Returns ProjectileMovement subobject **/
 	UProjectileMovementComponent* GetProjectileMovement() const { return ProjectileMovement; }
+
+private:
+	TWeakObjectPtr<UCombaxProjectilePool> OwningPool;
+
+	bool bProjectileActive = true;
 };
 
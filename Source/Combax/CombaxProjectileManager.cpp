@@ -0,0 +1,379 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CombaxProjectileManager.h"
+#include "CombaxProjectile.h"
+#include "CombaxProjectileStats.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/SphereComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogCombaxProjectileManager, Log, All);
+
+DECLARE_CYCLE_STAT(TEXT("Lightweight projectiles tick"), STAT_CombaxLightProjectilesTick, STATGROUP_CombaxProjectiles);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Lightweight projectiles"), STAT_CombaxLightProjectiles, STATGROUP_CombaxProjectiles);
+
+// Tick function
+
+void FCombaxProjectileManagerTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Manager && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Manager->Tick(DeltaTime);
+	}
+}
+
+FString FCombaxProjectileManagerTickFunction::DiagnosticMessage()
+{
+	return TEXT("FCombaxProjectileManagerTickFunction");
+}
+
+// Subsystem
+
+bool UCombaxProjectileManager::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld();
+}
+
+void UCombaxProjectileManager::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	QueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(CombaxLightProjectile), false);
+
+	TickFunction.Manager = this;
+	TickFunction.bCanEverTick = true;
+	TickFunction.bStartWithTickEnabled = true;
+	TickFunction.TickGroup = TG_PrePhysics;
+	TickFunction.RegisterTickFunction(InWorld.PersistentLevel);
+}
+
+void UCombaxProjectileManager::Deinitialize()
+{
+	if (TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.UnRegisterTickFunction();
+	}
+	TickFunction.Manager = nullptr;
+
+	Reset();
+	Types.Reset();
+	InstanceComponents.Reset();
+	InstanceActor = nullptr;
+
+	Super::Deinitialize();
+}
+
+void UCombaxProjectileManager::Fire(TSubclassOf<ACombaxProjectile> ProjectileClass, UStaticMesh* Mesh, const FVector& Location, const FRotator& Rotation)
+{
+	const int32 TypeIndex = FindOrAddType(ProjectileClass, Mesh);
+	if (TypeIndex == INDEX_NONE)
+	{
+		return;
+	}
+	const FCombaxProjectileType& Type = Types[TypeIndex];
+
+	FCombaxLightProjectile& Projectile = Projectiles.AddDefaulted_GetRef();
+	Projectile.Location = Location;
+	Projectile.SweepEnd = Location;
+	Projectile.Velocity = Rotation.Vector() * Type.InitialSpeed;
+	Projectile.LifeRemaining = Type.LifeSpan > 0.0f ? Type.LifeSpan : BIG_NUMBER;
+	Projectile.Type = TypeIndex;
+}
+
+void UCombaxProjectileManager::Reset()
+{
+	Projectiles.Reset();
+	UpdateInstances();
+}
+
+void UCombaxProjectileManager::Tick(float DeltaTime)
+{
+	Step(DeltaTime, false);
+}
+
+void UCombaxProjectileManager::TickSynchronous(float DeltaTime)
+{
+	Step(DeltaTime, true);
+}
+
+void UCombaxProjectileManager::Step(float DeltaTime, bool bSynchronous)
+{
+	SCOPE_CYCLE_COUNTER(STAT_CombaxLightProjectilesTick);
+
+	UWorld* World = GetWorld();
+	const float GravityZ = World->GetGravityZ();
+	FTraceDatum TraceData;
+	FHitResult Hit;
+
+	// Backwards, so removing with a swap only moves projectiles that were already stepped
+	for (int32 Index = Projectiles.Num() - 1; Index >= 0; --Index)
+	{
+		FCombaxLightProjectile& Projectile = Projectiles[Index];
+		const FCombaxProjectileType& Type = Types[Projectile.Type];
+		bool bAlive = true;
+
+		if (!Projectile.bStopped)
+		{
+			if (bSynchronous)
+			{
+				Integrate(Projectile, GravityZ, DeltaTime);
+				if (World->SweepSingleByChannel(Hit, Projectile.Location, Projectile.SweepEnd, FQuat::Identity, Type.CollisionChannel, FCollisionShape::MakeSphere(Type.Radius), QueryParams, Type.ResponseParams))
+				{
+					bAlive = ResolveHit(Projectile, Hit);
+				}
+				else
+				{
+					Projectile.Location = Projectile.SweepEnd;
+				}
+			}
+			else
+			{
+				// Resolve the sweep issued last frame, it ran with the rest of the batch at the end of that frame
+				const FHitResult* BlockingHit = nullptr;
+				if (Projectile.Sweep.IsValid() && World->QueryTraceData(Projectile.Sweep, TraceData))
+				{
+					BlockingHit = FHitResult::GetFirstBlockingHit(TraceData.OutHits);
+				}
+
+				if (BlockingHit != nullptr)
+				{
+					bAlive = ResolveHit(Projectile, *BlockingHit);
+				}
+				else
+				{
+					Projectile.Location = Projectile.SweepEnd;
+				}
+			}
+		}
+
+		Projectile.LifeRemaining -= DeltaTime;
+		if (!bAlive || Projectile.LifeRemaining <= 0.0f)
+		{
+			Projectiles.RemoveAtSwap(Index, 1, false);
+			continue;
+		}
+
+		if (!bSynchronous && !Projectile.bStopped)
+		{
+			Integrate(Projectile, GravityZ, DeltaTime);
+			Projectile.Sweep = World->AsyncSweepByChannel(EAsyncTraceType::Single, Projectile.Location, Projectile.SweepEnd, FQuat::Identity, Type.CollisionChannel, FCollisionShape::MakeSphere(Type.Radius), QueryParams, Type.ResponseParams);
+		}
+	}
+
+	SET_DWORD_STAT(STAT_CombaxLightProjectiles, Projectiles.Num());
+	UpdateInstances();
+}
+
+int32 UCombaxProjectileManager::FindOrAddType(TSubclassOf<ACombaxProjectile> ProjectileClass, UStaticMesh* Mesh)
+{
+	if (!ProjectileClass)
+	{
+		return INDEX_NONE;
+	}
+
+	const int32 Existing = Types.IndexOfByPredicate([ProjectileClass, Mesh](const FCombaxProjectileType& Type)
+		{ return Type.ProjectileClass == ProjectileClass && Type.Mesh == Mesh; });
+	if (Existing != INDEX_NONE)
+	{
+		return Existing;
+	}
+
+	// Fly exactly like the actor version would, as set up on the class defaults
+	const ACombaxProjectile* Defaults = ProjectileClass->GetDefaultObject<ACombaxProjectile>();
+	const USphereComponent* Sphere = Defaults->GetCollisionComp();
+	const UProjectileMovementComponent* Movement = Defaults->GetProjectileMovement();
+
+	FCombaxProjectileType& Type = Types.AddDefaulted_GetRef();
+	Type.ProjectileClass = ProjectileClass;
+	Type.Mesh = Mesh;
+	Type.Radius = Sphere->GetScaledSphereRadius();
+	Type.CollisionChannel = Sphere->GetCollisionObjectType();
+	Type.ResponseParams = FCollisionResponseParams(Sphere->GetCollisionResponseToChannels());
+	Type.InitialSpeed = Movement->InitialSpeed;
+	Type.MaxSpeed = Movement->MaxSpeed;
+	Type.GravityScale = Movement->ProjectileGravityScale;
+	Type.Bounciness = Movement->Bounciness;
+	Type.Friction = Movement->Friction;
+	Type.BounceStopSpeed = Movement->BounceVelocityStopSimulatingThreshold;
+	Type.bShouldBounce = Movement->bShouldBounce;
+	Type.LifeSpan = Defaults->InitialLifeSpan;
+
+	// Nothing to draw on a dedicated server
+	if (Mesh != nullptr && !IsRunningDedicatedServer())
+	{
+		if (InstanceActor == nullptr)
+		{
+			FActorSpawnParameters SpawnParams;
+			SpawnParams.ObjectFlags |= RF_Transient;
+			InstanceActor = GetWorld()->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParams);
+
+			USceneComponent* Root = NewObject<USceneComponent>(InstanceActor, TEXT("Root"));
+			InstanceActor->SetRootComponent(Root);
+			Root->RegisterComponent();
+		}
+
+		UInstancedStaticMeshComponent* Instances = NewObject<UInstancedStaticMeshComponent>(InstanceActor);
+		Instances->SetStaticMesh(Mesh);
+		Instances->SetMobility(EComponentMobility::Movable);
+		Instances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		Instances->SetupAttachment(InstanceActor->GetRootComponent());
+		Instances->RegisterComponent();
+
+		InstanceComponents.Add(Instances);
+		Type.Instances = Instances;
+	}
+
+	return Types.Num() - 1;
+}
+
+bool UCombaxProjectileManager::ResolveHit(FCombaxLightProjectile& Projectile, const FHitResult& Hit)
+{
+	const FCombaxProjectileType& Type = Types[Projectile.Type];
+	Projectile.Location = Hit.Location;
+
+	// Only add impulse and use up the projectile if we hit a physics object, same as ACombaxProjectile::OnHit
+	AActor* OtherActor = Hit.GetActor();
+	UPrimitiveComponent* OtherComp = Hit.GetComponent();
+	if (OtherActor != nullptr && OtherComp != nullptr && OtherComp->IsSimulatingPhysics())
+	{
+		OtherComp->AddImpulseAtLocation(Projectile.Velocity * 100.0f, Projectile.Location);
+		return false;
+	}
+
+	if (!Type.bShouldBounce)
+	{
+		Projectile.Velocity = FVector::ZeroVector;
+		Projectile.bStopped = true;
+		return true;
+	}
+
+	// Same bounce response as UProjectileMovementComponent::ComputeBounceVelocity. The rest of the frame after the hit is dropped.
+	const float VDotNormal = Projectile.Velocity | Hit.Normal;
+	if (VDotNormal <= 0.0f)
+	{
+		const FVector ProjectedNormal = Hit.Normal * -VDotNormal;
+		Projectile.Velocity += ProjectedNormal;
+		Projectile.Velocity *= FMath::Clamp(1.0f - Type.Friction, 0.0f, 1.0f);
+		Projectile.Velocity += ProjectedNormal * FMath::Max(Type.Bounciness, 0.0f);
+	}
+	++Projectile.Bounces;
+
+	if (Projectile.Velocity.SizeSquared() < FMath::Square(Type.BounceStopSpeed))
+	{
+		Projectile.Velocity = FVector::ZeroVector;
+		Projectile.bStopped = true;
+	}
+	return true;
+}
+
+void UCombaxProjectileManager::Integrate(FCombaxLightProjectile& Projectile, float GravityZ, float DeltaTime) const
+{
+	const FCombaxProjectileType& Type = Types[Projectile.Type];
+	const FVector Acceleration(0.0f, 0.0f, GravityZ * Type.GravityScale);
+
+	// Midpoint integration, like UProjectileMovementComponent::ComputeMoveDelta
+	FVector NewVelocity = Projectile.Velocity + Acceleration * DeltaTime;
+	if (Type.MaxSpeed > 0.0f)
+	{
+		NewVelocity = NewVelocity.GetClampedToMaxSize(Type.MaxSpeed);
+	}
+	Projectile.SweepEnd = Projectile.Location + (Projectile.Velocity + NewVelocity) * (0.5f * DeltaTime);
+	Projectile.Velocity = NewVelocity;
+}
+
+void UCombaxProjectileManager::UpdateInstances()
+{
+	for (int32 TypeIndex = 0; TypeIndex < Types.Num(); ++TypeIndex)
+	{
+		UInstancedStaticMeshComponent* Instances = Types[TypeIndex].Instances;
+		if (!IsValid(Instances))
+		{
+			continue;
+		}
+
+		InstanceTransforms.Reset();
+		for (const FCombaxLightProjectile& Projectile : Projectiles)
+		{
+			if (Projectile.Type == TypeIndex)
+			{
+				const FRotator Rotation = Projectile.bStopped ? FRotator::ZeroRotator : Projectile.Velocity.Rotation();
+				InstanceTransforms.Emplace(Rotation, Projectile.Location);
+			}
+		}
+
+		// Instances are only ever added. Spare ones are collapsed to zero scale instead of removed, so projectiles
+		// expiring doesn't rebuild the instance buffer every frame.
+		const int32 InstanceCount = Instances->GetInstanceCount();
+		const int32 Visible = InstanceTransforms.Num();
+		if (Visible == 0 && InstanceCount == 0)
+		{
+			continue;
+		}
+		for (int32 Spare = Visible; Spare < InstanceCount; ++Spare)
+		{
+			InstanceTransforms.Emplace(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector);
+		}
+
+		TArray<FTransform> AddedTransforms;
+		if (InstanceTransforms.Num() > InstanceCount)
+		{
+			AddedTransforms.Append(InstanceTransforms.GetData() + InstanceCount, InstanceTransforms.Num() - InstanceCount);
+			InstanceTransforms.SetNum(InstanceCount, false);
+		}
+		if (InstanceCount > 0)
+		{
+			Instances->BatchUpdateInstancesTransforms(0, InstanceTransforms, true, true, true);
+		}
+		if (AddedTransforms.Num() > 0)
+		{
+			Instances->AddInstances(AddedTransforms, false, true);
+		}
+	}
+}
+
+// Fires the given number of projectiles upwards through empty space and times synchronous 60 Hz steps,
+// reporting how many projectiles fit in a frame at that rate
+static void BenchmarkLightProjectiles(const TArray<FString>& Args, UWorld* World)
+{
+	UCombaxProjectileManager* Manager = World ? World->GetSubsystem<UCombaxProjectileManager>() : nullptr;
+	if (Manager == nullptr)
+	{
+		UE_LOG(LogCombaxProjectileManager, Warning, TEXT("No projectile manager in this world, run this in a game world"));
+		return;
+	}
+
+	const int32 Count = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 10000;
+	const int32 Frames = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 60;
+	const float DeltaTime = 1.0f / 60.0f;
+
+	Manager->Reset();
+	FRandomStream Random(Count);
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		const FVector Location(Random.FRandRange(-10000.0f, 10000.0f), Random.FRandRange(-10000.0f, 10000.0f), 100000.0f);
+		Manager->Fire(ACombaxProjectile::StaticClass(), nullptr, Location, FRotator(90.0f, 0.0f, 0.0f));
+	}
+
+	const double Start = FPlatformTime::Seconds();
+	for (int32 Frame = 0; Frame < Frames; ++Frame)
+	{
+		Manager->TickSynchronous(DeltaTime);
+	}
+	const double FrameTime = (FPlatformTime::Seconds() - Start) / Frames;
+	const int32 Remaining = Manager->Num();
+	Manager->Reset();
+
+	UE_LOG(LogCombaxProjectileManager, Display, TEXT("%d projectiles x %d frames: %.3f ms per frame, ~%.0f projectiles sustained per 60 Hz frame (%d still alive)"),
+		Count, Frames, FrameTime * 1000.0, Count * DeltaTime / FMath::Max(FrameTime, 1e-9), Remaining);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs BenchmarkLightProjectilesCommand(
+	TEXT("sv.lightprojectiles.bench"),
+	TEXT("Time stepping lightweight projectiles at 60 Hz and report the sustainable count. Arguments: projectile count, frame count. Clears projectiles in flight."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BenchmarkLightProjectiles));
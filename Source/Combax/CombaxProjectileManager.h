@@ -0,0 +1,135 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Engine/EngineTypes.h"
+#include "WorldCollision.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombaxProjectileManager.generated.h"
+
+class ACombaxProjectile;
+class UInstancedStaticMeshComponent;
+class UStaticMesh;
+
+//** Ticks the projectile manager once per frame */
+USTRUCT()
+struct FCombaxProjectileManagerTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	class UCombaxProjectileManager* Manager = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template <>
+struct TStructOpsTypeTraits<FCombaxProjectileManagerTickFunction> : public TStructOpsTypeTraitsBase2<FCombaxProjectileManagerTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+//** Flight parameters shared by every lightweight projectile fired from the same class and mesh, read off the class defaults */
+struct FCombaxProjectileType
+{
+	TSubclassOf<ACombaxProjectile> ProjectileClass;
+	UStaticMesh* Mesh = nullptr;
+
+	float Radius = 5.0f;
+	float InitialSpeed = 3000.0f;
+	float MaxSpeed = 3000.0f;
+	float GravityScale = 1.0f;
+	float Bounciness = 0.6f;
+	float Friction = 0.2f;
+	float BounceStopSpeed = 5.0f;
+	float LifeSpan = 3.0f;
+	bool bShouldBounce = true;
+
+	ECollisionChannel CollisionChannel = ECC_WorldDynamic;
+	FCollisionResponseParams ResponseParams;
+
+	//** Only exists when something can see it */
+	UInstancedStaticMeshComponent* Instances = nullptr;
+};
+
+//** One projectile in flight. No UObjects, just enough state to step and sweep it. */
+struct FCombaxLightProjectile
+{
+	FVector Location = FVector::ZeroVector;
+	FVector Velocity = FVector::ZeroVector;
+
+	//** Where the sweep currently in flight is headed */
+	FVector SweepEnd = FVector::ZeroVector;
+	FTraceHandle Sweep;
+
+	float LifeRemaining = 0.0f;
+	int32 Bounces = 0;
+	int32 Type = 0;
+
+	//** Came to rest after bouncing, waiting out its lifespan */
+	bool bStopped = false;
+};
+
+/**
+ * Simulates projectiles as plain structs instead of actors. Every frame each projectile's sweep is issued as an async
+ * trace, and the results are resolved at the start of the next frame, so the physics scene gets one batch per frame
+ * instead of a sweep per projectile component. Hits apply the same impulse as ACombaxProjectile::OnHit. Rendering
+ * goes through one instanced static mesh per projectile type.
+ */
+UCLASS()
+class COMBAX_API UCombaxProjectileManager : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	//** Launch a lightweight projectile that flies like ProjectileClass and is drawn with Mesh */
+	void Fire(TSubclassOf<ACombaxProjectile> ProjectileClass, UStaticMesh* Mesh, const FVector& Location, const FRotator& Rotation);
+
+	int32 Num() const { return Projectiles.Num(); }
+
+	//** Drop every projectile in flight */
+	void Reset();
+
+	void Tick(float DeltaTime);
+
+	//** Step without async traces, sweeping each projectile immediately. Used where no frame boundary follows, eg benchmarks. */
+	void TickSynchronous(float DeltaTime);
+
+private:
+	void Step(float DeltaTime, bool bSynchronous);
+
+	int32 FindOrAddType(TSubclassOf<ACombaxProjectile> ProjectileClass, UStaticMesh* Mesh);
+
+	//** Apply a blocking hit. Returns false if the projectile is used up. */
+	bool ResolveHit(FCombaxLightProjectile& Projectile, const FHitResult& Hit);
+
+	//** Gravity, speed clamp and the end of this frame's sweep */
+	void Integrate(FCombaxLightProjectile& Projectile, float GravityZ, float DeltaTime) const;
+
+	void UpdateInstances();
+
+	FCollisionQueryParams QueryParams;
+
+	TArray<FCombaxProjectileType> Types;
+	TArray<FCombaxLightProjectile> Projectiles;
+
+	//** Scratch space for instance transforms, kept to avoid reallocating every frame */
+	TArray<FTransform> InstanceTransforms;
+
+	UPROPERTY(Transient)
+	AActor* InstanceActor = nullptr;
+
+	UPROPERTY(Transient)
+	TArray<UInstancedStaticMeshComponent*> InstanceComponents;
+
+	FCombaxProjectileManagerTickFunction TickFunction;
+};
@@ -0,0 +1,275 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CombaxProjectilePool.h"
+#include "CombaxProjectile.h"
+#include "CombaxProjectileStats.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "UObject/UObjectGlobals.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogCombaxProjectilePool, Log, All);
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pool hits"), STAT_CombaxProjectilePoolHits, STATGROUP_CombaxProjectiles);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pool misses"), STAT_CombaxProjectilePoolMisses, STATGROUP_CombaxProjectiles);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pooled projectiles"), STAT_CombaxProjectilesPooled, STATGROUP_CombaxProjectiles);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Active projectiles"), STAT_CombaxProjectilesActive, STATGROUP_CombaxProjectiles);
+
+static TAutoConsoleVariable<int32> CVarProjectilePool(TEXT("sv.projectilepool"), 1, TEXT("Recycle projectiles instead of spawning and destroying one per shot.\n"), ECVF_Default);
+
+bool UCombaxProjectilePool::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld();
+}
+
+void UCombaxProjectilePool::Deinitialize()
+{
+	FreeLists.Reset();
+	SET_DWORD_STAT(STAT_CombaxProjectilesPooled, 0);
+	SET_DWORD_STAT(STAT_CombaxProjectilesActive, 0);
+
+	Super::Deinitialize();
+}
+
+bool UCombaxProjectilePool::IsPoolingEnabled()
+{
+	return CVarProjectilePool.GetValueOnGameThread() != 0;
+}
+
+void UCombaxProjectilePool::Prewarm(TSubclassOf<ACombaxProjectile> ProjectileClass, int32 Count)
+{
+	if (!ProjectileClass)
+	{
+		return;
+	}
+
+	TArray<ACombaxProjectile*>& Free = FreeLists.FindOrAdd(ProjectileClass).Projectiles;
+	Free.Reserve(Count);
+	while (Free.Num() < Count)
+	{
+		ACombaxProjectile* Projectile = SpawnPooled(ProjectileClass);
+		if (Projectile == nullptr)
+		{
+			break;
+		}
+		Free.Add(Projectile);
+	}
+}
+
+ACombaxProjectile* UCombaxProjectilePool::Acquire(TSubclassOf<ACombaxProjectile> ProjectileClass, const FVector& Location, const FRotator& Rotation)
+{
+	if (!ProjectileClass)
+	{
+		return nullptr;
+	}
+
+	TArray<ACombaxProjectile*>& Free = FreeLists.FindOrAdd(ProjectileClass).Projectiles;
+
+	// Destroyed projectiles take themselves off the list, this only skips ones already marked for it
+	ACombaxProjectile* Projectile = nullptr;
+	while (Free.Num() > 0 && Projectile == nullptr)
+	{
+		Projectile = Free.Pop(false);
+		if (!IsValid(Projectile))
+		{
+			Projectile = nullptr;
+		}
+	}
+
+	if (Projectile != nullptr)
+	{
+		++HitCount;
+		INC_DWORD_STAT(STAT_CombaxProjectilePoolHits);
+	}
+	else
+	{
+		++MissCount;
+		INC_DWORD_STAT(STAT_CombaxProjectilePoolMisses);
+		Projectile = SpawnPooled(ProjectileClass);
+		if (Projectile == nullptr)
+		{
+			return nullptr;
+		}
+	}
+
+	// The spot search tests the projectile's own collision, which is off while it sits in the pool. Move it to the muzzle
+	// first so turning collision back on doesn't start overlaps wherever the last shot ended.
+	Projectile->SetActorLocationAndRotation(Location, Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+	Projectile->SetActorEnableCollision(true);
+
+	// Nudge out of geometry the way spawning would, or don't fire at all
+	FVector SpawnLocation = Location;
+	if (!GetWorld()->FindTeleportSpot(Projectile, SpawnLocation, Rotation))
+	{
+		Projectile->SetActorEnableCollision(false);
+		Free.Add(Projectile);
+		return nullptr;
+	}
+
+	++ActiveCount;
+	SET_DWORD_STAT(STAT_CombaxProjectilesActive, ActiveCount);
+	SET_DWORD_STAT(STAT_CombaxProjectilesPooled, PooledCount);
+
+	Projectile->ActivateProjectile(SpawnLocation, Rotation);
+	return Projectile;
+}
+
+void UCombaxProjectilePool::Release(ACombaxProjectile* Projectile)
+{
+	if (!IsValid(Projectile) || !Projectile->IsProjectileActive())
+	{
+		return;
+	}
+
+	Projectile->DeactivateProjectile();
+	FreeLists.FindOrAdd(Projectile->GetClass()).Projectiles.Add(Projectile);
+
+	--ActiveCount;
+	SET_DWORD_STAT(STAT_CombaxProjectilesActive, ActiveCount);
+}
+
+int32 UCombaxProjectilePool::Trim(TSubclassOf<ACombaxProjectile> ProjectileClass, int32 MaxFree)
+{
+	FCombaxProjectileFreeList* FreeList = FreeLists.Find(ProjectileClass);
+	if (FreeList == nullptr)
+	{
+		return 0;
+	}
+
+	int32 Destroyed = 0;
+	while (FreeList->Projectiles.Num() > FMath::Max(MaxFree, 0))
+	{
+		// Off the list first, OnPooledProjectileDestroyed then only has the count to fix
+		ACombaxProjectile* Projectile = FreeList->Projectiles.Pop(false);
+		if (IsValid(Projectile) && Projectile->Destroy())
+		{
+			++Destroyed;
+		}
+	}
+	return Destroyed;
+}
+
+int32 UCombaxProjectilePool::GetFreeCount(TSubclassOf<ACombaxProjectile> ProjectileClass) const
+{
+	const FCombaxProjectileFreeList* FreeList = FreeLists.Find(ProjectileClass);
+	return FreeList ? FreeList->Projectiles.Num() : 0;
+}
+
+ACombaxProjectile* UCombaxProjectilePool::SpawnPooled(TSubclassOf<ACombaxProjectile> ProjectileClass)
+{
+	FActorSpawnParameters ActorSpawnParams;
+	ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	ACombaxProjectile* Projectile = GetWorld()->SpawnActor<ACombaxProjectile>(ProjectileClass, FVector::ZeroVector, FRotator::ZeroRotator, ActorSpawnParams);
+	if (Projectile == nullptr)
+	{
+		return nullptr;
+	}
+
+	Projectile->SetOwningPool(this);
+	Projectile->OnDestroyed.AddDynamic(this, &UCombaxProjectilePool::OnPooledProjectileDestroyed);
+	Projectile->DeactivateProjectile();
+
+	++PooledCount;
+	SET_DWORD_STAT(STAT_CombaxProjectilesPooled, PooledCount);
+	return Projectile;
+}
+
+void UCombaxProjectilePool::OnPooledProjectileDestroyed(AActor* DestroyedActor)
+{
+	ACombaxProjectile* Projectile = Cast<ACombaxProjectile>(DestroyedActor);
+	if (Projectile == nullptr)
+	{
+		return;
+	}
+
+	if (Projectile->IsProjectileActive())
+	{
+		--ActiveCount;
+		SET_DWORD_STAT(STAT_CombaxProjectilesActive, ActiveCount);
+	}
+	else if (FCombaxProjectileFreeList* FreeList = FreeLists.Find(Projectile->GetClass()))
+	{
+		FreeList->Projectiles.RemoveSingleSwap(Projectile, false);
+	}
+
+	--PooledCount;
+	SET_DWORD_STAT(STAT_CombaxProjectilesPooled, PooledCount);
+}
+
+// Fires one second's worth of shots at 1000 shots/sec through SpawnActor/Destroy and through the pool,
+// timing the spawning and the garbage collection that follows each
+static void BenchmarkProjectilePool(const TArray<FString>& Args, UWorld* World)
+{
+	UCombaxProjectilePool* Pool = World ? World->GetSubsystem<UCombaxProjectilePool>() : nullptr;
+	if (Pool == nullptr)
+	{
+		UE_LOG(LogCombaxProjectilePool, Warning, TEXT("No projectile pool in this world, run this in a game world"));
+		return;
+	}
+
+	const int32 Shots = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 1000;
+	const TSubclassOf<ACombaxProjectile> ProjectileClass = ACombaxProjectile::StaticClass();
+
+	// Far above the map so nothing collides
+	const FVector Location(0.0f, 0.0f, 100000.0f);
+	TArray<ACombaxProjectile*> Fired;
+	Fired.Reserve(Shots);
+
+	FActorSpawnParameters ActorSpawnParams;
+	ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	double Start = FPlatformTime::Seconds();
+	for (int32 Shot = 0; Shot < Shots; ++Shot)
+	{
+		Fired.Add(World->SpawnActor<ACombaxProjectile>(ProjectileClass, Location, FRotator::ZeroRotator, ActorSpawnParams));
+	}
+	for (ACombaxProjectile* Projectile : Fired)
+	{
+		if (Projectile)
+		{
+			Projectile->Destroy();
+		}
+	}
+	const double SpawnTime = FPlatformTime::Seconds() - Start;
+	Fired.Reset();
+
+	Start = FPlatformTime::Seconds();
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	const double SpawnGCTime = FPlatformTime::Seconds() - Start;
+
+	// Only what the bench adds to the pool is destroyed afterwards
+	const int32 FreeBefore = Pool->GetFreeCount(ProjectileClass);
+	Pool->Prewarm(ProjectileClass, FreeBefore + Shots);
+	const int64 MissesBefore = Pool->GetMissCount();
+
+	Start = FPlatformTime::Seconds();
+	for (int32 Shot = 0; Shot < Shots; ++Shot)
+	{
+		Fired.Add(Pool->Acquire(ProjectileClass, Location, FRotator::ZeroRotator));
+	}
+	for (ACombaxProjectile* Projectile : Fired)
+	{
+		if (Projectile)
+		{
+			Projectile->ReleaseProjectile();
+		}
+	}
+	const double PoolTime = FPlatformTime::Seconds() - Start;
+
+	Start = FPlatformTime::Seconds();
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	const double PoolGCTime = FPlatformTime::Seconds() - Start;
+
+	UE_LOG(LogCombaxProjectilePool, Display, TEXT("%d shots: spawn/destroy %.3f ms + GC %.3f ms, pool %.3f ms + GC %.3f ms (%lld misses)"),
+		Shots, SpawnTime * 1000.0, SpawnGCTime * 1000.0, PoolTime * 1000.0, PoolGCTime * 1000.0, Pool->GetMissCount() - MissesBefore);
+
+	const int32 Trimmed = Pool->Trim(ProjectileClass, FreeBefore);
+	UE_LOG(LogCombaxProjectilePool, Display, TEXT("Destroyed the %d projectiles the bench added to the pool"), Trimmed);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs BenchmarkProjectilePoolCommand(
+	TEXT("sv.projectilepool.bench"),
+	TEXT("Compare spawning and pooling one second of shots at 1000 shots/sec, including the GC pass after each. Optional argument: shot count."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BenchmarkProjectilePool));
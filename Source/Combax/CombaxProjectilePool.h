@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombaxProjectilePool.generated.h"
+
+class ACombaxProjectile;
+
+//** Inactive projectiles of one class */
+USTRUCT()
+struct FCombaxProjectileFreeList
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Transient)
+	TArray<ACombaxProjectile*> Projectiles;
+};
+
+/**
+ * Keeps deactivated projectiles around so firing doesn't spawn, register and later garbage collect an actor per shot.
+ * The pool grows whenever it runs dry and never shrinks during play.
+ */
+UCLASS()
+class COMBAX_API UCombaxProjectilePool : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+
+	//** Make sure at least Count projectiles of the class are ready to fire */
+	void Prewarm(TSubclassOf<ACombaxProjectile> ProjectileClass, int32 Count);
+
+	//** Launch a projectile from the pool. Returns null if there is no room at Location, like AdjustIfPossibleButDontSpawnIfColliding. */
+	ACombaxProjectile* Acquire(TSubclassOf<ACombaxProjectile> ProjectileClass, const FVector& Location, const FRotator& Rotation);
+
+	//** Deactivate a projectile and make it available again */
+	void Release(ACombaxProjectile* Projectile);
+
+	//** Destroy inactive projectiles of the class until at most MaxFree are left. Returns how many were destroyed. */
+	int32 Trim(TSubclassOf<ACombaxProjectile> ProjectileClass, int32 MaxFree);
+
+	int32 GetFreeCount(TSubclassOf<ACombaxProjectile> ProjectileClass) const;
+
+	int32 GetPooledCount() const { return PooledCount; }
+	int32 GetActiveCount() const { return ActiveCount; }
+	int64 GetHitCount() const { return HitCount; }
+	int64 GetMissCount() const { return MissCount; }
+
+	static bool IsPoolingEnabled();
+
+private:
+	ACombaxProjectile* SpawnPooled(TSubclassOf<ACombaxProjectile> ProjectileClass);
+
+	//** Keeps the counts right when something other than the pool destroys one of its projectiles */
+	UFUNCTION()
+	void OnPooledProjectileDestroyed(AActor* DestroyedActor);
+
+	UPROPERTY(Transient)
+	TMap<TSubclassOf<ACombaxProjectile>, FCombaxProjectileFreeList> FreeLists;
+
+	int32 PooledCount = 0;
+	int32 ActiveCount = 0;
+	int64 HitCount = 0;
+	int64 MissCount = 0;
+};
@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Player/S_BotController.h"
+#include "Player/S_Character.h"
+#include "Player/S_CharacterMovement.h"
+#include "TP_WeaponComponent.h"
+#include "InputActionValue.h"
+
+AS_BotController::AS_BotController()
+{
+	StrafeSweepAngle = 30.0f;
+	StrafeSweepRate = 0.5f;
+	HeadingInterval = 4.0f;
+	SprintInterval = 3.0f;
+	FireInterval = 0.5f;
+	StuckSpeed = 50.0f;
+}
+
+void AS_BotController::OnPossess(APawn *InPawn)
+{
+	Super::OnPossess(InPawn);
+
+	//: The server runs the same jump rules as the client, or every hop would be corrected
+	SetupPawn(Cast<AS_Character>(InPawn));
+}
+
+void AS_BotController::SetupPawn(AS_Character *Character)
+{
+	DrivenCharacter = Character;
+	if (!Character)
+	{
+		return;
+	}
+
+	Character->SetAutoBunnyhop(true);
+
+	//: Bots spread out over the map instead of all following the same path
+	Random.Initialize(int32(FPlatformProcess::GetCurrentProcessId()) ^ int32(GetUniqueID()));
+	Heading = Random.FRandRange(0.0f, 360.0f);
+	NextHeadingTime = Time + HeadingInterval * Random.FRandRange(0.5f, 1.5f);
+	NextFireTime = Time + FireInterval;
+	StuckTime = 0.0f;
+}
+
+void AS_BotController::PlayerTick(float DeltaTime)
+{
+	Super::PlayerTick(DeltaTime);
+
+	//: Only the owning client drives, the server just answers its moves
+	AS_Character *Character = Cast<AS_Character>(GetPawn());
+	if (!Character || !IsLocalController())
+	{
+		return;
+	}
+	if (DrivenCharacter.Get() != Character)
+	{
+		SetupPawn(Character);
+	}
+
+	Time += DeltaTime;
+	DrivePawn(Character, DeltaTime);
+}
+
+void AS_BotController::DrivePawn(AS_Character *Character, float DeltaTime)
+{
+	const US_CharacterMovement *Movement = Character->GetMovementPtr();
+	const bool bOnGround = Movement && Movement->IsMovingOnGround();
+
+	//: Turn around when running into something, otherwise wander
+	const float GroundSpeed = Character->GetVelocity().Size2D();
+	StuckTime = (bOnGround && GroundSpeed < StuckSpeed) ? StuckTime + DeltaTime : 0.0f;
+	if (StuckTime > 1.0f)
+	{
+		Heading += 180.0f + Random.FRandRange(-45.0f, 45.0f);
+		NextHeadingTime = Time + HeadingInterval;
+		StuckTime = 0.0f;
+	}
+	else if (Time >= NextHeadingTime)
+	{
+		Heading += Random.FRandRange(-90.0f, 90.0f);
+		NextHeadingTime = Time + HeadingInterval * Random.FRandRange(0.5f, 1.5f);
+	}
+
+	//: Strafe jumping: sweep the view side to side and strafe in the direction it is turning, forward only on the ground
+	const float Phase = Time * StrafeSweepRate * 2.0f * PI;
+	const float Yaw = Heading + FMath::Sin(Phase) * StrafeSweepAngle;
+	SetControlRotation(FRotator(0.0f, FRotator::NormalizeAxis(Yaw), 0.0f));
+
+	const float Strafe = FMath::Sign(FMath::Cos(Phase));
+	Character->Move(FInputActionValue(FVector2D(Strafe, bOnGround ? 1.0f : 0.0f)));
+
+	//: Held jump with auto bunnyhop hops again the moment the pawn lands
+	Character->Jump();
+
+	Character->SetSprinting(FMath::Fmod(Time, SprintInterval * 2.0f) < SprintInterval);
+
+	if (FireInterval > 0.0f && Time >= NextFireTime)
+	{
+		NextFireTime = Time + FireInterval;
+		FireWeapon(Character);
+	}
+}
+
+void AS_BotController::FireWeapon(AS_Character *Character)
+{
+	UTP_WeaponComponent *Weapon = Character->FindComponentByClass<UTP_WeaponComponent>();
+	if (!Weapon)
+	{
+		//: Picked up weapons belong to their pickup actor, which is attached to the pawn
+		TArray<AActor *> AttachedActors;
+		Character->GetAttachedActors(AttachedActors);
+		for (int32 Index = 0; Index < AttachedActors.Num() && !Weapon; ++Index)
+		{
+			Weapon = AttachedActors[Index]->FindComponentByClass<UTP_WeaponComponent>();
+		}
+	}
+
+	if (Weapon)
+	{
+		Weapon->Fire();
+	}
+}
@@ -0,0 +1,258 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Player/S_BotLauncher.h"
+#include "Player/S_CharacterMovement.h"
+#include "Player/S_MovementManager.h"
+#include "CoreGlobals.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogS_Bots, Log, All);
+
+static TAutoConsoleVariable<FString> CVarBotExecutable(TEXT("sv.bots.exe"), TEXT(""), TEXT("Executable bot clients are launched from. Empty uses this server's own executable, which only works for editor builds.\n"), ECVF_Default);
+static TAutoConsoleVariable<int32> CVarBotMaxFPS(TEXT("sv.bots.maxfps"), 60, TEXT("Frame rate cap of bot clients, which is also how often they send moves.\n"), ECVF_Default);
+static TAutoConsoleVariable<float> CVarBotSampleInterval(TEXT("sv.bots.sampleinterval"), 1.0f, TEXT("Seconds covered by each row of the bot metrics CSV.\n"), ECVF_Default);
+
+bool US_BotLauncher::ShouldCreateSubsystem(UObject *Outer) const
+{
+	const UWorld *World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld();
+}
+
+void US_BotLauncher::OnWorldBeginPlay(UWorld &InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	int32 Count = 0;
+	if (InWorld.GetNetMode() != NM_Client && FParse::Value(FCommandLine::Get(), TEXT("CombaxBots="), Count) && Count > 0)
+	{
+		FParse::Value(FCommandLine::Get(), TEXT("CombaxBotSeconds="), RunSeconds);
+		AddBots(Count);
+	}
+}
+
+void US_BotLauncher::Deinitialize()
+{
+	RemoveAllBots();
+	Super::Deinitialize();
+}
+
+TStatId US_BotLauncher::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(US_BotLauncher, STATGROUP_Tickables);
+}
+
+void US_BotLauncher::AddBots(int32 Count)
+{
+	UWorld *World = GetWorld();
+	if (!World || World->GetNetMode() == NM_Client || World->GetNetMode() == NM_Standalone)
+	{
+		UE_LOG(LogS_Bots, Warning, TEXT("Bots can only be added on a listen or dedicated server"));
+		return;
+	}
+
+	FString Executable = CVarBotExecutable.GetValueOnGameThread();
+	if (Executable.IsEmpty())
+	{
+		Executable = FPlatformProcess::ExecutablePath();
+	}
+
+	//: Editor builds need to be told which project to run, packaged clients know
+	FString Project;
+#if WITH_EDITOR
+	Project = FString::Printf(TEXT("\"%s\" "), *FPaths::ConvertRelativePathToFull(FPaths::GetProjectFilePath()));
+#endif
+
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		const int32 BotIndex = BotsLaunched++;
+		const FString Args = FString::Printf(TEXT("%s127.0.0.1:%d?Bot -game -nullrhi -nosound -unattended -nosplash -ExecCmds=\"t.MaxFPS %d\" -log=CombaxBot%d.log"),
+											 *Project, World->URL.Port, CVarBotMaxFPS.GetValueOnGameThread(), BotIndex);
+
+		FProcHandle Process = FPlatformProcess::CreateProc(*Executable, *Args, true, true, true, nullptr, 0, nullptr, nullptr);
+		if (!Process.IsValid())
+		{
+			UE_LOG(LogS_Bots, Error, TEXT("Couldn't launch bot %d: %s %s"), BotIndex, *Executable, *Args);
+			continue;
+		}
+		BotProcesses.Add(Process);
+	}
+
+	UE_LOG(LogS_Bots, Display, TEXT("%d bot clients running"), BotProcesses.Num());
+	if (BotProcesses.Num() > 0)
+	{
+		StartMetrics();
+	}
+}
+
+void US_BotLauncher::RemoveAllBots()
+{
+	for (FProcHandle &Process : BotProcesses)
+	{
+		if (FPlatformProcess::IsProcRunning(Process))
+		{
+			FPlatformProcess::TerminateProc(Process, true);
+		}
+		FPlatformProcess::CloseProc(Process);
+	}
+	BotProcesses.Reset();
+	StopMetrics();
+}
+
+//~ ==== Metrics ============================================================================================ ~//
+
+void US_BotLauncher::StartMetrics()
+{
+	if (bWritingMetrics)
+	{
+		return;
+	}
+
+	MetricsFilename = FPaths::ProfilingDir() / TEXT("Bots") / FString::Printf(TEXT("CombaxBots-%s.csv"), *FDateTime::Now().ToString());
+	const FString Header = TEXT("Seconds,Bots,Connections,FrameMs,MaxFrameMs,GameThreadMs,MaxGameThreadMs,InBytesPerSecond,OutBytesPerSecond,OutBytesPerConnection,MoveResponses,Corrections,CorrectionRate,CorrectionsDeferred\n");
+	if (!FFileHelper::SaveStringToFile(Header, *MetricsFilename))
+	{
+		UE_LOG(LogS_Bots, Error, TEXT("Couldn't write bot metrics to %s"), *MetricsFilename);
+		return;
+	}
+	UE_LOG(LogS_Bots, Display, TEXT("Writing bot metrics to %s"), *MetricsFilename);
+
+	bWritingMetrics = true;
+	MetricsSeconds = 0.0;
+	SampleSeconds = 0.0;
+	SampleFrames = 0;
+	SampleGameThreadMs = 0.0;
+	SampleMaxFrameMs = 0.0;
+	SampleMaxGameThreadMs = 0.0;
+	LastMoveCounts.Reset();
+}
+
+void US_BotLauncher::StopMetrics()
+{
+	if (bWritingMetrics)
+	{
+		bWritingMetrics = false;
+		UE_LOG(LogS_Bots, Display, TEXT("Bot metrics written to %s"), *MetricsFilename);
+	}
+}
+
+void US_BotLauncher::Tick(float DeltaTime)
+{
+	if (!bWritingMetrics)
+	{
+		return;
+	}
+
+	//: GGameThreadTime is the previous frame's, close enough over a sample of many frames
+	const double GameThreadMs = FPlatformTime::ToMilliseconds(GGameThreadTime);
+	const double FrameMs = FApp::GetDeltaTime() * 1000.0;
+	SampleSeconds += DeltaTime;
+	++SampleFrames;
+	SampleGameThreadMs += GameThreadMs;
+	SampleMaxFrameMs = FMath::Max(SampleMaxFrameMs, FrameMs);
+	SampleMaxGameThreadMs = FMath::Max(SampleMaxGameThreadMs, GameThreadMs);
+
+	if (SampleSeconds < CVarBotSampleInterval.GetValueOnGameThread())
+	{
+		return;
+	}
+	WriteSample();
+
+	if (RunSeconds > 0.0f && MetricsSeconds >= RunSeconds)
+	{
+		UE_LOG(LogS_Bots, Display, TEXT("Bot run of %.0f seconds finished"), RunSeconds);
+		RemoveAllBots();
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+void US_BotLauncher::WriteSample()
+{
+	const UWorld *World = GetWorld();
+	const UNetDriver *NetDriver = World ? World->GetNetDriver() : nullptr;
+	const US_MovementManager *Manager = World ? World->GetSubsystem<US_MovementManager>() : nullptr;
+
+	//: Bots that have exited on their own, failed to connect for instance, stop counting
+	int32 Bots = 0;
+	for (FProcHandle &Process : BotProcesses)
+	{
+		Bots += FPlatformProcess::IsProcRunning(Process) ? 1 : 0;
+	}
+
+	int64 MoveResponses = 0;
+	int64 Corrections = 0;
+	int64 CorrectionsDeferred = 0;
+	if (Manager)
+	{
+		TMap<TWeakObjectPtr<US_CharacterMovement>, FIntVector> MoveCounts;
+		for (US_CharacterMovement *Movement : Manager->GetMovers())
+		{
+			const FS_MovementCounters &Counters = Movement->GetMovementCounters();
+			const FIntVector Current(Counters.ServerMoveResponses, Counters.Corrections, Counters.CorrectionsDeferred);
+			const FIntVector *Last = LastMoveCounts.Find(Movement);
+
+			//: Lower than last time means someone reset the counters in between, all of the current count is new
+			const bool bReset = !Last || Current.X < Last->X || Current.Y < Last->Y || Current.Z < Last->Z;
+			MoveResponses += bReset ? Current.X : Current.X - Last->X;
+			Corrections += bReset ? Current.Y : Current.Y - Last->Y;
+			CorrectionsDeferred += bReset ? Current.Z : Current.Z - Last->Z;
+			MoveCounts.Add(Movement, Current);
+		}
+		LastMoveCounts = MoveTemp(MoveCounts);
+	}
+
+	const int32 Connections = NetDriver ? NetDriver->ClientConnections.Num() : 0;
+	const uint32 InBytesPerSecond = NetDriver ? NetDriver->InBytesPerSecond : 0;
+	const uint32 OutBytesPerSecond = NetDriver ? NetDriver->OutBytesPerSecond : 0;
+
+	MetricsSeconds += SampleSeconds;
+	const FString Row = FString::Printf(TEXT("%.2f,%d,%d,%.3f,%.3f,%.3f,%.3f,%u,%u,%.1f,%lld,%lld,%.4f,%lld\n"), MetricsSeconds, Bots, Connections,
+										SampleSeconds * 1000.0 / SampleFrames, SampleMaxFrameMs, SampleGameThreadMs / SampleFrames, SampleMaxGameThreadMs,
+										InBytesPerSecond, OutBytesPerSecond, Connections > 0 ? double(OutBytesPerSecond) / Connections : 0.0,
+										MoveResponses, Corrections, MoveResponses > 0 ? double(Corrections) / MoveResponses : 0.0, CorrectionsDeferred);
+	FFileHelper::SaveStringToFile(Row, *MetricsFilename, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+
+	SampleSeconds = 0.0;
+	SampleFrames = 0;
+	SampleGameThreadMs = 0.0;
+	SampleMaxFrameMs = 0.0;
+	SampleMaxGameThreadMs = 0.0;
+}
+
+//~ ==== Commands =========================================================================================== ~//
+
+static void LaunchBots(const TArray<FString> &Args, UWorld *World)
+{
+	US_BotLauncher *Launcher = World ? World->GetSubsystem<US_BotLauncher>() : nullptr;
+	if (Launcher)
+	{
+		Launcher->AddBots(Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 1);
+	}
+}
+
+static void CloseBots(const TArray<FString> &Args, UWorld *World)
+{
+	US_BotLauncher *Launcher = World ? World->GetSubsystem<US_BotLauncher>() : nullptr;
+	if (Launcher)
+	{
+		Launcher->RemoveAllBots();
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs AddBotsCommand(
+	TEXT("sv.bots.add"),
+	TEXT("Launch headless bot clients that connect to this server and strafe jump, bunnyhop, sprint and shoot, and write server metrics to a CSV in the profiling directory while they run. Argument: bot count."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&LaunchBots));
+
+static FAutoConsoleCommandWithWorldAndArgs RemoveAllBotsCommand(
+	TEXT("sv.bots.removeall"),
+	TEXT("Close every bot client launched by sv.bots.add and finish the metrics CSV."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&CloseBots));
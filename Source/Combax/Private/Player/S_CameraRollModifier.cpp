@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Player/S_CameraRollModifier.h"
+#include "Player/S_Character.h"
+#include "Player/S_CharacterMovement.h"
+#include "Camera/CameraTypes.h"
+#include "Camera/PlayerCameraManager.h"
+
+US_CameraRollModifier::US_CameraRollModifier()
+{
+	CurrentRoll = 0.0f;
+}
+
+bool US_CameraRollModifier::ModifyCamera(float DeltaTime, FMinimalViewInfo &InOutPOV)
+{
+	Super::ModifyCamera(DeltaTime, InOutPOV);
+
+	const AS_Character *Character = CameraOwner ? Cast<AS_Character>(CameraOwner->GetViewTarget()) : nullptr;
+	const US_CharacterMovement *Movement = Character ? Character->GetMovementPtr() : nullptr;
+	const float TargetRoll = Movement ? Movement->GetCameraRoll(InOutPOV.Rotation) : 0.0f;
+
+	CurrentRoll = FMath::FInterpTo(CurrentRoll, TargetRoll, DeltaTime, RollInterpSpeed);
+	InOutPOV.Rotation.Roll += CurrentRoll * Alpha;
+
+	//: Let the modifiers after us run too
+	return false;
+}
@@ -1,9 +1,13 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "Player/S_Character.h"
+#include "Player/S_CameraRollModifier.h"
 #include "Player/S_CharacterMovement.h"
+#include "Player/S_MovementManager.h"
+#include "Player/S_MovementProfile.h"
 #include "Animation/AnimInstance.h"
 #include "Camera/CameraComponent.h"
+#include "Camera/PlayerCameraManager.h"
 #include "Components/CapsuleComponent.h"
 #include "EnhancedInputComponent.h"
 #include "EnhancedInputSubsystems.h"
@@ -11,6 +15,7 @@
 #include "GameFramework/Character.h"
 #include "Runtime/Launch/Resources/Version.h"
 #include "HAL/IConsoleManager.h"
+#include "Net/UnrealNetwork.h"
 
 static TAutoConsoleVariable<int32> CVarBunnyhop(TEXT("sv.bunnyhopping"), 0, TEXT("Enable normal bunnyhopping.\n"), ECVF_Default);
 
@@ -29,6 +34,11 @@ AS_Character::AS_Character(const FObjectInitializer &ObjectInitializer)
 	FirstPersonCameraComponent->SetupAttachment(GetCapsuleComponent());
 	FirstPersonCameraComponent->SetRelativeLocation(FVector(-10.f, 0.f, 60.f)); // Position the camera
 	FirstPersonCameraComponent->bUsePawnControlRotation = true;
+	DefaultCameraRelativeLocation = FirstPersonCameraComponent->GetRelativeLocation();
+	bHasMovementRenderOffset = false;
+	MoveInput = FVector2D::ZeroVector;
+	MoveInputFrame = 0;
+	MovementProfile = nullptr;
 
 	// Create a mesh component that will be used when being viewed from a '1st person' view (when controlling this pawn)
 	Mesh1P = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("CharacterMesh1P"));
@@ -55,7 +65,15 @@ void AS_Character::Tick(float DeltaTime)
 void AS_Character::BeginPlay()
 {
 	Super::BeginPlay();
-	MaxJumpTime = -4.0f * GetCharacterMovement()->JumpZVelocity / (3.0f * GetCharacterMovement()->GetGravityZ());
+	DefaultCameraRelativeLocation = FirstPersonCameraComponent->GetRelativeLocation();
+
+	//: Spawned after sv.movementprofile switched the world, join in before the first replication
+	const US_MovementManager *Manager = GetWorld()->GetSubsystem<US_MovementManager>();
+	if (HasAuthority() && Manager && Manager->HasWorldMovementProfile())
+	{
+		MovementProfile = Manager->GetWorldMovementProfile();
+	}
+	OnRep_MovementProfile();
 
 	if (APlayerController *PlayerController = Cast<APlayerController>(Controller))
 	{
@@ -66,6 +84,95 @@ void AS_Character::BeginPlay()
 	}
 }
 
+void AS_Character::PawnClientRestart()
+{
+	Super::PawnClientRestart();
+
+	//: Only local players get one, servers and other clients' pawns never do any camera work
+	const APlayerController *PlayerController = Cast<APlayerController>(Controller);
+	if (PlayerController && PlayerController->IsLocalController() && PlayerController->PlayerCameraManager)
+	{
+		APlayerCameraManager *CameraManager = PlayerController->PlayerCameraManager;
+		if (!CameraManager->FindCameraModifierByClass(US_CameraRollModifier::StaticClass()))
+		{
+			CameraManager->AddNewCameraModifier(US_CameraRollModifier::StaticClass());
+		}
+	}
+}
+
+void AS_Character::PossessedBy(AController *NewController)
+{
+	Super::PossessedBy(NewController);
+
+	if (US_MovementManager *Manager = GetWorld()->GetSubsystem<US_MovementManager>())
+	{
+		Manager->AddControllerPrerequisite(NewController);
+	}
+}
+
+void AS_Character::UnPossessed()
+{
+	//: Before Super clears Controller
+	if (US_MovementManager *Manager = GetWorld()->GetSubsystem<US_MovementManager>())
+	{
+		Manager->RemoveControllerPrerequisite(Controller);
+	}
+
+	Super::UnPossessed();
+}
+
+void AS_Character::GetLifetimeReplicatedProps(TArray<FLifetimeProperty> &OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	//: S_ReplicatedMovement carries the same state, delta encoded per connection
+	DISABLE_REPLICATED_PRIVATE_PROPERTY(AActor, ReplicatedMovement);
+	DOREPLIFETIME_CONDITION(AS_Character, S_ReplicatedMovement, COND_SimulatedOrPhysics);
+	DOREPLIFETIME(AS_Character, MovementProfile);
+}
+
+void AS_Character::PreReplication(IRepChangedPropertyTracker &ChangedPropertyTracker)
+{
+	Super::PreReplication(ChangedPropertyTracker);
+
+	//: Super gathered the current movement, quantizing it here means replication only sees a change once it shows on the wire
+	S_ReplicatedMovement.Set(GetReplicatedMovement(), bIsSprinting, bWantsToWalk, MovementPtr ? MovementPtr->GetProfileSettings().AxisSpeedLimit : 0.0f);
+	DOREPLIFETIME_ACTIVE_OVERRIDE(AS_Character, S_ReplicatedMovement, IsReplicatingMovement());
+}
+
+void AS_Character::OnRep_S_ReplicatedMovement()
+{
+	//: Updates naming a base this client missed are skipped and leave nothing new to apply
+	if (!S_ReplicatedMovement.ConsumeReceivedState())
+	{
+		return;
+	}
+
+	S_ReplicatedMovement.Get(GetReplicatedMovement_Mutable());
+	if (GetLocalRole() == ROLE_SimulatedProxy)
+	{
+		bIsSprinting = S_ReplicatedMovement.IsSprinting();
+		bWantsToWalk = S_ReplicatedMovement.WantsToWalk();
+	}
+	OnRep_ReplicatedMovement();
+}
+
+void AS_Character::SetMovementProfile(US_MovementProfile *Profile)
+{
+	MovementProfile = Profile;
+	OnRep_MovementProfile();
+}
+
+void AS_Character::OnRep_MovementProfile()
+{
+	//: Owning clients have to predict with the profile the server runs, simulated proxies extrapolate with it
+	if (MovementPtr)
+	{
+		MovementPtr->SetMovementProfile(MovementProfile);
+	}
+	MaxJumpTime = -4.0f * GetCharacterMovement()->JumpZVelocity / (3.0f * GetCharacterMovement()->GetGravityZ());
+}
+
 //~ Called to bind functionality to input
 void AS_Character::SetupPlayerInputComponent(UInputComponent *PlayerInputComponent)
 {
@@ -91,6 +198,9 @@ void AS_Character::Move(const FInputActionValue &Value)
 	// input is a Vector2D
 	FVector2D MovementVector = Value.Get<FVector2D>();
 
+	MoveInput = MovementVector;
+	MoveInputFrame = GFrameCounter;
+
 	if (Controller != nullptr)
 	{
 		// add movement
@@ -179,6 +289,24 @@ void AS_Character::OnMovementModeChanged(EMovementMode PrevMovementMode, uint8 P
 	MovementModeChangedDelegate.Broadcast(this, PrevMovementMode, PrevCustomMode);
 }
 
+void AS_Character::SetMovementRenderOffset(const FVector &Offset)
+{
+	const bool bHasOffset = !Offset.IsNearlyZero();
+	if (!bHasOffset && !bHasMovementRenderOffset)
+	{
+		//: Leave the mesh alone so network smoothing can drive it
+		return;
+	}
+	bHasMovementRenderOffset = bHasOffset;
+
+	const FVector LocalOffset = GetActorQuat().UnrotateVector(Offset);
+	FirstPersonCameraComponent->SetRelativeLocation(DefaultCameraRelativeLocation + LocalOffset);
+	if (USkeletalMeshComponent *CharacterMesh = GetMesh())
+	{
+		CharacterMesh->SetRelativeLocation(GetBaseTranslationOffset() + LocalOffset);
+	}
+}
+
 void AS_Character::RecalculateBaseEyeHeight()
 {
 	const ACharacter *DefaultCharacter = GetClass()->GetDefaultObject<ACharacter>();
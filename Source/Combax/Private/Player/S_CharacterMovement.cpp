@@ -2,7 +2,15 @@
 
 #include "Player/S_Character.h"
 #include "Player/S_CharacterMovement.h"
+#include "Player/S_MoveKernel.h"
+#include "Player/S_MovementManager.h"
+#include "Player/S_MovementProfile.h"
+#include "Player/S_MovementStats.h"
+#include "Player/S_SurfaceIndex.h"
+#include "Components/BrushComponent.h"
 #include "Components/CapsuleComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Curves/CurveFloat.h"
 #include "Engine/Engine.h"
 #include "Engine/World.h"
 #include "GameFramework/Character.h"
@@ -10,13 +18,114 @@
 #include "Kismet/GameplayStatics.h"
 #include "PhysicalMaterials/PhysicalMaterial.h"
 #include "PhysicsEngine/PhysicsSettings.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogS_CharacterMovement, Log, All);
+
+DEFINE_STAT(STAT_CombaxFloorFrictionSweeps);
+DEFINE_STAT(STAT_CombaxFloorFrictionSweepsSaved);
+DEFINE_STAT(STAT_CombaxMovementTick);
+DEFINE_STAT(STAT_CombaxCalcVelocity);
+DEFINE_STAT(STAT_CombaxPhysFalling);
+DEFINE_STAT(STAT_CombaxApplyVelocityBraking);
+DEFINE_STAT(STAT_CombaxShouldCatchAir);
+DEFINE_STAT(STAT_CombaxIsValidLandingSpot);
+DEFINE_STAT(STAT_CombaxFindFloor);
+DEFINE_STAT(STAT_CombaxTraceCharacterFloor);
+DEFINE_STAT(STAT_CombaxFallClearance);
+DEFINE_STAT(STAT_CombaxMovementSweeps);
+DEFINE_STAT(STAT_CombaxLandingSpotChecks);
+DEFINE_STAT(STAT_CombaxCatchAirChecks);
+DEFINE_STAT(STAT_CombaxCatchAirs);
+DEFINE_STAT(STAT_CombaxBrakingSubSteps);
+DEFINE_STAT(STAT_CombaxSurfaceIndexHits);
+DEFINE_STAT(STAT_CombaxSurfaceIndexMisses);
+DEFINE_STAT(STAT_CombaxFallSweepsSkipped);
+DEFINE_STAT(STAT_CombaxBatchedVelocityHits);
+DEFINE_STAT(STAT_CombaxBatchedVelocityMisses);
+DEFINE_STAT(STAT_CombaxProxiesFullLOD);
+DEFINE_STAT(STAT_CombaxProxiesReducedLOD);
+DEFINE_STAT(STAT_CombaxProxiesMinimalLOD);
+DEFINE_STAT(STAT_CombaxCorrections);
+DEFINE_STAT(STAT_CombaxCorrectionsDeferred);
+DEFINE_STAT(STAT_CombaxReplayedMoves);
+
+static TAutoConsoleVariable<int32> CVarMovementCounters(TEXT("sv.movement.counters"), 0, TEXT("Time the movement hot path per pawn, in addition to counting calls and sweeps.\n"), ECVF_Default);
+static TAutoConsoleVariable<int32> CVarSurfaceIndex(TEXT("sv.surfaceindex"), 1, TEXT("Validate landing spots on indexed static surfaces without a floor query.\n"), ECVF_Default);
+static TAutoConsoleVariable<int32> CVarCorrectionBudget(TEXT("sv.correctionbudget"), 1, TEXT("Scale the tolerated client position error with speed and rate limit corrections per connection.\n"), ECVF_Default);
+static TAutoConsoleVariable<int32> CVarFloorFrictionCache(TEXT("sv.floorfrictioncache"), 1, TEXT("Reuse the floor's surface friction while standing on the same component.\n"), ECVF_Default);
+
+//: How much the capsule is shrunk by when checking a tolerated client position can be reached
+static constexpr float ClientPositionSweepInset = 2.0f;
+
+FS_MovementCounters &FS_MovementCounters::operator+=(const FS_MovementCounters &Other)
+{
+	Ticks += Other.Ticks;
+	Sweeps += Other.Sweeps;
+	GameSeconds += Other.GameSeconds;
+	FloorFinds += Other.FloorFinds;
+	FloorTraces += Other.FloorTraces;
+	CalcVelocityCalls += Other.CalcVelocityCalls;
+	PhysFallingCalls += Other.PhysFallingCalls;
+	LandingSpotChecks += Other.LandingSpotChecks;
+	CatchAirChecks += Other.CatchAirChecks;
+	CatchAirs += Other.CatchAirs;
+	BrakingSubSteps += Other.BrakingSubSteps;
+	SurfaceIndexHits += Other.SurfaceIndexHits;
+	SurfaceIndexMisses += Other.SurfaceIndexMisses;
+	FallSweepsSkipped += Other.FallSweepsSkipped;
+	BatchedVelocityHits += Other.BatchedVelocityHits;
+	BatchedVelocityMisses += Other.BatchedVelocityMisses;
+	ServerMoveResponses += Other.ServerMoveResponses;
+	Corrections += Other.Corrections;
+	ClientPositionsAccepted += Other.ClientPositionsAccepted;
+	CorrectionsDeferred += Other.CorrectionsDeferred;
+	for (int32 Source = 0; Source < static_cast<int32>(ES_CorrectionSource::Count); ++Source)
+	{
+		CorrectionsBySource[Source] += Other.CorrectionsBySource[Source];
+	}
+	Replays += Other.Replays;
+	ReplayedMoves += Other.ReplayedMoves;
+	TickSeconds += Other.TickSeconds;
+	CalcVelocitySeconds += Other.CalcVelocitySeconds;
+	PhysFallingSeconds += Other.PhysFallingSeconds;
+	FloorSeconds += Other.FloorSeconds;
+	return *this;
+}
+
+ES_CorrectionSource FS_MovementCounters::GetTopCorrectionSource() const
+{
+	int32 Top = 0;
+	for (int32 Source = 1; Source < static_cast<int32>(ES_CorrectionSource::Count); ++Source)
+	{
+		Top = CorrectionsBySource[Source] > CorrectionsBySource[Top] ? Source : Top;
+	}
+	return static_cast<ES_CorrectionSource>(Top);
+}
+
+const TCHAR *GetCorrectionSourceName(ES_CorrectionSource Source)
+{
+	switch (Source)
+	{
+	case ES_CorrectionSource::SlopeBoost:
+		return TEXT("slope boosting");
+	case ES_CorrectionSource::CatchAir:
+		return TEXT("catching air");
+	case ES_CorrectionSource::ModeMismatch:
+		return TEXT("movement mode mismatch");
+	default:
+		return TEXT("other");
+	}
+}
+
+bool FS_MovementCounters::IsTimingEnabled()
+{
+	return CVarMovementCounters.GetValueOnAnyThread() != 0;
+}
 
-constexpr float JumpVelocity = 266.0f;
-constexpr float DesiredGravity = -1143.0f;
+const float MAX_STEP_SIDE_Z = 0.08f; //? maximum z value for the normal on the vertical side of steps
 
-const float MAX_STEP_SIDE_Z = 0.08f;		  //? maximum z value for the normal on the vertical side of steps
-const float VERTICAL_SLOPE_NORMAL_Z = 0.001f; //? Slope is vertical if Abs(Normal.Z) <= this threshold. Accounts for precision problems that sometimes angle
-											  //? normals slightly off horizontal for vertical surface.
+const FS_MovementProfileSettings US_CharacterMovement::DefaultProfileSettings;
 
 // Override default player movement
 US_CharacterMovement::US_CharacterMovement()
@@ -29,27 +138,41 @@ US_CharacterMovement::US_CharacterMovement()
 	AirControlBoostMultiplier = 0.0f;
 	AirControlBoostVelocityThreshold = 0.0f;
 
-	//: HL2 cl_(forward & side)speed = 450Hu
-	MaxAcceleration = 857.25f;
-
-	//: Set the default walk speed
-	WalkSpeed = 285.75f;
-	RunSpeed = 361.9f;
-	SprintSpeed = 609.6f;
-	MaxWalkSpeed = RunSpeed;
-
-	//: Acceleration multipliers (HL2's sv_accelerate and sv_airaccelerate)
-	GroundAccelerationMultiplier = 10.0f;
-	AirAccelerationMultiplier = 10.0f;
-
-	//: 30 air speed cap from HL2
-	AirSpeedCap = 57.15f;
+	//: HL2 speeds, acceleration, friction, jumping, gravity and step heights
+	MovementProfile = nullptr;
+	MigratedProfile = nullptr;
+	ApplyMovementSettings(DefaultProfileSettings);
+
+	//: Loaded over with whatever an old blueprint or placed pawn set, see MigrateDeprecatedSettings
+	GroundAccelerationMultiplier_DEPRECATED = DefaultProfileSettings.GroundAccelerationMultiplier;
+	AirAccelerationMultiplier_DEPRECATED = DefaultProfileSettings.AirAccelerationMultiplier;
+	AirSpeedCap_DEPRECATED = DefaultProfileSettings.AirSpeedCap;
+	MinStepHeight_DEPRECATED = DefaultProfileSettings.MinStepHeight;
+	WalkSpeed_DEPRECATED = DefaultProfileSettings.WalkSpeed;
+	RunSpeed_DEPRECATED = DefaultProfileSettings.RunSpeed;
+	SprintSpeed_DEPRECATED = DefaultProfileSettings.SprintSpeed;
+	SpeedMultMin_DEPRECATED = DefaultProfileSettings.SpeedMultMin;
+	SpeedMultMax_DEPRECATED = DefaultProfileSettings.SpeedMultMax;
+	AxisSpeedLimit_DEPRECATED = DefaultProfileSettings.AxisSpeedLimit;
+	BounceMultiplier_DEPRECATED = DefaultProfileSettings.BounceMultiplier;
+	SlidePolicy_DEPRECATED = DefaultProfileSettings.SlidePolicy;
 
-	//: HL2 like friction
-	//: sv_friction
-	GroundFriction = 4.0f;
-	BrakingFriction = 4.0f;
 	SurfaceFriction = 1.0f;
+	bFloorFrictionCacheValid = false;
+	SurfaceIndex = nullptr;
+	bHasClearFallBox = false;
+	MovementLOD = ES_MovementLOD::Full;
+	MovementLODPendingTime = 0.0f;
+	MoveDivergenceSource = ES_CorrectionSource::Other;
+	PendingCorrectionSource = ES_CorrectionSource::Other;
+	bAcceptClientPosition = false;
+	CorrectionTokens = 0.0f;
+	LastCorrectionTokenTime = 0.0;
+	FixedTimeAccumulator = 0.0f;
+	FixedStepRenderOffset = FVector::ZeroVector;
+	FixedStepStartLocation = FVector::ZeroVector;
+	CarriedFixedStepInput = FVector::ZeroVector;
+	bFixedStepFrame = false;
 	bUseSeparateBrakingFriction = false;
 
 	//: No multiplier
@@ -67,35 +190,15 @@ US_CharacterMovement::US_CharacterMovement()
 	BrakingDecelerationFalling = 0.0f;
 	BrakingDecelerationFlying = 190.5f;
 	BrakingDecelerationSwimming = 190.5f;
-	BrakingDecelerationWalking = 190.5f;
-
-	//: HL2 step height
-	MaxStepHeight = 34.29f;
-	DefaultStepHeight = MaxStepHeight;
-
-	//: Step height scaling due to speed
-	MinStepHeight = 10.0f;
-
-	//: Jump z from HL2's 160Hu
-	//: 21Hu jump height
-	//: 510ms jump time
-	JumpZVelocity = 304.8f;
 
 	//: Don't bounce off characters
 	JumpOffJumpZFactor = 0.0f;
 
-	//: Speed multiplier bounds
-	SpeedMultMin = SprintSpeed * 1.7f;
-	SpeedMultMax = SprintSpeed * 2.5f;
+	StepScaleCurve = nullptr;
 
 	//: Start out braking
 	bBrakingFrameTolerated = true;
 
-	//: Slope angle is 45.57 degrees
-	SetWalkableFloorZ(0.7f);
-	DefaultWalkableFloorZ = GetWalkableFloorZ();
-	AxisSpeedLimit = 6667.5f;
-
 	//: Tune physics interactions
 	StandingDownwardForceScale = 1.0f;
 
@@ -134,17 +237,28 @@ US_CharacterMovement::US_CharacterMovement()
 	NavAgentProps.bCanJump = true;
 	NavAgentProps.bCanFly = true;
 
-	//: Make sure gravity is correct for player movement
-	GravityScale = DesiredGravity / UPhysicsSettings::Get()->DefaultGravityZ;
-
 	//: Make sure ramp movement in correct
 	bMaintainHorizontalGroundVelocity = true;
 }
 
+void US_CharacterMovement::PostLoad()
+{
+	Super::PostLoad();
+	MigrateDeprecatedSettings();
+
+	if (MigratedProfile && !HasAnyFlags(RF_ClassDefaultObject))
+	{
+		UE_LOG(LogS_CharacterMovement, Log, TEXT("%s sets movement tunables that moved into movement profiles, running them as a profile of its own until one is set on the pawn"), *GetPathName());
+	}
+}
+
 void US_CharacterMovement::InitializeComponent()
 {
 	Super::InitializeComponent();
 	S_Character = Cast<AS_Character>(GetOwner());
+
+	//: Spawned pawns never load, they copy the deprecated tunables from their blueprint instead
+	MigrateDeprecatedSettings();
 }
 
 void US_CharacterMovement::OnRegister()
@@ -152,18 +266,66 @@ void US_CharacterMovement::OnRegister()
 	Super::OnRegister();
 }
 
+void US_CharacterMovement::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (US_MovementManager *Manager = GetWorld()->GetSubsystem<US_MovementManager>())
+	{
+		Manager->Register(this);
+		//: Batched velocities have to be ready before we tick
+		PrimaryComponentTick.AddPrerequisite(Manager, Manager->GetTickFunction());
+	}
+
+	SurfaceIndex = GetWorld()->GetSubsystem<US_SurfaceIndex>();
+}
+
+void US_CharacterMovement::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (US_MovementManager *Manager = GetWorld()->GetSubsystem<US_MovementManager>())
+	{
+		PrimaryComponentTick.RemovePrerequisite(Manager, Manager->GetTickFunction());
+		Manager->Unregister(this);
+	}
+	SurfaceIndex = nullptr;
+
+	if (MovementProfile)
+	{
+		MovementProfile->OnSettingsChanged.Remove(MovementProfileChangedHandle);
+	}
+	MovementProfileChangedHandle.Reset();
+
+	Super::EndPlay(EndPlayReason);
+}
+
 //~ ==== Others ============================================================================================= ~//
 
-float GetFrictionFromHit(const FHitResult &Hit)
+float GetFrictionFromMaterial(const UPhysicalMaterial *PhysMaterial)
 {
 	float SurfaceFriction = 1.0f;
-	if (Hit.PhysMaterial.IsValid())
+	if (PhysMaterial)
 	{
-		SurfaceFriction = FMath::Min(1.0f, Hit.PhysMaterial->Friction * 1.25f);
+		SurfaceFriction = FMath::Min(1.0f, PhysMaterial->Friction * 1.25f);
 	}
 	return SurfaceFriction;
 }
 
+float GetFrictionFromHit(const FHitResult &Hit)
+{
+	return GetFrictionFromMaterial(Hit.PhysMaterial.Get());
+}
+
+//~ Whether every complex collision face of the component resolves to the same physical material
+static bool HasUniformFloorMaterial(const UPrimitiveComponent *Component)
+{
+	if (const UStaticMeshComponent *StaticMesh = Cast<UStaticMeshComponent>(Component))
+	{
+		return StaticMesh->GetNumMaterials() <= 1;
+	}
+	//: Brushes only carry their body's material. Anything else (landscapes in particular) can vary per face.
+	return Component && Component->IsA<UBrushComponent>();
+}
+
 bool US_CharacterMovement::ShouldLimitAirControl(float DeltaTime, const FVector &FallAcceleration) const
 {
 	return false;
@@ -192,24 +354,41 @@ bool US_CharacterMovement::DoJump(bool bClientSimulation)
 	return false;
 }
 
-void US_CharacterMovement::TwoWallAdjust(FVector &Delta, const FHitResult &Hit, const FVector &OldHitNormal) const
+template <typename TPolicy>
+FORCEINLINE FVector US_CharacterMovement::ComputeSlideVectorFor(const FVector &Delta, float Time, const FVector &Normal, const FHitResult &Hit) const
 {
-	Super::TwoWallAdjust(Delta, Hit, OldHitNormal);
-}
-
-float US_CharacterMovement::SlideAlongSurface(const FVector &Delta, float Time, const FVector &Normal, FHitResult &Hit, bool bHandleImpact)
-{
-	return Super::SlideAlongSurface(Delta, Time, Normal, Hit, bHandleImpact);
+	//: A falling Source slide only keeps HandleSlopeBoosting's clip, so skip the projection and the virtual calls in front of it
+	if constexpr (TPolicy::bClipVelocity)
+	{
+		if (IsFalling() && !bCheatFlying && !bConstrainToPlane)
+		{
+			MoveDivergenceSource = ES_CorrectionSource::SlopeBoost;
+			return TS_SlideMath<TPolicy>::ClipToSurface(Delta, Time, TS_SlideMath<TPolicy>::GetClipNormal(Normal, Hit.ImpactNormal), GetBounceCoefficient());
+		}
+	}
+	return Super::ComputeSlideVector(Delta, Time, Normal, Hit);
 }
 
 FVector US_CharacterMovement::ComputeSlideVector(const FVector &Delta, const float Time, const FVector &Normal, const FHitResult &Hit) const
 {
-	return Super::ComputeSlideVector(Delta, Time, Normal, Hit);
+	if (GetProfileSettings().SlidePolicy == ES_SlidePolicy::Source)
+	{
+		return ComputeSlideVectorFor<FS_SourceSlidePolicy>(Delta, Time, Normal, Hit);
+	}
+	return ComputeSlideVectorFor<FS_EngineSlidePolicy>(Delta, Time, Normal, Hit);
 }
 
-bool US_CharacterMovement::IsWithinEdgeTolerance(const FVector &CapsuleLocation, const FVector &TestImpactPoint, const float CapsuleRadius) const
+double US_CharacterMovement::TimeInlinedSlides(TArrayView<const FVector> Deltas, TArrayView<const FHitResult> Hits, float Time, int32 Count, FVector &InOutSum) const
 {
-	return Super::IsWithinEdgeTolerance(CapsuleLocation, TestImpactPoint, CapsuleRadius);
+	check(Deltas.Num() > 0 && Deltas.Num() == Hits.Num());
+
+	const double Start = FPlatformTime::Seconds();
+	for (int32 Index = 0, Sample = 0; Index < Count; ++Index)
+	{
+		InOutSum += ComputeSlideVectorFor<FS_SourceSlidePolicy>(Deltas[Sample], Time, Hits[Sample].Normal, Hits[Sample]);
+		Sample = Sample + 1 == Deltas.Num() ? 0 : Sample + 1;
+	}
+	return FPlatformTime::Seconds() - Start;
 }
 
 bool US_CharacterMovement::ShouldCheckForValidLandingSpot(float DeltaTime, const FVector &Delta, const FHitResult &Hit) const
@@ -220,13 +399,13 @@ bool US_CharacterMovement::ShouldCheckForValidLandingSpot(float DeltaTime, const
 void US_CharacterMovement::UpdateCharacterStateBeforeMovement(float DeltaSeconds) //* -> Velocity.Z
 {
 	Super::UpdateCharacterStateBeforeMovement(DeltaSeconds);
-	Velocity.Z = FMath::Clamp(Velocity.Z, -AxisSpeedLimit, AxisSpeedLimit);
+	Velocity.Z = FMath::Clamp(Velocity.Z, -GetProfileSettings().AxisSpeedLimit, GetProfileSettings().AxisSpeedLimit);
 }
 
 void US_CharacterMovement::UpdateCharacterStateAfterMovement(float DeltaSeconds) //* -> Velocity.Z && UpdateSurfaceFriction
 {
 	Super::UpdateCharacterStateAfterMovement(DeltaSeconds);
-	Velocity.Z = FMath::Clamp(Velocity.Z, -AxisSpeedLimit, AxisSpeedLimit);
+	Velocity.Z = FMath::Clamp(Velocity.Z, -GetProfileSettings().AxisSpeedLimit, GetProfileSettings().AxisSpeedLimit);
 	UpdateSurfaceFriction();
 }
 
@@ -234,63 +413,219 @@ void US_CharacterMovement::UpdateCharacterStateAfterMovement(float DeltaSeconds)
 
 void US_CharacterMovement::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction)
 {
+	SCOPE_CYCLE_COUNTER(STAT_CombaxMovementTick);
+	TRACE_CPUPROFILER_EVENT_SCOPE(US_CharacterMovement::TickComponent);
+
+	++MovementCounters.Ticks;
+	MovementCounters.GameSeconds += DeltaTime;
+	FS_MovementCounterScope CounterScope(MovementCounters.TickSeconds);
+
+	//: The engine tick runs once per frame either way, ControlledCharacterMove splits the move into fixed steps
+	bFixedStepFrame = ShouldUseFixedTimestep();
+	if (!bFixedStepFrame)
+	{
+		FixedTimeAccumulator = 0.0f;
+		FixedStepRenderOffset = FVector::ZeroVector;
+		CarriedFixedStepInput = FVector::ZeroVector;
+	}
+	TickMovementStep(DeltaTime, TickType, ThisTickFunction);
+	bFixedStepFrame = false;
+
+	//: Only good for the frame it was checked in
+	bHasClearFallBox = false;
+
+	if (S_Character)
+	{
+		S_Character->SetMovementRenderOffset(FixedStepRenderOffset);
+	}
+
+	//: Where this pawn ended up this server frame, for rewinding shots later
+	if (CharacterOwner && CharacterOwner->HasAuthority() && UpdatedComponent)
+	{
+		const UCapsuleComponent *Capsule = CharacterOwner->GetCapsuleComponent();
+		MovementHistory.Record(GetWorld()->GetTimeSeconds(), UpdatedComponent->GetComponentLocation(), Capsule->GetScaledCapsuleHalfHeight(), Capsule->GetScaledCapsuleRadius());
+	}
+}
+
+void US_CharacterMovement::TickMovementStep(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction)
+{
+	//: Fixed step frames record each step as they run it instead
+	const bool bRecordFrame = MovementRecorder && !bFixedStepFrame;
+
+	//: Input has to be captured before the tick consumes it
+	FS_MovementFrame RecordedFrame;
+	if (bRecordFrame)
+	{
+		RecordedFrame = CaptureRecordedFrame(DeltaTime);
+	}
+
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
+	if (bRecordFrame)
+	{
+		AddRecordedFrame(RecordedFrame);
+	}
+
+	FinishMovementStep();
+}
+
+FS_MovementFrame US_CharacterMovement::CaptureRecordedFrame(float DeltaTime) const
+{
+	FS_MovementFrame RecordedFrame;
+	if (S_Character)
+	{
+		const FRotator ViewRotation = S_Character->GetControlRotation();
+		RecordedFrame.DeltaTime = DeltaTime;
+		RecordedFrame.MoveInput = FVector2f(S_Character->GetMoveInput());
+		RecordedFrame.Pitch = ViewRotation.Pitch;
+		RecordedFrame.Yaw = ViewRotation.Yaw;
+		RecordedFrame.Buttons = (S_Character->bPressedJump ? RecordedButton_Jump : 0) | (S_Character->IsSprinting() ? RecordedButton_Sprint : 0) | (S_Character->DoesWantToWalk() ? RecordedButton_Walk : 0);
+	}
+	return RecordedFrame;
+}
+
+void US_CharacterMovement::AddRecordedFrame(FS_MovementFrame &RecordedFrame)
+{
+	if (MovementRecorder && S_Character && UpdatedComponent)
+	{
+		RecordedFrame.Location = FVector3f(UpdatedComponent->GetComponentLocation());
+		RecordedFrame.Velocity = FVector3f(Velocity);
+		MovementRecorder->AddFrame(RecordedFrame);
+	}
+}
+
+void US_CharacterMovement::FinishMovementStep()
+{
 	if (bHasDeferredMovementMode)
 	{
 		bHasDeferredMovementMode = false;
 		SetMovementMode(DeferredMovementMode);
 	}
 
-	//: Skip player movement when we're simulating physics (ie ragdoll)
-	if (UpdatedComponent->IsSimulatingPhysics())
+	if (UpdatedComponent && !UpdatedComponent->IsSimulatingPhysics())
 	{
-		return;
+		bBrakingFrameTolerated = IsMovingOnGround();
 	}
+}
 
-	if (RollAngle != 0 && RollSpeed != 0 && S_Character->GetController())
+void US_CharacterMovement::ControlledCharacterMove(const FVector &InputVector, float DeltaSeconds)
+{
+	if (bFixedStepFrame)
 	{
-		FRotator ControlRotation = S_Character->GetController()->GetControlRotation();
-		ControlRotation.Roll = GetCameraRoll();
-		S_Character->GetController()->SetControlRotation(ControlRotation);
+		RunFixedSteps(InputVector, DeltaSeconds);
+	}
+	else
+	{
+		Super::ControlledCharacterMove(InputVector, DeltaSeconds);
 	}
-
-	bBrakingFrameTolerated = IsMovingOnGround();
 }
 
-FVector US_CharacterMovement::HandleSlopeBoosting(const FVector &SlideResult, const FVector &Delta, const float Time, const FVector &Normal, const FHitResult &Hit) const
+void US_CharacterMovement::RunFixedSteps(const FVector &InputVector, float DeltaTime)
 {
-	if (bCheatFlying)
+	const float FixedDeltaTime = GetFixedDeltaTime();
+	const int32 MaxSteps = FMath::Max(MaxFixedStepsPerFrame, 1);
+
+	//: Drop what can't be caught up on rather than falling further behind every frame
+	FixedTimeAccumulator = FMath::Min(FixedTimeAccumulator + DeltaTime, FixedDeltaTime * MaxSteps);
+
+	//: Input from a frame too short for a step is held for the next step instead of dropped. Jump presses wait on their own,
+	//: they are only cleared by a move.
+	const FVector StepInput = InputVector.IsZero() ? CarriedFixedStepInput : InputVector;
+	if (FixedTimeAccumulator < FixedDeltaTime)
 	{
-		return Super::HandleSlopeBoosting(SlideResult, Delta, Time, Normal, Hit);
+		CarriedFixedStepInput = StepInput;
+	}
+	else
+	{
+		CarriedFixedStepInput = FVector::ZeroVector;
+	}
+
+	while (FixedTimeAccumulator >= FixedDeltaTime)
+	{
+		FixedTimeAccumulator -= FixedDeltaTime;
+		FixedStepStartLocation = UpdatedComponent->GetComponentLocation();
+
+		//: One recorded frame per step, so a replay that steps once per frame sees the same moves
+		FS_MovementFrame RecordedFrame;
+		if (MovementRecorder)
+		{
+			RecordedFrame = CaptureRecordedFrame(FixedDeltaTime);
+		}
+
+		//: Only the move itself repeats per step, the rest of the engine tick already ran once for the frame
+		Super::ControlledCharacterMove(StepInput, FixedDeltaTime);
+
+		if (MovementRecorder)
+		{
+			AddRecordedFrame(RecordedFrame);
+		}
+		FinishMovementStep();
+		if (!HasValidData() || UpdatedComponent->IsSimulatingPhysics())
+		{
+			FixedTimeAccumulator = 0.0f;
+			FixedStepRenderOffset = FVector::ZeroVector;
+			return;
+		}
 	}
-	const float WallAngle = FMath::Abs(Hit.ImpactNormal.Z);
-	FVector ImpactNormal;
 
-	//: If too extreme, use the more stable hit normal
-	if (WallAngle <= VERTICAL_SLOPE_NORMAL_Z || WallAngle == 1.0f)
+	//: Draw somewhere between the last two steps, we are this far into the next one
+	const float Alpha = FixedTimeAccumulator / FixedDeltaTime;
+	const FVector CurrentLocation = UpdatedComponent->GetComponentLocation();
+	FixedStepRenderOffset = (FixedStepStartLocation - CurrentLocation) * (1.0f - Alpha);
+
+	//: Don't smear teleports
+	if (FixedStepRenderOffset.SizeSquared() > FMath::Square(GetMaxSpeed() * FixedDeltaTime * 4.0f + MAX_FLOOR_DIST))
 	{
-		ImpactNormal = Normal;
+		FixedStepRenderOffset = FVector::ZeroVector;
 	}
-	else
+}
+
+bool US_CharacterMovement::ShouldUseFixedTimestep() const
+{
+	if (!bUseFixedTimestep || !HasValidData() || UpdatedComponent->IsSimulatingPhysics())
+	{
+		return false;
+	}
+
+	//: Remote clients are moved by the steps they send, which are fixed when they run this mode too
+	return IsSimulatingOwnMoves();
+}
+
+bool US_CharacterMovement::IsSimulatingOwnMoves() const
+{
+	//: Same split as TickComponent: a remote client's pawn on the server is moved by its ServerMove calls instead
+	const ENetRole Role = CharacterOwner->GetLocalRole();
+	return Role == ROLE_AutonomousProxy || (Role == ROLE_Authority && (CharacterOwner->IsLocallyControlled() || (!CharacterOwner->Controller && bRunPhysicsWithNoController)));
+}
+
+FVector US_CharacterMovement::HandleSlopeBoosting(const FVector &SlideResult, const FVector &Delta, const float Time, const FVector &Normal, const FHitResult &Hit) const
+{
+	if (bCheatFlying || GetProfileSettings().SlidePolicy != ES_SlidePolicy::Source)
 	{
-		ImpactNormal = Hit.ImpactNormal;
+		return Super::HandleSlopeBoosting(SlideResult, Delta, Time, Normal, Hit);
 	}
+	FVector ClipNormal = TS_SlideMath<FS_SourceSlidePolicy>::GetClipNormal(Normal, Hit.ImpactNormal);
 	if (bConstrainToPlane)
 	{
-		ImpactNormal = ConstrainNormalToPlane(ImpactNormal);
+		ClipNormal = ConstrainNormalToPlane(ClipNormal);
 	}
-	const float BounceCoefficient = 1.0f + BounceMultiplier * (1.0f - SurfaceFriction);
-	return (Delta - BounceCoefficient * Delta.ProjectOnToNormal(ImpactNormal)) * Time;
+	MoveDivergenceSource = ES_CorrectionSource::SlopeBoost;
+	return TS_SlideMath<FS_SourceSlidePolicy>::ClipToSurface(Delta, Time, ClipNormal, GetBounceCoefficient());
 }
 
 bool US_CharacterMovement::ShouldCatchAir(const FFindFloorResult &OldFloor, const FFindFloorResult &NewFloor)
 {
+	SCOPE_CYCLE_COUNTER(STAT_CombaxShouldCatchAir);
+	TRACE_CPUPROFILER_EVENT_SCOPE(US_CharacterMovement::ShouldCatchAir);
+
+	++MovementCounters.CatchAirChecks;
+	INC_DWORD_STAT(STAT_CombaxCatchAirChecks);
+
 	//: Get surface friction
 	const float OldSurfaceFriction = GetFrictionFromHit(OldFloor.HitResult);
 
 	//: As we get faster, make our speed multiplier smaller (so it scales with smaller friction)
-	const float SpeedMult = SpeedMultMax / Velocity.Size2D();
+	const float SpeedMult = GetProfileSettings().SpeedMultMax / Velocity.Size2D();
 	const bool bSliding = OldSurfaceFriction * SpeedMult < 0.5f;
 
 	//: See if we got less steep or are continuing at the same slope
@@ -309,16 +644,25 @@ bool US_CharacterMovement::ShouldCatchAir(const FFindFloorResult &OldFloor, cons
 	//: So, our only relevant conditions are when we are going up a ramp or strafing off of it.
 	const bool bMovingForCatchAir = bWasGoingUpRamp || bStrafingOffRamp;
 
-	if (bSliding && bGainingRamp && bMovingForCatchAir)
+	const bool bCatchAir = (bSliding && bGainingRamp && bMovingForCatchAir) || Super::ShouldCatchAir(OldFloor, NewFloor);
+	if (bCatchAir)
 	{
-		return true;
+		++MovementCounters.CatchAirs;
+		INC_DWORD_STAT(STAT_CombaxCatchAirs);
+		MoveDivergenceSource = ES_CorrectionSource::CatchAir;
 	}
 
-	return Super::ShouldCatchAir(OldFloor, NewFloor);
+	return bCatchAir;
 }
 
 bool US_CharacterMovement::IsValidLandingSpot(const FVector &CapsuleLocation, const FHitResult &Hit) const
 {
+	SCOPE_CYCLE_COUNTER(STAT_CombaxIsValidLandingSpot);
+	TRACE_CPUPROFILER_EVENT_SCOPE(US_CharacterMovement::IsValidLandingSpot);
+
+	++MovementCounters.LandingSpotChecks;
+	INC_DWORD_STAT(STAT_CombaxLandingSpotChecks);
+
 	if (!Hit.bBlockingHit)
 	{
 		return false;
@@ -356,7 +700,7 @@ bool US_CharacterMovement::IsValidLandingSpot(const FVector &CapsuleLocation, co
 		}
 
 		// Reject hits that are barely on the cusp of the radius of the capsule
-		if (!IsWithinEdgeTolerance(Hit.Location, Hit.ImpactPoint, PawnRadius))
+		if (!Super::IsWithinEdgeTolerance(Hit.Location, Hit.ImpactPoint, PawnRadius))
 		{
 			return false;
 		}
@@ -370,11 +714,14 @@ bool US_CharacterMovement::IsValidLandingSpot(const FVector &CapsuleLocation, co
 			return false;
 		}
 	}
-	FFindFloorResult FloorResult;
-	FindFloor(CapsuleLocation, FloorResult, false, &Hit);
-	if (!FloorResult.IsWalkableFloor())
+	if (!IsLandingOnIndexedSurface(CapsuleLocation, Hit))
 	{
-		return false;
+		FFindFloorResult FloorResult;
+		FindFloor(CapsuleLocation, FloorResult, false, &Hit);
+		if (!FloorResult.IsWalkableFloor())
+		{
+			return false;
+		}
 	}
 	// Slope bug fix
 	// If moving up a slope...
@@ -387,7 +734,7 @@ bool US_CharacterMovement::IsValidLandingSpot(const FVector &CapsuleLocation, co
 		DeflectionVector = ComputeSlideVector(DeflectionVector, 1.0f, Hit.Normal, Hit);
 
 		// going up too fast to land
-		if (DeflectionVector.Z > JumpVelocity)
+		if (DeflectionVector.Z > GetProfileSettings().MaxLandingVelocityZ)
 		{
 			return false;
 		}
@@ -395,8 +742,39 @@ bool US_CharacterMovement::IsValidLandingSpot(const FVector &CapsuleLocation, co
 	return true;
 }
 
+bool US_CharacterMovement::IsLandingOnIndexedSurface(const FVector &CapsuleLocation, const FHitResult &Hit) const
+{
+	//: Penetrating hits are sorted out by FindFloor's smaller capsule
+	if (!SurfaceIndex || Hit.bStartPenetrating || CVarSurfaceIndex.GetValueOnGameThread() == 0)
+	{
+		return false;
+	}
+
+	//: The plane the sweep hit, with every edge further away than the capsule radius, so the floor sweep can't find anything else
+	const float PawnRadius = CharacterOwner->GetCapsuleComponent()->GetScaledCapsuleRadius();
+	const FS_SurfaceFace *Face = SurfaceIndex->FindFace(Hit.GetComponent(), Hit.ImpactPoint, CapsuleLocation, PawnRadius);
+	const bool bOnIndexedSurface = Face && (Face->Normal | Hit.ImpactNormal) > 0.999f && Face->Normal.Z >= GetWalkableFloorZ();
+
+	if (bOnIndexedSurface)
+	{
+		++MovementCounters.SurfaceIndexHits;
+		INC_DWORD_STAT(STAT_CombaxSurfaceIndexHits);
+	}
+	else
+	{
+		++MovementCounters.SurfaceIndexMisses;
+		INC_DWORD_STAT(STAT_CombaxSurfaceIndexMisses);
+	}
+	return bOnIndexedSurface;
+}
+
 void US_CharacterMovement::TraceCharacterFloor(FHitResult &OutHit)
 {
+	SCOPE_CYCLE_COUNTER(STAT_CombaxTraceCharacterFloor);
+	TRACE_CPUPROFILER_EVENT_SCOPE(US_CharacterMovement::TraceCharacterFloor);
+
+	++MovementCounters.FloorTraces;
+
 	FCollisionQueryParams CapsuleParams(SCENE_QUERY_STAT(CharacterFloorTrace), false, CharacterOwner);
 	FCollisionResponseParams ResponseParam;
 	InitCollisionParams(CapsuleParams, ResponseParam);
@@ -426,27 +804,54 @@ void US_CharacterMovement::OnMovementModeChanged(EMovementMode PreviousMovementM
 	// Reset step side if we are changing modes
 	StepSide = false;
 
-	// did we jump or land
-	bool bJumped = false;
+	//: Super zeroes Z velocity on landing, keep it for the transition payload
+	const FVector ImpactVelocity = Velocity;
+
+	Super::OnMovementModeChanged(PreviousMovementMode, PreviousCustomMode);
 
-	if (PreviousMovementMode == MOVE_Walking && MovementMode == MOVE_Falling)
+	if (OnMovementTransition.IsBound())
 	{
-		bJumped = true;
+		const FS_MovementTransition Transition(this, PreviousMovementMode, ImpactVelocity);
+		if (Transition.bJumped || Transition.IsLanding())
+		{
+			OnMovementTransition.Broadcast(Transition);
+		}
 	}
+}
 
-	FHitResult Hit;
-	TraceCharacterFloor(Hit);
+FS_MovementTransition::FS_MovementTransition(US_CharacterMovement *InMovement, EMovementMode InPreviousMovementMode, const FVector &InImpactVelocity)
+	: Movement(InMovement), PreviousMovementMode(InPreviousMovementMode), MovementMode(InMovement->MovementMode), ImpactVelocity(InImpactVelocity)
+{
+	bJumped = PreviousMovementMode == MOVE_Walking && MovementMode == MOVE_Falling;
+}
 
-	Super::OnMovementModeChanged(PreviousMovementMode, PreviousCustomMode);
+const FHitResult &FS_MovementTransition::GetFloorHit() const
+{
+	if (!FloorHit.IsSet())
+	{
+		FHitResult Hit;
+		Movement->TraceCharacterFloor(Hit);
+		FloorHit = Hit;
+	}
+	return FloorHit.GetValue();
+}
+
+float FS_MovementTransition::GetSurfaceFriction() const
+{
+	return GetFrictionFromHit(GetFloorHit());
 }
 
-float US_CharacterMovement::GetCameraRoll()
+float US_CharacterMovement::GetCameraRoll(const FRotator &ViewRotation) const
 {
 	if (RollSpeed == 0.0f || RollAngle == 0.0f)
 	{
 		return 0.0f;
 	}
-	float Side = Velocity | FRotationMatrix(GetCharacterOwner()->GetControlRotation()).GetScaledAxis(EAxis::Y);
+
+	//: Right vector of the view's yaw, pitch doesn't change it and roll would feed back into itself
+	float SinYaw, CosYaw;
+	FMath::SinCos(&SinYaw, &CosYaw, FMath::DegreesToRadians(ViewRotation.Yaw));
+	float Side = Velocity.X * -SinYaw + Velocity.Y * CosYaw;
 	const float Sign = FMath::Sign(Side);
 	Side = FMath::Abs(Side);
 	if (Side < RollSpeed)
@@ -462,78 +867,41 @@ float US_CharacterMovement::GetCameraRoll()
 
 void US_CharacterMovement::ApplyVelocityBraking(float DeltaTime, float Friction, float BrakingDeceleration)
 {
-	// UE4-COPY: void UCharacterMovementComponent::ApplyVelocityBraking(float DeltaTime, float Friction, float BrakingDeceleration)
-	if (Velocity.IsNearlyZero(0.1f) || !HasValidData() || HasAnimRootMotion() || DeltaTime < MIN_TICK_TIME)
-	{
-		return;
-	}
-
-	const float Speed = Velocity.Size2D();
-
-	const float FrictionFactor = FMath::Max(0.0f, BrakingFrictionFactor);
-	Friction = FMath::Max(0.0f, Friction * FrictionFactor);
-	{
-		BrakingDeceleration = FMath::Max(BrakingDeceleration, Speed);
-	}
-	BrakingDeceleration = FMath::Max(0.0f, BrakingDeceleration);
-	const bool bZeroFriction = FMath::IsNearlyZero(Friction);
-	const bool bZeroBraking = BrakingDeceleration == 0.0f;
+	SCOPE_CYCLE_COUNTER(STAT_CombaxApplyVelocityBraking);
+	TRACE_CPUPROFILER_EVENT_SCOPE(US_CharacterMovement::ApplyVelocityBraking);
 
-	if (bZeroFriction || bZeroBraking)
+	if (!HasValidData() || HasAnimRootMotion())
 	{
 		return;
 	}
 
-	const FVector OldVel = Velocity;
-
-	// subdivide braking to get reasonably consistent results at lower frame rates
-	// (important for packet loss situations w/ networking)
-	float RemainingTime = DeltaTime;
-	const float MaxTimeStep = FMath::Clamp(BrakingSubStepTime, 1.0f / 75.0f, 1.0f / 20.0f);
-
-	// Decelerate to brake to a stop
-	const FVector RevAccel = -Velocity.GetSafeNormal();
-	while (RemainingTime >= MIN_TICK_TIME)
-	{
-		const float Delta = (RemainingTime > MaxTimeStep ? FMath::Min(MaxTimeStep, RemainingTime * 0.5f) : RemainingTime);
-		RemainingTime -= Delta;
-
-		// apply friction and braking
-		Velocity += (Friction * BrakingDeceleration * RevAccel) * Delta;
-
-		// Don't reverse direction
-		if ((Velocity | OldVel) <= 0.0f)
-		{
-			Velocity = FVector::ZeroVector;
-			return;
-		}
-	}
-
-	// Clamp to zero if nearly zero
-	if (Velocity.IsNearlyZero(KINDA_SMALL_NUMBER))
-	{
-		Velocity = FVector::ZeroVector;
-	}
+	const int32 SubSteps = FSourceMoveKernel::ApplyBraking(Velocity, DeltaTime, Friction, BrakingDeceleration, GetMoveSettings());
+	MovementCounters.BrakingSubSteps += SubSteps;
+	INC_DWORD_STAT_BY(STAT_CombaxBrakingSubSteps, SubSteps);
 }
 
 FVector US_CharacterMovement::NewFallVelocity(const FVector &InitialVelocity, const FVector &Gravity, float DeltaTime) const
 {
 	FVector FallVel = Super::NewFallVelocity(InitialVelocity, Gravity, DeltaTime);
-	FallVel.Z = FMath::Clamp(FallVel.Z, -AxisSpeedLimit, AxisSpeedLimit);
+	FallVel.Z = FMath::Clamp(FallVel.Z, -GetProfileSettings().AxisSpeedLimit, GetProfileSettings().AxisSpeedLimit);
 	return FallVel;
 }
 
 void US_CharacterMovement::UpdateSurfaceFriction(bool bIsSliding)
 {
+	//: Distant proxies keep the friction they had, it only shapes the look of their movement
+	if (MovementLOD != ES_MovementLOD::Full)
+	{
+		return;
+	}
+
 	if (!IsFalling() && CurrentFloor.IsWalkableFloor())
 	{
-		FHitResult Hit;
-		TraceCharacterFloor(Hit);
-		SurfaceFriction = GetFrictionFromHit(Hit);
+		SurfaceFriction = GetFloorSurfaceFriction();
 	}
 	else
 	{
-		const bool bPlayerControlsMovedVertically = Velocity.Z > JumpVelocity || Velocity.Z <= 0.0f || bCheatFlying;
+		const bool bPlayerControlsMovedVertically = Velocity.Z > GetProfileSettings().MaxLandingVelocityZ || Velocity.Z <= 0.0f || bCheatFlying;
 		if (bPlayerControlsMovedVertically)
 		{
 			SurfaceFriction = 1.0f;
@@ -545,17 +913,89 @@ void US_CharacterMovement::UpdateSurfaceFriction(bool bIsSliding)
 	}
 }
 
+float US_CharacterMovement::GetFloorSurfaceFriction()
+{
+	//: The floor query doesn't ask for materials, but use it if it came with one
+	if (CurrentFloor.HitResult.PhysMaterial.IsValid())
+	{
+		INC_DWORD_STAT(STAT_CombaxFloorFrictionSweepsSaved);
+		return GetFrictionFromHit(CurrentFloor.HitResult);
+	}
+
+	const UPrimitiveComponent *FloorComponent = CurrentFloor.HitResult.GetComponent();
+	if (bFloorFrictionCacheValid && FloorComponent && CachedFrictionFloor.Get() == FloorComponent && CVarFloorFrictionCache.GetValueOnGameThread() != 0)
+	{
+		INC_DWORD_STAT(STAT_CombaxFloorFrictionSweepsSaved);
+		return GetFrictionFromMaterial(CachedFrictionMaterial.Get());
+	}
+
+	INC_DWORD_STAT(STAT_CombaxFloorFrictionSweeps);
+	FHitResult Hit;
+	TraceCharacterFloor(Hit);
+
+	//: Only remember the result if the sweep agrees with the floor we're standing on
+	bFloorFrictionCacheValid = FloorComponent && Hit.GetComponent() == FloorComponent && HasUniformFloorMaterial(FloorComponent);
+	CachedFrictionFloor = bFloorFrictionCacheValid ? FloorComponent : nullptr;
+	CachedFrictionMaterial = bFloorFrictionCacheValid ? Hit.PhysMaterial : nullptr;
+
+	return GetFrictionFromHit(Hit);
+}
+
+void US_CharacterMovement::InvalidateFloorFrictionCache()
+{
+	bFloorFrictionCacheValid = false;
+	CachedFrictionFloor = nullptr;
+	CachedFrictionMaterial = nullptr;
+}
+
+void US_CharacterMovement::FindFloor(const FVector &CapsuleLocation, FFindFloorResult &OutFloorResult, bool bCanUseCachedLocation, const FHitResult *DownwardSweepResult) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_CombaxFindFloor);
+	TRACE_CPUPROFILER_EVENT_SCOPE(US_CharacterMovement::FindFloor);
+
+	++MovementCounters.FloorFinds;
+	FS_MovementCounterScope CounterScope(MovementCounters.FloorSeconds);
+
+	Super::FindFloor(CapsuleLocation, OutFloorResult, bCanUseCachedLocation, DownwardSweepResult);
+}
+
+bool US_CharacterMovement::MoveUpdatedComponentImpl(const FVector &Delta, const FQuat &NewRotation, bool bSweep, FHitResult *OutHit, ETeleportType Teleport)
+{
+	if (bSweep)
+	{
+		++MovementCounters.Sweeps;
+		INC_DWORD_STAT(STAT_CombaxMovementSweeps);
+	}
+	return Super::MoveUpdatedComponentImpl(Delta, NewRotation, bSweep, OutHit, Teleport);
+}
+
 void US_CharacterMovement::PhysFalling(float deltaTime, int32 Iterations)
 {
-	// TODO
-	//  SCOPE_CYCLE_COUNTER(STAT_CharPhysFalling);
-	//  CSV_SCOPED_TIMING_STAT_EXCLUSIVE(CharPhysFalling);
+	SCOPE_CYCLE_COUNTER(STAT_CombaxPhysFalling);
+	TRACE_CPUPROFILER_EVENT_SCOPE(US_CharacterMovement::PhysFalling);
 
 	if (deltaTime < MIN_TICK_TIME)
 	{
 		return;
 	}
 
+	++MovementCounters.PhysFallingCalls;
+	FS_MovementCounterScope CounterScope(MovementCounters.PhysFallingSeconds);
+
+	//: Picked once here so none of the slides in the loop go through a virtual call or a policy check
+	if (GetProfileSettings().SlidePolicy == ES_SlidePolicy::Source)
+	{
+		PhysFallingFor<FS_SourceSlidePolicy>(deltaTime, Iterations);
+	}
+	else
+	{
+		PhysFallingFor<FS_EngineSlidePolicy>(deltaTime, Iterations);
+	}
+}
+
+template <typename TPolicy>
+void US_CharacterMovement::PhysFallingFor(float deltaTime, int32 Iterations)
+{
 	FVector FallAcceleration = GetFallingLateralAcceleration(deltaTime);
 	FallAcceleration.Z = 0.f;
 	const bool bHasLimitedAirControl = ShouldLimitAirControl(deltaTime, FallAcceleration);
@@ -664,7 +1104,7 @@ void US_CharacterMovement::PhysFalling(float deltaTime, int32 Iterations)
 
 		// Move
 		FHitResult Hit(1.f);
-		SafeMoveUpdatedComponent(Adjusted, PawnRotation, true, Hit);
+		SafeMoveUpdatedComponent(Adjusted, PawnRotation, !IsFallClear(OldLocation, Adjusted), Hit);
 
 		if (!HasValidData())
 		{
@@ -742,9 +1182,9 @@ void US_CharacterMovement::PhysFalling(float deltaTime, int32 Iterations)
 
 				const FVector OldHitNormal = Hit.Normal;
 				const FVector OldHitImpactNormal = Hit.ImpactNormal;
-				FVector Delta = ComputeSlideVector(Adjusted, 1.f - Hit.Time, OldHitNormal, Hit);
+				FVector Delta = ComputeSlideVectorFor<TPolicy>(Adjusted, 1.f - Hit.Time, OldHitNormal, Hit);
 				// TODO: Maybe there's a better way of integrating this?
-				FVector DeltaStep = ComputeSlideVector(Velocity * timeTick, 1.f - Hit.Time, OldHitNormal, Hit);
+				FVector DeltaStep = ComputeSlideVectorFor<TPolicy>(Velocity * timeTick, 1.f - Hit.Time, OldHitNormal, Hit);
 
 				// Compute velocity after deflection (only gravity component for RootMotion)
 				if (subTimeTickRemaining > KINDA_SMALL_NUMBER && !bJustTeleported)
@@ -780,14 +1220,14 @@ void US_CharacterMovement::PhysFalling(float deltaTime, int32 Iterations)
 						}
 
 						// Act as if there was no air control on the last move when computing new deflection.
-						if (bHasLimitedAirControl && Hit.Normal.Z > VERTICAL_SLOPE_NORMAL_Z)
+						if (bHasLimitedAirControl && Hit.Normal.Z > TPolicy::VerticalSlopeNormalZ)
 						{
 							const FVector LastMoveNoAirControl = VelocityNoAirControl * LastMoveTimeSlice;
-							Delta = ComputeSlideVector(LastMoveNoAirControl, 1.f, OldHitNormal, Hit);
+							Delta = ComputeSlideVectorFor<TPolicy>(LastMoveNoAirControl, 1.f, OldHitNormal, Hit);
 						}
 
 						FVector PreTwoWallDelta = Delta;
-						TwoWallAdjust(Delta, Hit, OldHitNormal);
+						Super::TwoWallAdjust(Delta, Hit, OldHitNormal);
 
 						// Limit air control, but allow a slide along the second wall.
 						if (bHasLimitedAirControl)
@@ -861,6 +1301,12 @@ void US_CharacterMovement::CalcVelocity(float DeltaTime, float Friction, bool bF
 {
 	// UE4-COPY: void UCharacterMovementComponent::CalcVelocity(float DeltaTime, float Friction, bool bFluid, float BrakingDeceleration)
 
+	SCOPE_CYCLE_COUNTER(STAT_CombaxCalcVelocity);
+	TRACE_CPUPROFILER_EVENT_SCOPE(US_CharacterMovement::CalcVelocity);
+
+	++MovementCounters.CalcVelocityCalls;
+	FS_MovementCounterScope CounterScope(MovementCounters.CalcVelocitySeconds);
+
 	// Do not update velocity when using root motion or when SimulatedProxy and not simulating root motion - SimulatedProxy are repped their Velocity
 	if (!HasValidData() || HasAnimRootMotion() || DeltaTime < MIN_TICK_TIME || (CharacterOwner && CharacterOwner->GetLocalRole() == ROLE_SimulatedProxy && !bWasSimulatingRootMotion))
 	{
@@ -909,100 +1355,417 @@ void US_CharacterMovement::CalcVelocity(float DeltaTime, float Friction, bool bF
 	MaxSpeed = FMath::Max(MaxSpeed * AnalogInputModifier, GetMinAnalogSpeed());
 #endif
 
-	// Apply braking or deceleration
-	const bool bZeroAcceleration = Acceleration.IsNearlyZero();
-	const bool bIsGroundMove = IsMovingOnGround() && bBrakingFrameTolerated;
+	FSourceMoveState State;
+	State.Velocity = Velocity;
+	State.Acceleration = Acceleration;
+	State.SurfaceFriction = SurfaceFriction;
+
+	FSourceMoveInput Input;
+	Input.DeltaTime = DeltaTime;
+	Input.Friction = Friction;
+	Input.BrakingFriction = bUseSeparateBrakingFriction ? BrakingFriction : Friction;
+	Input.BrakingDeceleration = BrakingDeceleration;
+	Input.MaxSpeed = MaxSpeed;
+	Input.bIsGroundMove = IsMovingOnGround() && bBrakingFrameTolerated;
+	Input.bFluid = bFluid;
+	Input.bCheatFlying = bCheatFlying;
+
+	if (!ConsumeBatchedVelocity(State, Input, State))
+	{
+		const int32 BrakingSubSteps = FSourceMoveKernel::CalcVelocity(State, Input, GetMoveSettings());
+		MovementCounters.BrakingSubSteps += BrakingSubSteps;
+		INC_DWORD_STAT_BY(STAT_CombaxBrakingSubSteps, BrakingSubSteps);
+	}
+
+	Velocity = State.Velocity;
+	Acceleration = State.Acceleration;
 
-	// Apply friction
-	if (bIsGroundMove)
+	// Dynamic step height code for allowing sliding on a slope when at a high speed
+	if (MovementLOD == ES_MovementLOD::Full)
 	{
-		const bool bVelocityOverMax = IsExceedingMaxSpeed(MaxSpeed);
-		const FVector OldVelocity = Velocity;
+		UpdateStepLimits();
+	}
 
-		const float ActualBrakingFriction = (bUseSeparateBrakingFriction ? BrakingFriction : Friction) * SurfaceFriction;
-		ApplyVelocityBraking(DeltaTime, ActualBrakingFriction, BrakingDeceleration);
+	// Players don't use RVO avoidance
+#if 0
+	if (bUseRVOAvoidance)
+	{
+		CalcAvoidanceVelocity(DeltaTime);
+	}
+#endif
+}
 
-		// Don't allow braking to lower us below max speed if we started above it.
-		if (bVelocityOverMax && Velocity.SizeSquared() < FMath::Square(MaxSpeed) && FVector::DotProduct(Acceleration, OldVelocity) > 0.0f)
-		{
-			Velocity = OldVelocity.GetSafeNormal() * MaxSpeed;
-		}
+void US_CharacterMovement::StartRecording()
+{
+	if (!HasValidData())
+	{
+		return;
 	}
 
-	// Apply fluid friction
-	if (bFluid)
+	FS_MovementRecordingHeader Header;
+	Header.bAutoBunnyhop = S_Character && S_Character->GetAutoBunnyhop();
+	Header.MovementMode = MovementMode;
+	Header.StartLocation = UpdatedComponent->GetComponentLocation();
+	Header.StartVelocity = FVector3f(Velocity);
+	Header.StartYaw = CharacterOwner->GetActorRotation().Yaw;
+
+	MovementRecorder = MakeUnique<FS_MovementRecorder>(UWorld::RemovePIEPrefix(GetWorld()->GetOutermost()->GetName()), Header);
+}
+
+bool US_CharacterMovement::StopRecording(const FString &Filename)
+{
+	if (!MovementRecorder)
 	{
-		Velocity = Velocity * (1.0f - FMath::Min(Friction * DeltaTime, 1.0f));
+		return false;
 	}
 
-	// Limit before
-	Velocity.X = FMath::Clamp(Velocity.X, -AxisSpeedLimit, AxisSpeedLimit);
-	Velocity.Y = FMath::Clamp(Velocity.Y, -AxisSpeedLimit, AxisSpeedLimit);
+	const bool bSaved = MovementRecorder->Save(Filename);
+	MovementRecorder.Reset();
+	return bSaved;
+}
 
-	// TODO no clip
-	if (bCheatFlying)
+FSourceMoveSettings US_CharacterMovement::GetMoveSettings() const
+{
+	const FS_MovementProfileSettings &Profile = GetProfileSettings();
+
+	FSourceMoveSettings Settings;
+	Settings.GroundAccelerationMultiplier = Profile.GroundAccelerationMultiplier;
+	Settings.AirAccelerationMultiplier = Profile.AirAccelerationMultiplier;
+	Settings.AirSpeedCap = Profile.AirSpeedCap;
+	Settings.AxisSpeedLimit = Profile.AxisSpeedLimit;
+	Settings.BrakingFrictionFactor = BrakingFrictionFactor;
+	Settings.BrakingSubStepTime = BrakingSubStepTime;
+	Settings.bClosedFormBraking = bClosedFormBraking;
+	return Settings;
+}
+
+FSourceStepLimitSettings US_CharacterMovement::GetStepLimitSettings() const
+{
+	FSourceStepLimitSettings Settings;
+	Settings.DefaultStepHeight = DefaultStepHeight;
+	Settings.MinStepHeight = GetProfileSettings().MinStepHeight;
+	Settings.DefaultWalkableFloorZ = DefaultWalkableFloorZ;
+	Settings.SpeedMultMin = GetProfileSettings().SpeedMultMin;
+	Settings.SpeedMultMax = GetProfileSettings().SpeedMultMax;
+	return Settings;
+}
+
+void US_CharacterMovement::ApplyMovementSettings(const FS_MovementProfileSettings &Settings)
+{
+	MaxAcceleration = Settings.MaxAcceleration;
+	MaxWalkSpeed = Settings.RunSpeed;
+
+	GroundFriction = Settings.GroundFriction;
+	BrakingFriction = Settings.GroundFriction;
+	BrakingDecelerationWalking = Settings.BrakingDecelerationWalking;
+
+	JumpZVelocity = Settings.JumpZVelocity;
+	GravityScale = Settings.GravityZ / UPhysicsSettings::Get()->DefaultGravityZ;
+
+	MaxStepHeight = Settings.MaxStepHeight;
+	DefaultStepHeight = MaxStepHeight;
+	SetWalkableFloorZ(Settings.WalkableFloorZ);
+	DefaultWalkableFloorZ = GetWalkableFloorZ();
+}
+
+void US_CharacterMovement::SetMovementProfile(US_MovementProfile *Profile)
+{
+	if (MovementProfile && MovementProfileChangedHandle.IsValid())
 	{
+		MovementProfile->OnSettingsChanged.Remove(MovementProfileChangedHandle);
+		MovementProfileChangedHandle.Reset();
 	}
-	// walk move
-	else
+
+	//: The pawn's own profile wins over anything migrated from the old properties
+	MovementProfile = Profile ? Profile : MigratedProfile;
+	ApplyMovementSettings(GetProfileSettings());
+	if (Profile)
+	{
+		MovementProfileChangedHandle = Profile->OnSettingsChanged.AddUObject(this, &US_CharacterMovement::OnMovementProfileChanged);
+	}
+}
+
+void US_CharacterMovement::MigrateDeprecatedSettings()
+{
+	FS_MovementProfileSettings Settings = DefaultProfileSettings;
+	bool bMigrated = false;
+	const auto Migrate = [&bMigrated](auto &Field, auto Value)
 	{
-		// Apply input acceleration
-		if (!bZeroAcceleration)
+		if constexpr (std::is_floating_point_v<std::decay_t<decltype(Field)>>)
 		{
-			// Clamp acceleration to max speed
-			Acceleration = Acceleration.GetClampedToMaxSize2D(MaxSpeed);
-			// Find veer
-			const FVector AccelDir = Acceleration.GetSafeNormal2D();
-			const float Veer = Velocity.X * AccelDir.X + Velocity.Y * AccelDir.Y;
-			// Get add speed with air speed cap
-			const float AddSpeed = (bIsGroundMove ? Acceleration : Acceleration.GetClampedToMaxSize2D(AirSpeedCap)).Size2D() - Veer;
-			if (AddSpeed > 0.0f)
-			{
-				// Apply acceleration
-				const float AccelerationMultiplier = bIsGroundMove ? GroundAccelerationMultiplier : AirAccelerationMultiplier;
-				FVector CurrentAcceleration = Acceleration * AccelerationMultiplier * SurfaceFriction * DeltaTime;
-				CurrentAcceleration = CurrentAcceleration.GetClampedToMaxSize2D(AddSpeed);
-				Velocity += CurrentAcceleration;
-			}
+			bMigrated |= !FMath::IsNearlyEqual(Field, static_cast<std::decay_t<decltype(Field)>>(Value), 1e-3f);
 		}
-
-		// No requested accel on player
-#if 0
-		// Apply additional requested acceleration
-		if (!bZeroRequestedAcceleration)
+		else
 		{
-			Velocity += RequestedAcceleration * DeltaTime;
+			bMigrated |= Field != Value;
 		}
-#endif
+		Field = Value;
+	};
+
+	Migrate(Settings.GroundAccelerationMultiplier, GroundAccelerationMultiplier_DEPRECATED);
+	Migrate(Settings.AirAccelerationMultiplier, AirAccelerationMultiplier_DEPRECATED);
+	Migrate(Settings.AirSpeedCap, AirSpeedCap_DEPRECATED);
+	Migrate(Settings.MinStepHeight, MinStepHeight_DEPRECATED);
+	Migrate(Settings.WalkSpeed, WalkSpeed_DEPRECATED);
+	Migrate(Settings.RunSpeed, RunSpeed_DEPRECATED);
+	Migrate(Settings.SprintSpeed, SprintSpeed_DEPRECATED);
+	Migrate(Settings.SpeedMultMin, SpeedMultMin_DEPRECATED);
+	Migrate(Settings.SpeedMultMax, SpeedMultMax_DEPRECATED);
+	Migrate(Settings.AxisSpeedLimit, AxisSpeedLimit_DEPRECATED);
+	Migrate(Settings.BounceMultiplier, BounceMultiplier_DEPRECATED);
+	Migrate(Settings.SlidePolicy, SlidePolicy_DEPRECATED);
+
+	//: The engine members ApplyMovementSettings overwrites could have been overridden too, and would be lost the same way
+	Migrate(Settings.MaxAcceleration, MaxAcceleration);
+	Migrate(Settings.GroundFriction, GroundFriction);
+	Migrate(Settings.BrakingDecelerationWalking, BrakingDecelerationWalking);
+	Migrate(Settings.JumpZVelocity, JumpZVelocity);
+	Migrate(Settings.GravityZ, GravityScale * UPhysicsSettings::Get()->DefaultGravityZ);
+	Migrate(Settings.MaxStepHeight, MaxStepHeight);
+	Migrate(Settings.WalkableFloorZ, GetWalkableFloorZ());
+
+	if (!bMigrated)
+	{
+		MigratedProfile = nullptr;
+		return;
 	}
 
-	// Limit after
-	Velocity.X = FMath::Clamp(Velocity.X, -AxisSpeedLimit, AxisSpeedLimit);
-	Velocity.Y = FMath::Clamp(Velocity.Y, -AxisSpeedLimit, AxisSpeedLimit);
+	//: Archetypes hand their pointer down to instances, which get their own
+	if (!MigratedProfile || MigratedProfile->GetOuter() != this)
+	{
+		MigratedProfile = NewObject<US_MovementProfile>(this, TEXT("MigratedMovementProfile"), RF_Transient);
+	}
+	MigratedProfile->Settings = Settings;
+}
 
-	const float SpeedSq = Velocity.SizeSquared2D();
+void US_CharacterMovement::OnMovementProfileChanged()
+{
+	if (MovementProfile)
+	{
+		ApplyMovementSettings(MovementProfile->Settings);
+	}
+}
 
-	// Dynamic step height code for allowing sliding on a slope when at a high speed
-	// Scale step/ramp height down the faster we go
-	float Speed = FMath::Sqrt(SpeedSq);
-	float SpeedScale = (Speed - SpeedMultMin) / (SpeedMultMax - SpeedMultMin);
-	float SpeedMultiplier = FMath::Clamp(SpeedScale, 0.0f, 1.0f);
-	SpeedMultiplier *= SpeedMultiplier;
+void US_CharacterMovement::UpdateStepLimits()
+{
+	const FSourceStepLimits Limits = FSourceMoveKernel::GetStepLimits(GetStepLimitSettings(), GetStepLimitMultiplier());
+	MaxStepHeight = Limits.StepHeight;
+
+	//: SetWalkableFloorZ works out the angle with an acos, skip it while the limit stays put, as it does below SpeedMultMin
+	if (Limits.WalkableFloorZ != GetWalkableFloorZ())
+	{
+		SetWalkableFloorZ(Limits.WalkableFloorZ);
+	}
+}
+
+float US_CharacterMovement::GetStepLimitMultiplier() const
+{
+	const FS_MovementProfileSettings &Settings = GetProfileSettings();
+	const float Speed2D = Velocity.Size2D();
+	if (!StepScaleCurve)
+	{
+		return FSourceMoveKernel::GetSlopeSpeedMultiplier(Speed2D, Settings.SpeedMultMin, Settings.SpeedMultMax, SurfaceFriction, IsFalling());
+	}
+
+	const float SpeedScale = FMath::Clamp((Speed2D - Settings.SpeedMultMin) / (Settings.SpeedMultMax - Settings.SpeedMultMin), 0.0f, 1.0f);
+	float SpeedMultiplier = FMath::Clamp(StepScaleCurve->GetFloatValue(SpeedScale), 0.0f, 1.0f);
 	if (!IsFalling())
 	{
-		// If we're on ground, factor in friction.
 		SpeedMultiplier = FMath::Max((1.0f - SurfaceFriction) * SpeedMultiplier, 0.0f);
 	}
-	MaxStepHeight = FMath::Lerp(DefaultStepHeight, MinStepHeight, SpeedMultiplier);
-	SetWalkableFloorZ(FMath::Lerp(DefaultWalkableFloorZ, 0.9848f, SpeedMultiplier));
+	return SpeedMultiplier;
+}
 
-	// Players don't use RVO avoidance
-#if 0
-	if (bUseRVOAvoidance)
+bool US_CharacterMovement::GatherBatchedMove(float DeltaTime, FSourceMoveState &OutState, FSourceMoveInput &OutInput)
+{
+	bHasBatchedVelocity = false;
+
+	//: Only movers that simulate locally with the frame's delta time: server bots, the listen server host and controller-less
+	//: pawns. A remote client's pawn moves in its ServerMove calls with the client's delta time, before anything here could run.
+	if (!HasValidData() || CharacterOwner->GetLocalRole() != ROLE_Authority || !IsSimulatingOwnMoves() || ShouldUseFixedTimestep())
 	{
-		CalcAvoidanceVelocity(DeltaTime);
+		return false;
 	}
-#endif
+	if (HasAnimRootMotion() || CurrentRootMotion.HasActiveRootMotionSources() || UpdatedComponent->IsSimulatingPhysics() || bForceMaxAccel || bCheatFlying)
+	{
+		return false;
+	}
+	if (DeltaTime < MIN_TICK_TIME || DeltaTime > MaxSimulationTimeStep)
+	{
+		return false;
+	}
+	const bool bFalling = IsFalling();
+	if (!bFalling && !IsMovingOnGround())
+	{
+		return false;
+	}
+
+	//: Mirror what ControlledCharacterMove is going to do with the pending input
+	const FVector InputAcceleration = ScaleInputAcceleration(ConstrainInputAcceleration(CharacterOwner->GetPendingMovementInputVector()));
+	const float MaxAccel = GetMaxAcceleration();
+	const float InputModifier = (InputAcceleration.SizeSquared() > 0.0f && MaxAccel > SMALL_NUMBER) ? FMath::Clamp(InputAcceleration.Size() / MaxAccel, 0.0f, 1.0f) : 0.0f;
+	const float Friction = FMath::Max(0.0f, bFalling ? FallingLateralFriction : GroundFriction);
+
+	//: Both PhysWalking and PhysFalling flatten velocity and acceleration before CalcVelocity
+	OutState.Velocity = FVector(Velocity.X, Velocity.Y, 0.0f);
+	OutState.Acceleration = FVector(InputAcceleration.X, InputAcceleration.Y, 0.0f);
+	OutState.SurfaceFriction = SurfaceFriction;
+
+	OutInput.DeltaTime = DeltaTime;
+	OutInput.Friction = Friction;
+	OutInput.BrakingFriction = bUseSeparateBrakingFriction ? BrakingFriction : Friction;
+	OutInput.BrakingDeceleration = GetMaxBrakingDeceleration();
+	OutInput.MaxSpeed = FMath::Max(GetMaxSpeed() * InputModifier, GetMinAnalogSpeed());
+	OutInput.bIsGroundMove = !bFalling && bBrakingFrameTolerated;
+	OutInput.bFluid = false;
+	OutInput.bCheatFlying = false;
+
+	BatchedInState = OutState;
+	BatchedInput = OutInput;
+	return true;
+}
+
+void US_CharacterMovement::SetBatchedVelocity(const FSourceMoveState &State)
+{
+	BatchedOutState = State;
+	bHasBatchedVelocity = true;
+}
+
+bool US_CharacterMovement::GetFallClearanceQuery(float DeltaTime, FBox &OutBox) const
+{
+	if (!HasValidData() || !IsFalling() || UpdatedComponent->IsSimulatingPhysics() || !IsSimulatingOwnMoves())
+	{
+		return false;
+	}
+
+	float Radius, HalfHeight;
+	CharacterOwner->GetCapsuleComponent()->GetScaledCapsuleSize(Radius, HalfHeight);
+	const FVector Extent(Radius, Radius, HalfHeight);
+
+	//: Ballistic guess at the frame's move, with room for air acceleration and frame time jitter
+	const FVector Start = UpdatedComponent->GetComponentLocation();
+	const FVector Delta = Velocity * DeltaTime + FVector(0.0f, 0.0f, 0.5f * GetGravityZ() * DeltaTime * DeltaTime);
+	const float Slack = Delta.Size() * 0.25f + GetProfileSettings().AirSpeedCap * DeltaTime + 2.0f;
+
+	OutBox = FBox(Start - Extent, Start + Extent) + FBox(Start + Delta - Extent, Start + Delta + Extent);
+	OutBox = OutBox.ExpandBy(Slack);
+	return true;
+}
+
+void US_CharacterMovement::SetClearFallBox(const FBox &Box)
+{
+	ClearFallBox = Box;
+	bHasClearFallBox = true;
+}
+
+bool US_CharacterMovement::IsFallClear(const FVector &Start, const FVector &Delta) const
+{
+	if (!bHasClearFallBox)
+	{
+		return false;
+	}
+
+	//: The swept capsule stays within the bounds of its two ends, plus a margin for the sweep's own inflation
+	float Radius, HalfHeight;
+	CharacterOwner->GetCapsuleComponent()->GetScaledCapsuleSize(Radius, HalfHeight);
+	const FVector Extent(Radius + 1.0f, Radius + 1.0f, HalfHeight + 1.0f);
+	const FBox Swept = FBox(Start - Extent, Start + Extent) + FBox(Start + Delta - Extent, Start + Delta + Extent);
+	if (!ClearFallBox.IsInside(Swept))
+	{
+		return false;
+	}
+
+	++MovementCounters.FallSweepsSkipped;
+	INC_DWORD_STAT(STAT_CombaxFallSweepsSkipped);
+	return true;
+}
+
+ES_MovementLOD US_CharacterMovement::ComputeMovementLOD(const FVector &ViewLocation) const
+{
+	if (!HasValidData() || CharacterOwner->GetLocalRole() != ROLE_SimulatedProxy)
+	{
+		return ES_MovementLOD::Full;
+	}
+
+	const float DistanceSquared = FVector::DistSquared(ViewLocation, UpdatedComponent->GetComponentLocation());
+	int32 LOD = DistanceSquared < FMath::Square(ReducedLODDistance) ? 0 : DistanceSquared < FMath::Square(MinimalLODDistance) ? 1 : 2;
+	if (!CharacterOwner->WasRecentlyRendered(OffscreenLODDelay))
+	{
+		LOD = FMath::Min(LOD + 1, 2);
+	}
+	return static_cast<ES_MovementLOD>(LOD);
+}
+
+void US_CharacterMovement::SetMovementLOD(ES_MovementLOD LOD)
+{
+	if (LOD == MovementLOD)
+	{
+		return;
+	}
+	MovementLOD = LOD;
+	MovementLODPendingTime = 0.0f;
+}
+
+float US_CharacterMovement::GetMovementLODInterval() const
+{
+	switch (MovementLOD)
+	{
+	case ES_MovementLOD::Reduced:
+		return 1.0f / FMath::Max(ReducedLODTickRate, 1.0f);
+	case ES_MovementLOD::Minimal:
+		return 1.0f / FMath::Max(MinimalLODTickRate, 1.0f);
+	default:
+		return 0.0f;
+	}
+}
+
+void US_CharacterMovement::SimulateMovement(float DeltaTime)
+{
+	//: Linear smoothing keys off server timestamps, only exponential smoothing can take our own steps as corrections
+	const float Interval = GetMovementLODInterval();
+	if (Interval <= 0.0f || NetworkSmoothingMode != ENetworkSmoothingMode::Exponential || !HasValidData())
+	{
+		MovementLODPendingTime = 0.0f;
+		Super::SimulateMovement(DeltaTime);
+		return;
+	}
+
+	//: The component still ticks every frame so smoothing keeps drawing the mesh, only the simulation waits
+	MovementLODPendingTime += DeltaTime;
+	if (MovementLODPendingTime < Interval)
+	{
+		return;
+	}
+
+	const FVector OldLocation = UpdatedComponent->GetComponentLocation();
+	const FQuat OldRotation = UpdatedComponent->GetComponentQuat();
+	Super::SimulateMovement(MovementLODPendingTime);
+	MovementLODPendingTime = 0.0f;
+
+	//: Hand the capsule's jump to smoothing the way a server update is, so the mesh glides after it instead of snapping
+	SmoothCorrection(OldLocation, OldRotation, UpdatedComponent->GetComponentLocation(), UpdatedComponent->GetComponentQuat());
+}
+
+bool US_CharacterMovement::ConsumeBatchedVelocity(const FSourceMoveState &State, const FSourceMoveInput &Input, FSourceMoveState &OutState)
+{
+	if (!bHasBatchedVelocity)
+	{
+		return false;
+	}
+
+	//: One shot, and only if nothing changed between gathering and simulating (jumps, landings, new input...)
+	bHasBatchedVelocity = false;
+	if (!(State == BatchedInState) || !(Input == BatchedInput))
+	{
+		++MovementCounters.BatchedVelocityMisses;
+		INC_DWORD_STAT(STAT_CombaxBatchedVelocityMisses);
+		return false;
+	}
+
+	++MovementCounters.BatchedVelocityHits;
+	INC_DWORD_STAT(STAT_CombaxBatchedVelocityHits);
+	OutState = BatchedOutState;
+	return true;
 }
 
 bool US_CharacterMovement::CanAttemptJump() const
@@ -1019,23 +1782,260 @@ bool US_CharacterMovement::CanAttemptJump() const
 
 float US_CharacterMovement::GetMaxSpeed() const
 {
+	const FS_MovementProfileSettings &Settings = GetProfileSettings();
 	if (bCheatFlying)
 	{
-		return (S_Character->IsSprinting() ? SprintSpeed : WalkSpeed) * 1.5f;
+		return (S_Character->IsSprinting() ? Settings.SprintSpeed : Settings.WalkSpeed) * 1.5f;
 	}
 	float Speed;
 	if (S_Character->IsSprinting())
 	{
-		Speed = SprintSpeed;
+		Speed = Settings.SprintSpeed;
 	}
 	else if (S_Character->DoesWantToWalk())
 	{
-		Speed = WalkSpeed;
+		Speed = Settings.WalkSpeed;
 	}
 	else
 	{
-		Speed = RunSpeed;
+		Speed = Settings.RunSpeed;
 	}
 
 	return Speed;
 }
+
+//~ ==== Client prediction ================================================================================== ~//
+
+void FSavedMove_S_Character::Clear()
+{
+	Super::Clear();
+
+	bSavedSprinting = false;
+	bSavedWantsToWalk = false;
+	bSavedAutoBunnyhop = false;
+}
+
+uint8 FSavedMove_S_Character::GetCompressedFlags() const
+{
+	uint8 Result = Super::GetCompressedFlags();
+
+	if (bSavedSprinting)
+	{
+		Result |= FLAG_Sprinting;
+	}
+	if (bSavedWantsToWalk)
+	{
+		Result |= FLAG_WantsToWalk;
+	}
+	if (bSavedAutoBunnyhop)
+	{
+		Result |= FLAG_AutoBunnyhop;
+	}
+	return Result;
+}
+
+bool FSavedMove_S_Character::CanCombineWith(const FSavedMovePtr &NewMove, ACharacter *InCharacter, float MaxDelta) const
+{
+	const FSavedMove_S_Character *NewSourceMove = static_cast<const FSavedMove_S_Character *>(NewMove.Get());
+	if (bSavedSprinting != NewSourceMove->bSavedSprinting || bSavedWantsToWalk != NewSourceMove->bSavedWantsToWalk || bSavedAutoBunnyhop != NewSourceMove->bSavedAutoBunnyhop)
+	{
+		return false;
+	}
+	return Super::CanCombineWith(NewMove, InCharacter, MaxDelta);
+}
+
+void FSavedMove_S_Character::SetMoveFor(ACharacter *C, float InDeltaTime, FVector const &NewAccel, FNetworkPredictionData_Client_Character &ClientData)
+{
+	Super::SetMoveFor(C, InDeltaTime, NewAccel, ClientData);
+
+	if (const AS_Character *Character = Cast<AS_Character>(C))
+	{
+		bSavedSprinting = Character->IsSprinting();
+		bSavedWantsToWalk = Character->DoesWantToWalk();
+		bSavedAutoBunnyhop = Character->GetAutoBunnyhop();
+	}
+}
+
+void FSavedMove_S_Character::PrepMoveFor(ACharacter *C)
+{
+	Super::PrepMoveFor(C);
+
+	if (AS_Character *Character = Cast<AS_Character>(C))
+	{
+		Character->SetSprinting(bSavedSprinting);
+		Character->SetWantsToWalk(bSavedWantsToWalk);
+		Character->SetAutoBunnyhop(bSavedAutoBunnyhop);
+	}
+}
+
+FNetworkPredictionData_Client_S_Character::FNetworkPredictionData_Client_S_Character(const UCharacterMovementComponent &ClientMovement)
+	: Super(ClientMovement)
+{
+}
+
+FSavedMovePtr FNetworkPredictionData_Client_S_Character::AllocateNewMove()
+{
+	return FSavedMovePtr(new FSavedMove_S_Character());
+}
+
+FNetworkPredictionData_Client *US_CharacterMovement::GetPredictionData_Client() const
+{
+	if (ClientPredictionData == nullptr)
+	{
+		US_CharacterMovement *MutableThis = const_cast<US_CharacterMovement *>(this);
+		MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_S_Character(*this);
+	}
+	return ClientPredictionData;
+}
+
+void US_CharacterMovement::UpdateFromCompressedFlags(uint8 Flags)
+{
+	Super::UpdateFromCompressedFlags(Flags);
+
+	if (S_Character)
+	{
+		S_Character->SetSprinting((Flags & FSavedMove_S_Character::FLAG_Sprinting) != 0);
+		S_Character->SetWantsToWalk((Flags & FSavedMove_S_Character::FLAG_WantsToWalk) != 0);
+		S_Character->SetAutoBunnyhop((Flags & FSavedMove_S_Character::FLAG_AutoBunnyhop) != 0);
+	}
+}
+
+float US_CharacterMovement::GetClientNetSendDeltaTime(const APlayerController *PC, const FNetworkPredictionData_Client_Character *ClientData, const FSavedMovePtr &NewMove) const
+{
+	float NetMoveDelta = Super::GetClientNetSendDeltaTime(PC, ClientData, NewMove);
+
+	//: Nothing the server doesn't already know about, hold the move longer so the following identical ones combine into it
+	if (IdenticalMoveSendDeltaScale > 1.0f && ClientData && NewMove.IsValid() && ClientData->LastAckedMove.IsValid() && !NewMove->IsImportantMove(ClientData->LastAckedMove))
+	{
+		NetMoveDelta = FMath::Min(NetMoveDelta * IdenticalMoveSendDeltaScale, ClientData->MaxMoveDeltaTime * 0.5f);
+	}
+	return NetMoveDelta;
+}
+
+void US_CharacterMovement::ServerSendMoveResponse(const FClientAdjustment &PendingAdjustment)
+{
+	++MovementCounters.ServerMoveResponses;
+	if (!PendingAdjustment.bAckGoodMove)
+	{
+		++MovementCounters.Corrections;
+		++MovementCounters.CorrectionsBySource[static_cast<int32>(PendingCorrectionSource)];
+		INC_DWORD_STAT(STAT_CombaxCorrections);
+	}
+
+	Super::ServerSendMoveResponse(PendingAdjustment);
+}
+
+void US_CharacterMovement::ServerMove_PerformMovement(const FCharacterNetworkMoveData &MoveData)
+{
+	//: Whatever this move runs through is what a correction it causes gets put down to
+	MoveDivergenceSource = ES_CorrectionSource::Other;
+	bAcceptClientPosition = false;
+
+	Super::ServerMove_PerformMovement(MoveData);
+}
+
+bool US_CharacterMovement::ServerExceedsAllowablePositionError(float ClientTimeStamp, float DeltaTime, const FVector &Accel, const FVector &ClientWorldLocation, const FVector &RelativeClientLocation,
+															   UPrimitiveComponent *ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode)
+{
+	bAcceptClientPosition = false;
+	if (!Super::ServerExceedsAllowablePositionError(ClientTimeStamp, DeltaTime, Accel, ClientWorldLocation, RelativeClientLocation, ClientMovementBase, ClientBaseBoneName, ClientMovementMode))
+	{
+		return false;
+	}
+
+	//: Disagreeing on the movement mode can't be smoothed over
+	if (PackNetworkMovementMode() != ClientMovementMode)
+	{
+		PendingCorrectionSource = ES_CorrectionSource::ModeMismatch;
+		return true;
+	}
+	PendingCorrectionSource = MoveDivergenceSource;
+	if (CVarCorrectionBudget.GetValueOnGameThread() == 0)
+	{
+		return true;
+	}
+
+	//: Slope boosting and catching air turn float differences into errors that grow with speed, let those through and take
+	//: the client's position, but only if the capsule could have got there from ours without going through anything
+	const FVector ServerLocation = UpdatedComponent->GetComponentLocation();
+	const float Error = FVector::Dist(ServerLocation, ClientWorldLocation);
+	if (Error <= FMath::Min(Velocity.Size() * ClientErrorPerSpeed, MaxClientErrorTolerance) && IsClientPositionReachable(ServerLocation, ClientWorldLocation))
+	{
+		++MovementCounters.ClientPositionsAccepted;
+		bAcceptClientPosition = true;
+		return false;
+	}
+
+	//: Out of budget, hold the correction back for as long as the error stays small enough. The server keeps its own
+	//: position, the next move with budget left corrects the client to it
+	const double Now = GetWorld()->GetTimeSeconds();
+	CorrectionTokens = FMath::Min(CorrectionBurst, CorrectionTokens + float(Now - LastCorrectionTokenTime) * CorrectionsPerSecond);
+	LastCorrectionTokenTime = Now;
+	if (CorrectionTokens < 1.0f && Error <= MaxDeferredCorrectionError)
+	{
+		++MovementCounters.CorrectionsDeferred;
+		INC_DWORD_STAT(STAT_CombaxCorrectionsDeferred);
+		return false;
+	}
+	CorrectionTokens = FMath::Max(CorrectionTokens - 1.0f, 0.0f);
+	return true;
+}
+
+bool US_CharacterMovement::IsClientPositionReachable(const FVector &ServerLocation, const FVector &ClientLocation) const
+{
+	++MovementCounters.Sweeps;
+	INC_DWORD_STAT(STAT_CombaxMovementSweeps);
+
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(ClientPositionSweep), false, CharacterOwner);
+	FCollisionResponseParams ResponseParams;
+	InitCollisionParams(Params, ResponseParams);
+
+	//: Shrunk a little so resting on the floor or against a wall doesn't count as blocked
+	const FCollisionShape Shape = GetPawnCapsuleCollisionShape(SHRINK_AllCustom, ClientPositionSweepInset);
+	return !GetWorld()->SweepTestByChannel(ServerLocation, ClientLocation, UpdatedComponent->GetComponentQuat(), UpdatedComponent->GetCollisionObjectType(), Shape, Params, ResponseParams);
+}
+
+bool US_CharacterMovement::ServerShouldUseAuthoritativePosition(float ClientTimeStamp, float DeltaTime, const FVector &Accel, const FVector &ClientWorldLocation, const FVector &RelativeClientLocation,
+																UPrimitiveComponent *ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode)
+{
+	return bAcceptClientPosition ||
+		   Super::ServerShouldUseAuthoritativePosition(ClientTimeStamp, DeltaTime, Accel, ClientWorldLocation, RelativeClientLocation, ClientMovementBase, ClientBaseBoneName, ClientMovementMode);
+}
+
+bool US_CharacterMovement::ClientUpdatePositionAfterServerUpdate()
+{
+	const FNetworkPredictionData_Client_Character *ClientData = bUpdatePosition ? GetPredictionData_Client_Character() : nullptr;
+	if (ClientData)
+	{
+		++MovementCounters.Replays;
+		MovementCounters.ReplayedMoves += ClientData->SavedMoves.Num();
+		INC_DWORD_STAT_BY(STAT_CombaxReplayedMoves, ClientData->SavedMoves.Num());
+	}
+
+	return Super::ClientUpdatePositionAfterServerUpdate();
+}
+
+void US_CharacterMovement::OnMovementUpdated(float DeltaSeconds, const FVector &OldLocation, const FVector &OldVelocity)
+{
+	Super::OnMovementUpdated(DeltaSeconds, OldLocation, OldVelocity);
+
+	//: Same precision as FVector_NetQuantize10, applied identically on the client, its replays and the server
+	if (ShouldQuantizeMoveVelocity())
+	{
+		Velocity.X = FMath::RoundToFloat(Velocity.X * 10.0f) / 10.0f;
+		Velocity.Y = FMath::RoundToFloat(Velocity.Y * 10.0f) / 10.0f;
+		Velocity.Z = FMath::RoundToFloat(Velocity.Z * 10.0f) / 10.0f;
+	}
+}
+
+bool US_CharacterMovement::ShouldQuantizeMoveVelocity() const
+{
+	if (!bQuantizeMoveVelocity || !CharacterOwner)
+	{
+		return false;
+	}
+
+	//: Standalone, listen server hosts and AI never exchange moves, nothing to line up with
+	const ENetRole Role = CharacterOwner->GetLocalRole();
+	return Role == ROLE_AutonomousProxy || (Role == ROLE_Authority && CharacterOwner->GetRemoteRole() == ROLE_AutonomousProxy);
+}
@@ -1,9 +1,21 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "Player/S_GameMode.h"
+#include "Player/S_BotController.h"
+#include "Kismet/GameplayStatics.h"
 #include "UObject/ConstructorHelpers.h"
 
 AS_GameMode::AS_GameMode()
 	: Super()
 {
+	BotControllerClass = AS_BotController::StaticClass();
+}
+
+APlayerController *AS_GameMode::SpawnPlayerController(ENetRole InRemoteRole, const FString &Options)
+{
+	if (BotControllerClass && UGameplayStatics::HasOption(Options, TEXT("Bot")))
+	{
+		return SpawnPlayerControllerCommon(InRemoteRole, FVector::ZeroVector, FRotator::ZeroRotator, BotControllerClass);
+	}
+	return Super::SpawnPlayerController(InRemoteRole, Options);
 }
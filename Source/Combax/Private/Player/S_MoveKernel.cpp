@@ -0,0 +1,513 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Player/S_MoveKernel.h"
+#include "Math/VectorRegister.h"
+
+namespace SourceMoveSimd
+{
+	using VReg = VectorRegister4Float;
+
+	constexpr int32 Width = 4;
+
+	FORCEINLINE VReg Splat(float Value)
+	{
+		return VectorSetFloat1(Value);
+	}
+
+	FORCEINLINE VReg Select(const VReg &Mask, const VReg &A, const VReg &B)
+	{
+		return VectorSelect(Mask, A, B);
+	}
+
+	FORCEINLINE VReg And(const VReg &A, const VReg &B)
+	{
+		return VectorBitwiseAnd(A, B);
+	}
+
+	FORCEINLINE VReg Or(const VReg &A, const VReg &B)
+	{
+		return VectorBitwiseOr(A, B);
+	}
+
+	FORCEINLINE VReg Dot2(const VReg &AX, const VReg &AY, const VReg &BX, const VReg &BY)
+	{
+		return VectorMultiplyAdd(AX, BX, VectorMultiply(AY, BY));
+	}
+
+	FORCEINLINE VReg Dot3(const VReg &AX, const VReg &AY, const VReg &AZ, const VReg &BX, const VReg &BY, const VReg &BZ)
+	{
+		return VectorMultiplyAdd(AX, BX, VectorMultiplyAdd(AY, BY, VectorMultiply(AZ, BZ)));
+	}
+
+	//? Reciprocal square root, zero for lanes that are not strictly positive
+	FORCEINLINE VReg SafeInvSqrt(const VReg &Value)
+	{
+		const VReg Zero = VectorZeroFloat();
+		return Select(VectorCompareGT(Value, Zero), VectorReciprocalSqrtAccurate(Value), Zero);
+	}
+
+	FORCEINLINE VReg SafeSqrt(const VReg &Value)
+	{
+		return VectorMultiply(Value, SafeInvSqrt(Value));
+	}
+
+	FORCEINLINE VReg ClampAxis(const VReg &Value, float Limit)
+	{
+		return VectorMin(VectorMax(Value, Splat(-Limit)), Splat(Limit));
+	}
+
+	//? All lanes of a group can take the vector path unless they need fluid friction or noclip
+	FORCEINLINE bool CanVectorize(const FSourceMoveBatch &Batch, int32 Index)
+	{
+		constexpr uint8 ScalarOnlyFlags = FSourceMoveBatch::Flag_Fluid | FSourceMoveBatch::Flag_CheatFlying;
+		return ((Batch.Flags[Index] | Batch.Flags[Index + 1] | Batch.Flags[Index + 2] | Batch.Flags[Index + 3]) & ScalarOnlyFlags) == 0;
+	}
+
+	//~ Lane-for-lane equivalent of FSourceMoveKernel::CalcVelocity for walking and falling movers
+	void AdvanceLanes(FSourceMoveBatch &Batch, int32 Index, float DeltaTime, const FSourceMoveSettings &Settings)
+	{
+		const VReg Zero = VectorZeroFloat();
+
+		VReg VelX = VectorLoad(&Batch.VelocityX[Index]);
+		VReg VelY = VectorLoad(&Batch.VelocityY[Index]);
+		VReg VelZ = VectorLoad(&Batch.VelocityZ[Index]);
+		VReg AccX = VectorLoad(&Batch.AccelerationX[Index]);
+		VReg AccY = VectorLoad(&Batch.AccelerationY[Index]);
+		const VReg AccZ = VectorLoad(&Batch.AccelerationZ[Index]);
+		const VReg SurfaceFriction = VectorLoad(&Batch.SurfaceFriction[Index]);
+		const VReg MaxSpeed = VectorLoad(&Batch.MaxSpeed[Index]);
+
+		float GroundLanes[Width];
+		for (int32 Lane = 0; Lane < Width; ++Lane)
+		{
+			GroundLanes[Lane] = (Batch.Flags[Index + Lane] & FSourceMoveBatch::Flag_GroundMove) ? 1.0f : 0.0f;
+		}
+		const VReg bGround = VectorCompareGT(VectorLoad(GroundLanes), Zero);
+
+		//: Friction, only for ground lanes
+		const VReg OldX = VelX;
+		const VReg OldY = VelY;
+		const VReg OldZ = VelZ;
+		const VReg OldSpeedSq = Dot3(VelX, VelY, VelZ, VelX, VelY, VelZ);
+		const VReg ClampedMaxSpeed = VectorMax(MaxSpeed, Zero);
+		const VReg bVelocityOverMax = VectorCompareGT(OldSpeedSq, VectorMultiply(VectorMultiply(ClampedMaxSpeed, ClampedMaxSpeed), Splat(1.01f)));
+
+		const VReg Friction = VectorMax(Zero, VectorMultiply(VectorMultiply(VectorLoad(&Batch.BrakingFriction[Index]), SurfaceFriction), Splat(FMath::Max(0.0f, Settings.BrakingFrictionFactor))));
+		const VReg BrakingDeceleration = VectorMax(VectorMax(VectorLoad(&Batch.BrakingDeceleration[Index]), SafeSqrt(Dot2(VelX, VelY, VelX, VelY))), Zero);
+		const VReg bMoving = Or(Or(VectorCompareGT(VectorAbs(VelX), Splat(0.1f)), VectorCompareGT(VectorAbs(VelY), Splat(0.1f))), VectorCompareGT(VectorAbs(VelZ), Splat(0.1f)));
+		const VReg bBraking = And(And(bGround, bMoving), And(VectorCompareGT(Friction, Splat(SMALL_NUMBER)), VectorCompareGT(BrakingDeceleration, Zero)));
+
+		if (DeltaTime >= FSourceMoveKernel::MinTickTime && VectorMaskBits(bBraking))
+		{
+			//: Deceleration per second along the reversed starting velocity
+			const VReg Rate = VectorMultiply(VectorMultiply(Friction, BrakingDeceleration), SafeInvSqrt(OldSpeedSq));
+			const VReg RevX = VectorNegate(VectorMultiply(OldX, Rate));
+			const VReg RevY = VectorNegate(VectorMultiply(OldY, Rate));
+			const VReg RevZ = VectorNegate(VectorMultiply(OldZ, Rate));
+
+			VReg bStopped = Zero;
+			if (Settings.bClosedFormBraking)
+			{
+				//: Constant deceleration along a fixed direction, so the whole frame is one scale of the starting velocity
+				const VReg Scale = VectorSubtract(VectorOneFloat(), VectorMultiply(Rate, Splat(DeltaTime)));
+				bStopped = And(bBraking, VectorCompareLE(Scale, Zero));
+				VelX = Select(bBraking, VectorMultiply(OldX, Scale), VelX);
+				VelY = Select(bBraking, VectorMultiply(OldY, Scale), VelY);
+				VelZ = Select(bBraking, VectorMultiply(OldZ, Scale), VelZ);
+			}
+			else
+			{
+				//: The substep sequence only depends on the delta time, so every lane walks the same one
+				float RemainingTime = DeltaTime;
+				const float MaxTimeStep = FMath::Clamp(Settings.BrakingSubStepTime, 1.0f / 75.0f, 1.0f / 20.0f);
+				while (RemainingTime >= FSourceMoveKernel::MinTickTime)
+				{
+					const float Delta = (RemainingTime > MaxTimeStep ? FMath::Min(MaxTimeStep, RemainingTime * 0.5f) : RemainingTime);
+					RemainingTime -= Delta;
+
+					const VReg bLive = Select(bStopped, Zero, bBraking);
+					const VReg DeltaV = Splat(Delta);
+					VelX = VectorAdd(VelX, Select(bLive, VectorMultiply(RevX, DeltaV), Zero));
+					VelY = VectorAdd(VelY, Select(bLive, VectorMultiply(RevY, DeltaV), Zero));
+					VelZ = VectorAdd(VelZ, Select(bLive, VectorMultiply(RevZ, DeltaV), Zero));
+
+					// Don't reverse direction
+					bStopped = Or(bStopped, And(bLive, VectorCompareLE(Dot3(VelX, VelY, VelZ, OldX, OldY, OldZ), Zero)));
+				}
+			}
+
+			// Clamp to zero if stopped or nearly zero
+			const VReg bNearlyZero = And(And(VectorCompareLE(VectorAbs(VelX), Splat(KINDA_SMALL_NUMBER)), VectorCompareLE(VectorAbs(VelY), Splat(KINDA_SMALL_NUMBER))), VectorCompareLE(VectorAbs(VelZ), Splat(KINDA_SMALL_NUMBER)));
+			const VReg bZero = Or(bStopped, And(bBraking, bNearlyZero));
+			VelX = Select(bZero, Zero, VelX);
+			VelY = Select(bZero, Zero, VelY);
+			VelZ = Select(bZero, Zero, VelZ);
+		}
+
+		// Don't allow braking to lower us below max speed if we started above it.
+		const VReg bRestoreSpeed = And(And(bGround, bVelocityOverMax), And(VectorCompareLT(Dot3(VelX, VelY, VelZ, VelX, VelY, VelZ), VectorMultiply(MaxSpeed, MaxSpeed)), VectorCompareGT(Dot3(AccX, AccY, AccZ, OldX, OldY, OldZ), Zero)));
+		if (VectorMaskBits(bRestoreSpeed))
+		{
+			const VReg Scale = VectorMultiply(Select(VectorCompareGE(OldSpeedSq, Splat(SMALL_NUMBER)), VectorReciprocalSqrtAccurate(OldSpeedSq), Zero), MaxSpeed);
+			VelX = Select(bRestoreSpeed, VectorMultiply(OldX, Scale), VelX);
+			VelY = Select(bRestoreSpeed, VectorMultiply(OldY, Scale), VelY);
+			VelZ = Select(bRestoreSpeed, VectorMultiply(OldZ, Scale), VelZ);
+		}
+
+		// Limit before
+		VelX = ClampAxis(VelX, Settings.AxisSpeedLimit);
+		VelY = ClampAxis(VelY, Settings.AxisSpeedLimit);
+
+		// Apply input acceleration
+		const VReg bHasAcceleration = Or(Or(VectorCompareGT(VectorAbs(AccX), Splat(KINDA_SMALL_NUMBER)), VectorCompareGT(VectorAbs(AccY), Splat(KINDA_SMALL_NUMBER))), VectorCompareGT(VectorAbs(AccZ), Splat(KINDA_SMALL_NUMBER)));
+		if (VectorMaskBits(bHasAcceleration))
+		{
+			// Clamp acceleration to max speed
+			const VReg InAccelSq2D = Dot2(AccX, AccY, AccX, AccY);
+			const VReg bAccelOverMax = VectorCompareGT(InAccelSq2D, VectorMultiply(MaxSpeed, MaxSpeed));
+			const VReg bMaxSpeedTiny = VectorCompareLT(MaxSpeed, Splat(KINDA_SMALL_NUMBER));
+			const VReg AccelScale = Select(bMaxSpeedTiny, Zero, Select(bAccelOverMax, VectorMultiply(MaxSpeed, SafeInvSqrt(InAccelSq2D)), VectorOneFloat()));
+			const VReg ClampedX = VectorMultiply(AccX, AccelScale);
+			const VReg ClampedY = VectorMultiply(AccY, AccelScale);
+
+			// Find veer
+			const VReg AccelSq2D = Dot2(ClampedX, ClampedY, ClampedX, ClampedY);
+			const VReg InvAccelSize2D = Select(VectorCompareGE(AccelSq2D, Splat(SMALL_NUMBER)), VectorReciprocalSqrtAccurate(AccelSq2D), Zero);
+			const VReg Veer = VectorMultiply(Dot2(VelX, VelY, ClampedX, ClampedY), InvAccelSize2D);
+
+			// Get add speed with air speed cap
+			const VReg AccelSize2D = SafeSqrt(AccelSq2D);
+			const VReg AirWishSpeed = Settings.AirSpeedCap < KINDA_SMALL_NUMBER ? Zero : VectorMin(AccelSize2D, Splat(Settings.AirSpeedCap));
+			const VReg AddSpeed = VectorSubtract(Select(bGround, AccelSize2D, AirWishSpeed), Veer);
+			const VReg bAdd = And(bHasAcceleration, VectorCompareGT(AddSpeed, Zero));
+
+			// Apply acceleration
+			const VReg Multiplier = Select(bGround, Splat(Settings.GroundAccelerationMultiplier), Splat(Settings.AirAccelerationMultiplier));
+			const VReg Factor = VectorMultiply(VectorMultiply(Multiplier, SurfaceFriction), Splat(DeltaTime));
+			VReg CurrentX = VectorMultiply(ClampedX, Factor);
+			VReg CurrentY = VectorMultiply(ClampedY, Factor);
+			const VReg CurrentZ = VectorMultiply(AccZ, Factor);
+			const VReg CurrentSq2D = Dot2(CurrentX, CurrentY, CurrentX, CurrentY);
+			const VReg bCurrentOverAdd = VectorCompareGT(CurrentSq2D, VectorMultiply(AddSpeed, AddSpeed));
+			const VReg bAddTiny = VectorCompareLT(AddSpeed, Splat(KINDA_SMALL_NUMBER));
+			const VReg CurrentScale = Select(bAddTiny, Zero, Select(bCurrentOverAdd, VectorMultiply(AddSpeed, SafeInvSqrt(CurrentSq2D)), VectorOneFloat()));
+			CurrentX = VectorMultiply(CurrentX, CurrentScale);
+			CurrentY = VectorMultiply(CurrentY, CurrentScale);
+
+			VelX = VectorAdd(VelX, Select(bAdd, CurrentX, Zero));
+			VelY = VectorAdd(VelY, Select(bAdd, CurrentY, Zero));
+			VelZ = VectorAdd(VelZ, Select(bAdd, CurrentZ, Zero));
+			AccX = Select(bHasAcceleration, ClampedX, AccX);
+			AccY = Select(bHasAcceleration, ClampedY, AccY);
+		}
+
+		// Limit after
+		VelX = ClampAxis(VelX, Settings.AxisSpeedLimit);
+		VelY = ClampAxis(VelY, Settings.AxisSpeedLimit);
+
+		VectorStore(VelX, &Batch.VelocityX[Index]);
+		VectorStore(VelY, &Batch.VelocityY[Index]);
+		VectorStore(VelZ, &Batch.VelocityZ[Index]);
+		VectorStore(AccX, &Batch.AccelerationX[Index]);
+		VectorStore(AccY, &Batch.AccelerationY[Index]);
+	}
+}
+
+//~ ==== Batch ============================================================================================== ~//
+
+void FSourceMoveBatch::SetNum(int32 NewNum)
+{
+	VelocityX.SetNumUninitialized(NewNum, false);
+	VelocityY.SetNumUninitialized(NewNum, false);
+	VelocityZ.SetNumUninitialized(NewNum, false);
+	AccelerationX.SetNumUninitialized(NewNum, false);
+	AccelerationY.SetNumUninitialized(NewNum, false);
+	AccelerationZ.SetNumUninitialized(NewNum, false);
+	SurfaceFriction.SetNumUninitialized(NewNum, false);
+	Friction.SetNumUninitialized(NewNum, false);
+	BrakingFriction.SetNumUninitialized(NewNum, false);
+	BrakingDeceleration.SetNumUninitialized(NewNum, false);
+	MaxSpeed.SetNumUninitialized(NewNum, false);
+	Flags.SetNumUninitialized(NewNum, false);
+}
+
+void FSourceMoveBatch::Reset()
+{
+	//: Keep the allocations around, batches are refilled every frame
+	VelocityX.Reset();
+	VelocityY.Reset();
+	VelocityZ.Reset();
+	AccelerationX.Reset();
+	AccelerationY.Reset();
+	AccelerationZ.Reset();
+	SurfaceFriction.Reset();
+	Friction.Reset();
+	BrakingFriction.Reset();
+	BrakingDeceleration.Reset();
+	MaxSpeed.Reset();
+	Flags.Reset();
+}
+
+int32 FSourceMoveBatch::Add(const FSourceMoveState &State, const FSourceMoveInput &Input)
+{
+	const int32 Index = Num();
+	SetNum(Index + 1);
+	SetState(Index, State);
+	Friction[Index] = Input.Friction;
+	BrakingFriction[Index] = Input.BrakingFriction;
+	BrakingDeceleration[Index] = Input.BrakingDeceleration;
+	MaxSpeed[Index] = Input.MaxSpeed;
+	Flags[Index] = (Input.bIsGroundMove ? Flag_GroundMove : 0) | (Input.bFluid ? Flag_Fluid : 0) | (Input.bCheatFlying ? Flag_CheatFlying : 0);
+	return Index;
+}
+
+void FSourceMoveBatch::GetState(int32 Index, FSourceMoveState &OutState) const
+{
+	OutState.Velocity = FVector(VelocityX[Index], VelocityY[Index], VelocityZ[Index]);
+	OutState.Acceleration = FVector(AccelerationX[Index], AccelerationY[Index], AccelerationZ[Index]);
+	OutState.SurfaceFriction = SurfaceFriction[Index];
+}
+
+void FSourceMoveBatch::GetInput(int32 Index, float DeltaTime, FSourceMoveInput &OutInput) const
+{
+	OutInput.DeltaTime = DeltaTime;
+	OutInput.Friction = Friction[Index];
+	OutInput.BrakingFriction = BrakingFriction[Index];
+	OutInput.BrakingDeceleration = BrakingDeceleration[Index];
+	OutInput.MaxSpeed = MaxSpeed[Index];
+	OutInput.bIsGroundMove = (Flags[Index] & Flag_GroundMove) != 0;
+	OutInput.bFluid = (Flags[Index] & Flag_Fluid) != 0;
+	OutInput.bCheatFlying = (Flags[Index] & Flag_CheatFlying) != 0;
+}
+
+void FSourceMoveBatch::SetState(int32 Index, const FSourceMoveState &State)
+{
+	VelocityX[Index] = State.Velocity.X;
+	VelocityY[Index] = State.Velocity.Y;
+	VelocityZ[Index] = State.Velocity.Z;
+	AccelerationX[Index] = State.Acceleration.X;
+	AccelerationY[Index] = State.Acceleration.Y;
+	AccelerationZ[Index] = State.Acceleration.Z;
+	SurfaceFriction[Index] = State.SurfaceFriction;
+}
+
+//~ ==== Kernel ============================================================================================= ~//
+
+int32 FSourceMoveKernel::ApplyBraking(FVector &Velocity, float DeltaTime, float Friction, float BrakingDeceleration, const FSourceMoveSettings &Settings)
+{
+	// UE4-COPY: void UCharacterMovementComponent::ApplyVelocityBraking(float DeltaTime, float Friction, float BrakingDeceleration)
+	if (Velocity.IsNearlyZero(0.1f) || DeltaTime < MinTickTime)
+	{
+		return 0;
+	}
+
+	const float Speed = Velocity.Size2D();
+
+	const float FrictionFactor = FMath::Max(0.0f, Settings.BrakingFrictionFactor);
+	Friction = FMath::Max(0.0f, Friction * FrictionFactor);
+	{
+		BrakingDeceleration = FMath::Max(BrakingDeceleration, Speed);
+	}
+	BrakingDeceleration = FMath::Max(0.0f, BrakingDeceleration);
+	const bool bZeroFriction = FMath::IsNearlyZero(Friction);
+	const bool bZeroBraking = BrakingDeceleration == 0.0f;
+
+	if (bZeroFriction || bZeroBraking)
+	{
+		return 0;
+	}
+
+	int32 SubSteps = 1;
+
+	if (Settings.bClosedFormBraking)
+	{
+		//: The loop below applies a constant deceleration along a fixed direction until the time runs out or the
+		//: velocity would reverse, so the result only depends on the total speed lost over the frame
+		const float SpeedLoss = Friction * BrakingDeceleration * DeltaTime;
+		const float OldSpeed = Velocity.Size();
+		if (SpeedLoss >= OldSpeed)
+		{
+			Velocity = FVector::ZeroVector;
+			return SubSteps;
+		}
+		Velocity *= 1.0f - SpeedLoss / OldSpeed;
+	}
+	else
+	{
+		const FVector OldVel = Velocity;
+
+		// subdivide braking to get reasonably consistent results at lower frame rates
+		// (important for packet loss situations w/ networking)
+		float RemainingTime = DeltaTime;
+		const float MaxTimeStep = FMath::Clamp(Settings.BrakingSubStepTime, 1.0f / 75.0f, 1.0f / 20.0f);
+
+		// Decelerate to brake to a stop
+		const FVector RevAccel = -Velocity.GetSafeNormal();
+		SubSteps = 0;
+		while (RemainingTime >= MinTickTime)
+		{
+			const float Delta = (RemainingTime > MaxTimeStep ? FMath::Min(MaxTimeStep, RemainingTime * 0.5f) : RemainingTime);
+			RemainingTime -= Delta;
+			++SubSteps;
+
+			// apply friction and braking
+			Velocity += (Friction * BrakingDeceleration * RevAccel) * Delta;
+
+			// Don't reverse direction
+			if ((Velocity | OldVel) <= 0.0f)
+			{
+				Velocity = FVector::ZeroVector;
+				return SubSteps;
+			}
+		}
+	}
+
+	// Clamp to zero if nearly zero
+	if (Velocity.IsNearlyZero(KINDA_SMALL_NUMBER))
+	{
+		Velocity = FVector::ZeroVector;
+	}
+
+	return SubSteps;
+}
+
+int32 FSourceMoveKernel::CalcVelocity(FSourceMoveState &State, const FSourceMoveInput &Input, const FSourceMoveSettings &Settings)
+{
+	if (Input.DeltaTime < MinTickTime)
+	{
+		return 0;
+	}
+
+	FVector &Velocity = State.Velocity;
+	FVector &Acceleration = State.Acceleration;
+	const float DeltaTime = Input.DeltaTime;
+	const float MaxSpeed = Input.MaxSpeed;
+
+	// Apply braking or deceleration
+	const bool bZeroAcceleration = Acceleration.IsNearlyZero();
+
+	int32 BrakingSubSteps = 0;
+
+	// Apply friction
+	if (Input.bIsGroundMove)
+	{
+		//: Same 1% tolerance as UMovementComponent::IsExceedingMaxSpeed
+		const bool bVelocityOverMax = Velocity.SizeSquared() > FMath::Square(FMath::Max(0.0f, MaxSpeed)) * 1.01f;
+		const FVector OldVelocity = Velocity;
+
+		BrakingSubSteps = ApplyBraking(Velocity, DeltaTime, Input.BrakingFriction * State.SurfaceFriction, Input.BrakingDeceleration, Settings);
+
+		// Don't allow braking to lower us below max speed if we started above it.
+		if (bVelocityOverMax && Velocity.SizeSquared() < FMath::Square(MaxSpeed) && FVector::DotProduct(Acceleration, OldVelocity) > 0.0f)
+		{
+			Velocity = OldVelocity.GetSafeNormal() * MaxSpeed;
+		}
+	}
+
+	// Apply fluid friction
+	if (Input.bFluid)
+	{
+		Velocity = Velocity * (1.0f - FMath::Min(Input.Friction * DeltaTime, 1.0f));
+	}
+
+	// Limit before
+	Velocity.X = FMath::Clamp(Velocity.X, -Settings.AxisSpeedLimit, Settings.AxisSpeedLimit);
+	Velocity.Y = FMath::Clamp(Velocity.Y, -Settings.AxisSpeedLimit, Settings.AxisSpeedLimit);
+
+	// TODO no clip
+	if (Input.bCheatFlying)
+	{
+	}
+	// walk move
+	else
+	{
+		// Apply input acceleration
+		if (!bZeroAcceleration)
+		{
+			// Clamp acceleration to max speed
+			Acceleration = Acceleration.GetClampedToMaxSize2D(MaxSpeed);
+			// Find veer
+			const FVector AccelDir = Acceleration.GetSafeNormal2D();
+			const float Veer = Velocity.X * AccelDir.X + Velocity.Y * AccelDir.Y;
+			// Get add speed with air speed cap
+			const float AddSpeed = (Input.bIsGroundMove ? Acceleration : Acceleration.GetClampedToMaxSize2D(Settings.AirSpeedCap)).Size2D() - Veer;
+			if (AddSpeed > 0.0f)
+			{
+				// Apply acceleration
+				const float AccelerationMultiplier = Input.bIsGroundMove ? Settings.GroundAccelerationMultiplier : Settings.AirAccelerationMultiplier;
+				FVector CurrentAcceleration = Acceleration * AccelerationMultiplier * State.SurfaceFriction * DeltaTime;
+				CurrentAcceleration = CurrentAcceleration.GetClampedToMaxSize2D(AddSpeed);
+				Velocity += CurrentAcceleration;
+			}
+		}
+	}
+
+	// Limit after
+	Velocity.X = FMath::Clamp(Velocity.X, -Settings.AxisSpeedLimit, Settings.AxisSpeedLimit);
+	Velocity.Y = FMath::Clamp(Velocity.Y, -Settings.AxisSpeedLimit, Settings.AxisSpeedLimit);
+
+	return BrakingSubSteps;
+}
+
+void FSourceMoveKernel::AdvanceBatch(FSourceMoveBatch &Batch, float DeltaTime, const FSourceMoveSettings &Settings)
+{
+	if (DeltaTime < MinTickTime)
+	{
+		return;
+	}
+
+	FSourceMoveState State;
+	FSourceMoveInput Input;
+	const int32 Count = Batch.Num();
+	int32 Index = 0;
+
+	//: Four movers at a time through the vector path
+	for (; Index + SourceMoveSimd::Width <= Count; Index += SourceMoveSimd::Width)
+	{
+		if (SourceMoveSimd::CanVectorize(Batch, Index))
+		{
+			SourceMoveSimd::AdvanceLanes(Batch, Index, DeltaTime, Settings);
+			continue;
+		}
+
+		for (int32 Lane = Index; Lane < Index + SourceMoveSimd::Width; ++Lane)
+		{
+			Batch.GetState(Lane, State);
+			Batch.GetInput(Lane, DeltaTime, Input);
+			CalcVelocity(State, Input, Settings);
+			Batch.SetState(Lane, State);
+		}
+	}
+
+	//: Leftovers take the scalar path
+	for (; Index < Count; ++Index)
+	{
+		Batch.GetState(Index, State);
+		Batch.GetInput(Index, DeltaTime, Input);
+		CalcVelocity(State, Input, Settings);
+		Batch.SetState(Index, State);
+	}
+}
+
+float FSourceMoveKernel::GetSlopeSpeedMultiplier(float Speed2D, float SpeedMultMin, float SpeedMultMax, float SurfaceFriction, bool bFalling)
+{
+	// Dynamic step height code for allowing sliding on a slope when at a high speed
+	// Scale step/ramp height down the faster we go
+	const float SpeedScale = (Speed2D - SpeedMultMin) / (SpeedMultMax - SpeedMultMin);
+	float SpeedMultiplier = FMath::Clamp(SpeedScale, 0.0f, 1.0f);
+	SpeedMultiplier *= SpeedMultiplier;
+	if (!bFalling)
+	{
+		// If we're on ground, factor in friction.
+		SpeedMultiplier = FMath::Max((1.0f - SurfaceFriction) * SpeedMultiplier, 0.0f);
+	}
+	return SpeedMultiplier;
+}
+
+FSourceStepLimits FSourceMoveKernel::GetStepLimits(const FSourceStepLimitSettings &Settings, float SpeedMultiplier)
+{
+	FSourceStepLimits Limits;
+	Limits.StepHeight = FMath::Lerp(Settings.DefaultStepHeight, Settings.MinStepHeight, SpeedMultiplier);
+	Limits.WalkableFloorZ = FMath::Lerp(Settings.DefaultWalkableFloorZ, Settings.FastWalkableFloorZ, SpeedMultiplier);
+	return Limits;
+}
@@ -0,0 +1,429 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Player/S_MovementBenchmark.h"
+#include "Player/S_Character.h"
+#include "Player/S_CharacterMovement.h"
+#include "Player/S_MovementManager.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogS_MovementBenchmark, Log, All);
+
+//: Budgets per pawn tick, summed over every course, the Combax.Movement.Bench tests fail when a course goes over them
+static TAutoConsoleVariable<float> CVarBenchMaxTickMs(TEXT("sv.movement.bench.maxtickms"), 0.5f, TEXT("Fail the movement benchmark if a pawn's average movement tick exceeds this many ms. 0 disables.\n"), ECVF_Default);
+static TAutoConsoleVariable<float> CVarBenchMaxSweeps(TEXT("sv.movement.bench.maxsweeps"), 8.0f, TEXT("Fail the movement benchmark if a pawn averages more capsule and floor sweeps than this per tick. 0 disables.\n"), ECVF_Default);
+
+//~ ==== Courses ============================================================================================ ~//
+
+const TCHAR *GetBenchCourseName(ES_BenchCourse Course)
+{
+	switch (Course)
+	{
+	case ES_BenchCourse::Flat:
+		return TEXT("flat");
+	case ES_BenchCourse::Ramp:
+		return TEXT("ramp");
+	case ES_BenchCourse::Stairs:
+		return TEXT("stairs");
+	case ES_BenchCourse::Surf:
+		return TEXT("surf");
+	case ES_BenchCourse::Air:
+		return TEXT("air");
+	default:
+		return TEXT("?");
+	}
+}
+
+//: Far away from anything a map would put near the origin
+static const FVector BenchOrigin(0.0f, 0.0f, 50000.0f);
+static constexpr float LaneSpacing = 3000.0f;
+static constexpr float LaneLength = 6000.0f;
+static constexpr float LaneWidth = 2000.0f;
+
+//: Falling from here takes a couple of seconds at Source gravity
+static constexpr float AirDropHeight = 4000.0f;
+static constexpr int32 AirColumns = 8;
+static constexpr float AirSpacing = 200.0f;
+
+static TUniquePtr<FS_MovementBenchmark> ActiveBenchmark;
+
+FS_MovementBenchmark::FS_MovementBenchmark(UWorld *InWorld, int32 PawnCount, float InDuration, ES_BenchCourse InOnlyCourse)
+	: World(InWorld), Duration(InDuration), OnlyCourse(InOnlyCourse)
+{
+	PreviousTimingValue = IConsoleManager::Get().FindConsoleVariable(TEXT("sv.movement.counters"))->GetInt();
+	IConsoleManager::Get().FindConsoleVariable(TEXT("sv.movement.counters"))->Set(1, ECVF_SetByConsole);
+
+	BuildCourses();
+	SpawnPawns(PawnCount);
+}
+
+void FS_MovementBenchmark::Cleanup()
+{
+	if (bCleanedUp)
+	{
+		return;
+	}
+	bCleanedUp = true;
+
+	for (const FS_BenchPawn &Pawn : Pawns)
+	{
+		if (AS_Character *Character = Pawn.Character.Get())
+		{
+			Character->Destroy();
+		}
+	}
+	for (const TWeakObjectPtr<AActor> &Actor : Geometry)
+	{
+		if (Actor.IsValid())
+		{
+			Actor->Destroy();
+		}
+	}
+	Pawns.Reset();
+	Geometry.Reset();
+	IConsoleManager::Get().FindConsoleVariable(TEXT("sv.movement.counters"))->Set(PreviousTimingValue, ECVF_SetByConsole);
+}
+
+void FS_MovementBenchmark::AddBox(const FVector &Center, const FVector &Size, const FRotator &Rotation)
+{
+	static UStaticMesh *Cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.ObjectFlags |= RF_Transient;
+	AStaticMeshActor *Box = World->SpawnActor<AStaticMeshActor>(Center, Rotation, SpawnParams);
+	if (Box == nullptr)
+	{
+		return;
+	}
+
+	//: The basic cube is 100 units on a side
+	Box->GetStaticMeshComponent()->SetMobility(EComponentMobility::Movable);
+	Box->GetStaticMeshComponent()->SetStaticMesh(Cube);
+	Box->SetActorScale3D(Size / 100.0f);
+	Geometry.Add(Box);
+}
+
+void FS_MovementBenchmark::BuildCourses()
+{
+	const US_CharacterMovement *Defaults = GetDefault<US_CharacterMovement>();
+	const float Thickness = 100.0f;
+
+	for (int32 CourseIndex = 0; CourseIndex < static_cast<int32>(ES_BenchCourse::Count); ++CourseIndex)
+	{
+		const FVector LaneOrigin = BenchOrigin + FVector(0.0f, CourseIndex * LaneSpacing, 0.0f);
+
+		//: Every course starts on flat ground
+		AddBox(LaneOrigin + FVector(LaneLength * 0.5f, 0.0f, -Thickness * 0.5f), FVector(LaneLength, LaneWidth, Thickness));
+
+		switch (static_cast<ES_BenchCourse>(CourseIndex))
+		{
+		case ES_BenchCourse::Ramp:
+		{
+			//: Right at the walkable limit, acos(0.7) = 45.57 degrees
+			const float Angle = FMath::RadiansToDegrees(FMath::Acos(Defaults->GetWalkableFloorZ()));
+			const float RampLength = 2000.0f;
+			const FVector Center = LaneOrigin + FVector(LaneLength * 0.5f, 0.0f, FMath::Sin(FMath::DegreesToRadians(Angle)) * RampLength * 0.5f - Thickness * 0.5f);
+			AddBox(Center, FVector(RampLength, LaneWidth, Thickness), FRotator(Angle, 0.0f, 0.0f));
+			break;
+		}
+		case ES_BenchCourse::Stairs:
+		{
+			const float StepDepth = 60.0f;
+			for (int32 Step = 0; Step < 20; ++Step)
+			{
+				const float Height = (Step + 1) * Defaults->MaxStepHeight;
+				AddBox(LaneOrigin + FVector(LaneLength * 0.25f + Step * StepDepth, 0.0f, Height * 0.5f), FVector(StepDepth, LaneWidth, Height));
+			}
+			break;
+		}
+		case ES_BenchCourse::Surf:
+		{
+			//: Too steep to stand on, pawns slide along it while strafing into it
+			const float Angle = 60.0f;
+			AddBox(LaneOrigin + FVector(LaneLength * 0.5f, LaneWidth * 0.25f, 400.0f), FVector(LaneLength, 1000.0f, Thickness), FRotator(0.0f, 0.0f, Angle));
+			AddBox(LaneOrigin + FVector(LaneLength * 0.5f, -LaneWidth * 0.25f, 400.0f), FVector(LaneLength, 1000.0f, Thickness), FRotator(0.0f, 0.0f, -Angle));
+			break;
+		}
+		default:
+			break;
+		}
+	}
+}
+
+void FS_MovementBenchmark::SpawnPawns(int32 PawnCount)
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnParams.ObjectFlags |= RF_Transient;
+
+	const int32 CourseCount = static_cast<int32>(ES_BenchCourse::Count);
+	for (int32 Index = 0; Index < PawnCount; ++Index)
+	{
+		FS_BenchPawn &Pawn = Pawns.AddDefaulted_GetRef();
+		Pawn.Course = OnlyCourse != ES_BenchCourse::Count ? OnlyCourse : static_cast<ES_BenchCourse>(Index % CourseCount);
+		Pawn.Phase = Index * 0.37f;
+
+		//: Pawns on the same course overlap, which is fine, they don't block each other's capsule
+		const float StartZ = Pawn.Course == ES_BenchCourse::Surf ? 1200.0f : Pawn.Course == ES_BenchCourse::Air ? AirDropHeight : 100.0f;
+		Pawn.Start = BenchOrigin + FVector(200.0f, static_cast<int32>(Pawn.Course) * LaneSpacing, StartZ);
+
+		//: Spread out over the lane so their falls don't share space, otherwise none of them could skip a sweep
+		if (Pawn.Course == ES_BenchCourse::Air)
+		{
+			Pawn.Start += FVector((Index / AirColumns) * AirSpacing, (Index % AirColumns - (AirColumns - 1) * 0.5f) * AirSpacing, 0.0f);
+		}
+
+		AS_Character *Character = World->SpawnActor<AS_Character>(AS_Character::StaticClass(), Pawn.Start, FRotator::ZeroRotator, SpawnParams);
+		if (Character == nullptr)
+		{
+			continue;
+		}
+		Character->GetCapsuleComponent()->SetCollisionResponseToChannel(ECC_Pawn, ECR_Ignore);
+		if (US_CharacterMovement *Movement = Character->GetMovementPtr())
+		{
+			Movement->bRunPhysicsWithNoController = true;
+		}
+		Pawn.Character = Character;
+	}
+}
+
+void FS_MovementBenchmark::DrivePawn(FS_BenchPawn &Pawn, float Time)
+{
+	AS_Character *Character = Pawn.Character.Get();
+	if (Character == nullptr)
+	{
+		return;
+	}
+
+	//: Loop back to the start once off the end of the course or off the geometry, or back on the ground after the drop
+	const FVector Location = Character->GetActorLocation();
+	const bool bLanded = Pawn.Course == ES_BenchCourse::Air && Character->GetCharacterMovement()->IsMovingOnGround();
+	if (bLanded || Location.X > Pawn.Start.X + LaneLength - 400.0f || Location.Z < BenchOrigin.Z - 1000.0f)
+	{
+		Character->SetActorLocation(Pawn.Start, false, nullptr, ETeleportType::ResetPhysics);
+		Character->GetCharacterMovement()->StopMovementImmediately();
+		return;
+	}
+
+	//: Strafe jumping: sweep the view side to side and strafe with it
+	const float Wave = FMath::Sin(Time * 3.0f + Pawn.Phase);
+	const float Yaw = Wave * 30.0f;
+	Character->SetActorRotation(FRotator(0.0f, Yaw, 0.0f));
+
+	const FVector Forward = FRotator(0.0f, Yaw, 0.0f).Vector();
+	const FVector Right = FRotator(0.0f, Yaw + 90.0f, 0.0f).Vector();
+	const float Strafe = Pawn.Course == ES_BenchCourse::Surf ? FMath::Sign(Location.Y - Pawn.Start.Y) : FMath::Sign(Wave);
+	Character->AddMovementInput(Forward, Pawn.Course == ES_BenchCourse::Surf ? 0.3f : 1.0f);
+	Character->AddMovementInput(Right, Strafe);
+
+	if (Pawn.Course != ES_BenchCourse::Surf && Character->GetCharacterMovement()->IsMovingOnGround())
+	{
+		Character->Jump();
+	}
+	else
+	{
+		Character->StopJumping();
+	}
+}
+
+void FS_MovementBenchmark::Tick(float DeltaTime)
+{
+	if (bFinished || !World.IsValid())
+	{
+		bFinished = true;
+		Cleanup();
+		return;
+	}
+
+	//: Collect what the pawns did last frame, once the first second of settling in is over
+	const bool bMeasuring = Elapsed > 1.0f;
+	for (FS_BenchPawn &Pawn : Pawns)
+	{
+		AS_Character *Character = Pawn.Character.Get();
+		US_CharacterMovement *Movement = Character ? Character->GetMovementPtr() : nullptr;
+		if (Movement == nullptr)
+		{
+			continue;
+		}
+		if (bMeasuring)
+		{
+			Totals[static_cast<int32>(Pawn.Course)] += Movement->GetMovementCounters();
+		}
+		Movement->ResetMovementCounters();
+	}
+	if (bMeasuring)
+	{
+		++MeasuredFrames;
+		MeasuredFrameSeconds += DeltaTime;
+	}
+
+	Elapsed += DeltaTime;
+	if (Elapsed >= Duration + 1.0f)
+	{
+		Report();
+		bFinished = true;
+		Cleanup();
+		return;
+	}
+
+	for (FS_BenchPawn &Pawn : Pawns)
+	{
+		DrivePawn(Pawn, Elapsed);
+	}
+}
+
+void FS_MovementBenchmark::Report()
+{
+	const float MaxTickMs = CVarBenchMaxTickMs.GetValueOnGameThread();
+	const float MaxSweeps = CVarBenchMaxSweeps.GetValueOnGameThread();
+	Failures.Reset();
+
+	UE_LOG(LogS_MovementBenchmark, Display, TEXT("Movement benchmark: %d pawns, %d frames, %.2f ms average frame"), Pawns.Num(), MeasuredFrames, MeasuredFrames > 0 ? MeasuredFrameSeconds * 1000.0 / MeasuredFrames : 0.0);
+
+	FS_MovementCounters All;
+	for (int32 CourseIndex = 0; CourseIndex <= static_cast<int32>(ES_BenchCourse::Count); ++CourseIndex)
+	{
+		const bool bAll = CourseIndex == static_cast<int32>(ES_BenchCourse::Count);
+		const FS_MovementCounters &Counters = bAll ? All : Totals[CourseIndex];
+		if (!bAll)
+		{
+			All += Counters;
+		}
+
+		const double Ticks = FMath::Max(Counters.Ticks, 1);
+		const double TickMs = Counters.TickSeconds * 1000.0 / Ticks;
+		const double SweepsPerTick = (Counters.Sweeps + Counters.FloorFinds + Counters.FloorTraces) / Ticks;
+
+		UE_LOG(LogS_MovementBenchmark, Display, TEXT("  %-6s %7d ticks | tick %.4f ms | CalcVelocity %.4f ms | PhysFalling %.4f ms | FindFloor %.4f ms | %.2f moves %.2f floor finds %.2f floor traces per tick"),
+			   bAll ? TEXT("all") : GetBenchCourseName(static_cast<ES_BenchCourse>(CourseIndex)), Counters.Ticks, TickMs,
+			   Counters.CalcVelocitySeconds * 1000.0 / Ticks, Counters.PhysFallingSeconds * 1000.0 / Ticks, Counters.FloorSeconds * 1000.0 / Ticks,
+			   Counters.Sweeps / Ticks, Counters.FloorFinds / Ticks, Counters.FloorTraces / Ticks);
+
+		if (MaxTickMs > 0.0f && TickMs > MaxTickMs)
+		{
+			Failures.Add(FString::Printf(TEXT("%s: %.4f ms per tick is over the %.4f ms threshold"), bAll ? TEXT("all") : GetBenchCourseName(static_cast<ES_BenchCourse>(CourseIndex)), TickMs, MaxTickMs));
+		}
+		if (MaxSweeps > 0.0f && SweepsPerTick > MaxSweeps)
+		{
+			Failures.Add(FString::Printf(TEXT("%s: %.2f sweeps per tick is over the %.2f threshold"), bAll ? TEXT("all") : GetBenchCourseName(static_cast<ES_BenchCourse>(CourseIndex)), SweepsPerTick, MaxSweeps));
+		}
+	}
+
+	for (const FString &Failure : Failures)
+	{
+		UE_LOG(LogS_MovementBenchmark, Error, TEXT("  %s"), *Failure);
+	}
+	const bool bPassed = Failures.Num() == 0;
+	UE_LOG(LogS_MovementBenchmark, Display, TEXT("Movement benchmark %s"), bPassed ? TEXT("passed") : TEXT("FAILED"));
+
+	if (FParse::Param(FCommandLine::Get(), TEXT("MovementBenchExit")))
+	{
+		FPlatformMisc::RequestExitWithStatus(false, bPassed ? 0 : 1);
+	}
+}
+
+//~ ==== Commands =========================================================================================== ~//
+
+static void RunMovementBenchmark(const TArray<FString> &Args, UWorld *World)
+{
+	if (World == nullptr || !World->IsGameWorld())
+	{
+		UE_LOG(LogS_MovementBenchmark, Warning, TEXT("The movement benchmark needs a game world"));
+		return;
+	}
+	if (ActiveBenchmark.IsValid() && !ActiveBenchmark->IsFinished())
+	{
+		UE_LOG(LogS_MovementBenchmark, Warning, TEXT("A movement benchmark is already running"));
+		return;
+	}
+
+	const int32 PawnCount = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 64;
+	const float Duration = Args.Num() > 1 ? FMath::Max(1.0f, FCString::Atof(*Args[1])) : 10.0f;
+
+	ES_BenchCourse OnlyCourse = ES_BenchCourse::Count;
+	for (int32 CourseIndex = 0; Args.Num() > 2 && CourseIndex < static_cast<int32>(ES_BenchCourse::Count); ++CourseIndex)
+	{
+		if (Args[2] == GetBenchCourseName(static_cast<ES_BenchCourse>(CourseIndex)))
+		{
+			OnlyCourse = static_cast<ES_BenchCourse>(CourseIndex);
+		}
+	}
+
+	ActiveBenchmark = MakeUnique<FS_MovementBenchmark>(World, PawnCount, Duration, OnlyCourse);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs RunMovementBenchmarkCommand(
+	TEXT("sv.movement.bench"),
+	TEXT("Run pawns over flat ground, ramps, stairs, surf ramps and a long drop with scripted input and report movement cost per pawn tick. Arguments: pawn count, seconds, optional course (flat, ramp, stairs, surf, air)."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunMovementBenchmark));
+
+//~ ==== Slides ============================================================================================= ~//
+
+//~ Times the Source slide as PhysFalling inlines it against the engine path it replaced, projection then a virtual
+//~ HandleSlopeBoosting, on a mover that is made to look like it is falling, and checks they agree
+static void BenchmarkSlides(const TArray<FString> &Args, UWorld *World)
+{
+	const US_MovementManager *Manager = World ? World->GetSubsystem<US_MovementManager>() : nullptr;
+	US_CharacterMovement *Movement = nullptr;
+	for (US_CharacterMovement *Mover : Manager ? Manager->GetMovers() : TArray<US_CharacterMovement *>())
+	{
+		Movement = (!Movement && Mover->GetProfileSettings().SlidePolicy == ES_SlidePolicy::Source && !Mover->bConstrainToPlane) ? Mover : Movement;
+	}
+	if (!Movement)
+	{
+		UE_LOG(LogS_MovementBenchmark, Warning, TEXT("The slide benchmark needs a pawn using the Source slide policy"));
+		return;
+	}
+
+	const int32 Count = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 1000000;
+
+	//: A small set of hits reused over and over, so the loops time the slide and not cache misses
+	constexpr int32 NumSamples = 1024;
+	FRandomStream Random(1);
+	TArray<FVector> Deltas;
+	TArray<FHitResult> Hits;
+	for (int32 Index = 0; Index < NumSamples; ++Index)
+	{
+		Deltas.Add(Random.GetUnitVector() * Random.FRandRange(1.0f, 100.0f));
+		FHitResult &Hit = Hits.AddDefaulted_GetRef();
+		Hit.Normal = Random.GetUnitVector();
+		Hit.ImpactNormal = Index % 4 == 0 ? FVector::UpVector : Hit.Normal;
+	}
+
+	TGuardValue<TEnumAsByte<EMovementMode>> FallingGuard(Movement->MovementMode, MOVE_Falling);
+
+	double MaxDifference = 0.0;
+	for (int32 Index = 0; Index < NumSamples; ++Index)
+	{
+		FVector Policy = FVector::ZeroVector;
+		Movement->TimeInlinedSlides(MakeArrayView(&Deltas[Index], 1), MakeArrayView(&Hits[Index], 1), 0.5f, 1, Policy);
+		const FVector Engine = Movement->UCharacterMovementComponent::ComputeSlideVector(Deltas[Index], 0.5f, Hits[Index].Normal, Hits[Index]);
+		MaxDifference = FMath::Max(MaxDifference, (Policy - Engine).GetAbsMax());
+	}
+
+	//: The policy loop runs inside the movement component, where the slide is inlined the same way PhysFalling has it
+	FVector Sum = FVector::ZeroVector;
+	const double PolicySeconds = Movement->TimeInlinedSlides(Deltas, Hits, 0.5f, Count, Sum);
+
+	const double Start = FPlatformTime::Seconds();
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		const int32 Sample = Index & (NumSamples - 1);
+		Sum += Movement->UCharacterMovementComponent::ComputeSlideVector(Deltas[Sample], 0.5f, Hits[Sample].Normal, Hits[Sample]);
+	}
+	const double EngineSeconds = FPlatformTime::Seconds() - Start;
+
+	UE_LOG(LogS_MovementBenchmark, Display, TEXT("Slides: %d of each, inlined policy %.2f ns, engine path %.2f ns, largest difference %g (checksum %s)"), Count,
+		   PolicySeconds * 1e9 / Count, EngineSeconds * 1e9 / Count, MaxDifference, *Sum.ToCompactString());
+}
+
+static FAutoConsoleCommandWithWorldAndArgs BenchmarkSlidesCommand(
+	TEXT("sv.slide.bench"),
+	TEXT("Time falling slides through the Source slide policy against the engine path they replace. Optional argument: slide count."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BenchmarkSlides));
@@ -0,0 +1,135 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Player/S_MovementHistory.h"
+
+void FS_MovementHistory::Record(double Time, const FVector &Location, float HalfHeight, float InRadius)
+{
+	Radius = InRadius;
+
+	if (Count > 0 && GetSample(Count - 1).Time >= Time)
+	{
+		Samples[(Head + Capacity - 1) % Capacity] = {Time, Location, HalfHeight};
+		return;
+	}
+
+	Samples[Head] = {Time, Location, HalfHeight};
+	Head = (Head + 1) % Capacity;
+	Count = FMath::Min(Count + 1, Capacity);
+}
+
+bool FS_MovementHistory::GetCapsuleAt(double Time, FVector &OutLocation, float &OutHalfHeight) const
+{
+	if (Count == 0)
+	{
+		return false;
+	}
+
+	const FS_CapsuleSample &Oldest = GetSample(0);
+	const FS_CapsuleSample &Newest = GetSample(Count - 1);
+	if (Time <= Oldest.Time || Count == 1)
+	{
+		OutLocation = Oldest.Location;
+		OutHalfHeight = Oldest.HalfHeight;
+		return true;
+	}
+	if (Time >= Newest.Time)
+	{
+		OutLocation = Newest.Location;
+		OutHalfHeight = Newest.HalfHeight;
+		return true;
+	}
+
+	//: Binary search for the first sample after Time, samples are ordered by time
+	int32 Low = 1;
+	int32 High = Count - 1;
+	while (Low < High)
+	{
+		const int32 Mid = (Low + High) / 2;
+		if (GetSample(Mid).Time <= Time)
+		{
+			Low = Mid + 1;
+		}
+		else
+		{
+			High = Mid;
+		}
+	}
+
+	const FS_CapsuleSample &Before = GetSample(Low - 1);
+	const FS_CapsuleSample &After = GetSample(Low);
+	const double Alpha = (Time - Before.Time) / FMath::Max(After.Time - Before.Time, UE_DOUBLE_SMALL_NUMBER);
+	OutLocation = FMath::Lerp(Before.Location, After.Location, Alpha);
+	OutHalfHeight = FMath::Lerp(Before.HalfHeight, After.HalfHeight, static_cast<float>(Alpha));
+	return true;
+}
+
+//: Rounding slack at the end of the segment, so a shot that ends right on the surface still hits
+static constexpr double EntryTolerance = 1e-9;
+
+//~ Smaller root of A t^2 + B t + C = 0 within the segment, the parameter a line enters a round shape at. C <= 0 when it starts inside.
+static bool GetEntryTime(double A, double B, double C, double &OutTime)
+{
+	if (C <= 0.0)
+	{
+		OutTime = 0.0;
+		return true;
+	}
+
+	const double Discriminant = B * B - 4.0 * A * C;
+	if (A < UE_DOUBLE_SMALL_NUMBER || Discriminant < 0.0)
+	{
+		return false;
+	}
+	OutTime = (-B - FMath::Sqrt(Discriminant)) / (2.0 * A);
+	if (OutTime < 0.0 || OutTime > 1.0 + EntryTolerance)
+	{
+		return false;
+	}
+	OutTime = FMath::Min(OutTime, 1.0);
+	return true;
+}
+
+bool FS_MovementHistory::IntersectSegment(const FVector &Start, const FVector &End, double Time, float &OutFraction, FVector &OutLocation) const
+{
+	FVector Center;
+	float HalfHeight;
+	if (!GetCapsuleAt(Time, Center, HalfHeight))
+	{
+		return false;
+	}
+
+	//: The capsule is a vertical cylinder around its core segment with a sphere at either end. Entering any of the three
+	//: is entering the capsule, and the flat ends of the cylinder are inside the spheres, so the first entry is the
+	//: earliest of the cylinder's side and the two spheres.
+	const double CoreHalfHeight = FMath::Max(HalfHeight - Radius, 0.0f);
+	const double RadiusSquared = FMath::Square(double(Radius));
+	const FVector Delta = End - Start;
+	double Entry = TNumericLimits<double>::Max();
+	double Candidate;
+
+	const FVector Offset = Start - Center;
+	const double SideA = FVector2D(Delta).SizeSquared();
+	const double SideB = 2.0 * (FVector2D(Offset) | FVector2D(Delta));
+	const double SideC = FVector2D(Offset).SizeSquared() - RadiusSquared;
+	if (GetEntryTime(SideA, SideB, SideC, Candidate) && FMath::Abs(Offset.Z + Delta.Z * Candidate) <= CoreHalfHeight)
+	{
+		Entry = Candidate;
+	}
+
+	for (const double CapZ : {-CoreHalfHeight, CoreHalfHeight})
+	{
+		const FVector CapOffset = Offset - FVector(0.0, 0.0, CapZ);
+		if (GetEntryTime(Delta.SizeSquared(), 2.0 * (CapOffset | Delta), CapOffset.SizeSquared() - RadiusSquared, Candidate))
+		{
+			Entry = FMath::Min(Entry, Candidate);
+		}
+	}
+
+	if (Entry > 1.0)
+	{
+		return false;
+	}
+	OutFraction = static_cast<float>(Entry);
+	OutLocation = Start + Delta * Entry;
+	return true;
+}
@@ -0,0 +1,588 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Player/S_MovementManager.h"
+#include "Player/S_Character.h"
+#include "Player/S_CharacterMovement.h"
+#include "Async/ParallelFor.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Misc/DateTime.h"
+#include "Misc/Paths.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogS_Movement, Log, All);
+
+static TAutoConsoleVariable<int32> CVarBatchMovement(TEXT("sv.batchmovement"), 0, TEXT("Step the velocity of locally controlled movers in vectorized batches before they tick.\n"), ECVF_Default);
+static TAutoConsoleVariable<int32> CVarBatchFallSweeps(TEXT("sv.batchfallsweeps"), 0, TEXT("Check the space falling movers are about to move through in one parallel batch, and skip the sweep of moves that stay in empty space. Only pawns that simulate their own moves are checked, moves the server replays for remote clients always sweep.\n"), ECVF_Default);
+static TAutoConsoleVariable<float> CVarFallSweepDynamicSpeed(TEXT("sv.batchfallsweeps.dynamicspeed"), 6000.0f, TEXT("Fastest a dynamic object the movement manager doesn't move (projectiles, kinematic movers, other pawns) is assumed to travel, in units per second. Falling moves within a frame's travel of one always sweep, so anything faster can still be tunnelled into.\n"), ECVF_Default);
+static TAutoConsoleVariable<int32> CVarMovementLOD(TEXT("cl.movementlod"), 0, TEXT("Simulate the movement of distant and off screen simulated proxies less often, smoothing in between, and skip their cosmetic work.\n"), ECVF_Default);
+static TAutoConsoleVariable<float> CVarRewindMaxTime(TEXT("sv.rewind.maxtime"), 0.4f, TEXT("Furthest back in seconds a shot is allowed to be rewound.\n"), ECVF_Default);
+static TAutoConsoleVariable<float> CVarRewindInterpDelay(TEXT("sv.rewind.interpdelay"), 0.1f, TEXT("How far behind the server simulated proxies are drawn on clients, added to half the ping when rewinding.\n"), ECVF_Default);
+
+//~ ==== Tick function ====================================================================================== ~//
+
+void FS_MovementManagerTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef &MyCompletionGraphEvent)
+{
+	if (Manager && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Manager->Tick(DeltaTime);
+	}
+}
+
+FString FS_MovementManagerTickFunction::DiagnosticMessage()
+{
+	return TEXT("FS_MovementManagerTickFunction");
+}
+
+//~ ==== Subsystem ========================================================================================== ~//
+
+bool US_MovementManager::ShouldCreateSubsystem(UObject *Outer) const
+{
+	const UWorld *World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld();
+}
+
+void US_MovementManager::OnWorldBeginPlay(UWorld &InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	TickFunction.Manager = this;
+	TickFunction.bCanEverTick = true;
+	TickFunction.bStartWithTickEnabled = true;
+	TickFunction.TickGroup = TG_PrePhysics;
+	TickFunction.RegisterTickFunction(InWorld.PersistentLevel);
+}
+
+void US_MovementManager::Deinitialize()
+{
+	if (TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.UnRegisterTickFunction();
+	}
+	TickFunction.Manager = nullptr;
+	Movers.Reset();
+	Groups.Reset();
+
+	Super::Deinitialize();
+}
+
+void US_MovementManager::Register(US_CharacterMovement *Movement)
+{
+	if (Movement)
+	{
+		Movers.AddUnique(Movement);
+	}
+}
+
+void US_MovementManager::Unregister(US_CharacterMovement *Movement)
+{
+	Movers.RemoveSingleSwap(Movement);
+}
+
+void US_MovementManager::AddControllerPrerequisite(AController *Controller)
+{
+	if (Controller && Controller->PrimaryActorTick.bCanEverTick)
+	{
+		TickFunction.AddPrerequisite(Controller, Controller->PrimaryActorTick);
+	}
+}
+
+void US_MovementManager::RemoveControllerPrerequisite(AController *Controller)
+{
+	if (Controller)
+	{
+		TickFunction.RemovePrerequisite(Controller, Controller->PrimaryActorTick);
+	}
+}
+
+bool US_MovementManager::IsBatchingEnabled()
+{
+	return CVarBatchMovement.GetValueOnGameThread() != 0;
+}
+
+bool US_MovementManager::IsFallBatchingEnabled()
+{
+	return CVarBatchFallSweeps.GetValueOnGameThread() != 0;
+}
+
+void US_MovementManager::Tick(float DeltaTime)
+{
+	if (GetWorld()->GetNetMode() == NM_Client)
+	{
+		UpdateProxyLODs();
+	}
+
+	if (IsBatchingEnabled())
+	{
+		FS_MovementCounterScope BatchScope(BatchSeconds);
+		GatherBatches(DeltaTime);
+		for (FS_MovementBatchGroup &Group : Groups)
+		{
+			FSourceMoveKernel::AdvanceBatch(Group.Batch, DeltaTime, Group.Settings);
+		}
+		ScatterBatches(DeltaTime);
+	}
+
+	if (IsFallBatchingEnabled())
+	{
+		ClearFallingMoves(DeltaTime);
+	}
+}
+
+void US_MovementManager::GatherBatches(float DeltaTime)
+{
+	for (FS_MovementBatchGroup &Group : Groups)
+	{
+		Group.Batch.Reset();
+		Group.Movers.Reset();
+	}
+
+	FSourceMoveState State;
+	FSourceMoveInput Input;
+	for (US_CharacterMovement *Movement : Movers)
+	{
+		if (!IsValid(Movement) || !Movement->GatherBatchedMove(DeltaTime, State, Input))
+		{
+			continue;
+		}
+
+		//: Movers almost always share settings, so a linear search over the groups is enough
+		const FSourceMoveSettings Settings = Movement->GetMoveSettings();
+		FS_MovementBatchGroup *Group = Groups.FindByPredicate([&Settings](const FS_MovementBatchGroup &Candidate)
+															  { return Candidate.Settings == Settings; });
+		if (!Group)
+		{
+			Group = &Groups.AddDefaulted_GetRef();
+			Group->Settings = Settings;
+		}
+		Group->Batch.Add(State, Input);
+		Group->Movers.Add(Movement);
+	}
+
+	//: Drop groups that went unused this frame
+	Groups.RemoveAllSwap([](const FS_MovementBatchGroup &Group)
+						 { return Group.Movers.Num() == 0; });
+}
+
+void US_MovementManager::ScatterBatches(float DeltaTime)
+{
+	FSourceMoveState State;
+	for (FS_MovementBatchGroup &Group : Groups)
+	{
+		for (int32 Index = 0; Index < Group.Movers.Num(); ++Index)
+		{
+			Group.Batch.GetState(Index, State);
+			Group.Movers[Index]->SetBatchedVelocity(State);
+		}
+	}
+}
+
+bool US_MovementManager::GetReachBox(US_CharacterMovement *Movement, float DeltaTime, FBox &OutBox)
+{
+	if (Movement->GetFallClearanceQuery(DeltaTime, OutBox))
+	{
+		return true;
+	}
+
+	//: Wherever anyone else could get to before we move
+	const float Reach = Movement->Velocity.Size() * DeltaTime * 1.25f + 10.0f;
+	OutBox = Movement->UpdatedComponent->Bounds.GetBox().ExpandBy(Reach);
+	return false;
+}
+
+void US_MovementManager::InitClearance(FS_FallClearance &Clearance, US_CharacterMovement *Movement, const FBox &Box, float DeltaTime)
+{
+	UPrimitiveComponent *Primitive = Movement->UpdatedPrimitive;
+	Clearance.Movement = Movement;
+	Clearance.Box = Box;
+	Clearance.DynamicBox = Box.ExpandBy(FMath::Max(CVarFallSweepDynamicSpeed.GetValueOnGameThread(), 0.0f) * DeltaTime);
+	Clearance.Channel = Primitive->GetCollisionObjectType();
+	Clearance.QueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(FallClearance), false, Movement->GetOwner());
+
+	//: Weapons and anything else riding along move with us, not into us
+	TArray<AActor *> Attached;
+	Movement->GetOwner()->GetAttachedActors(Attached);
+	Clearance.QueryParams.AddIgnoredActors(Attached);
+	Primitive->InitSweepCollisionParams(Clearance.QueryParams, Clearance.ResponseParams);
+	Clearance.bClear = false;
+}
+
+//~ Whether nothing the mover blocks or overlaps is inside its clearance box, and no dynamic object is close enough to
+//~ get into it this frame. Safe to call from worker threads.
+static bool IsSpaceClear(const UWorld *World, const FS_FallClearance &Clearance)
+{
+	if (World->OverlapAnyTestByChannel(Clearance.Box.GetCenter(), FQuat::Identity, Clearance.Channel, FCollisionShape::MakeBox(Clearance.Box.GetExtent()), Clearance.QueryParams, Clearance.ResponseParams))
+	{
+		return false;
+	}
+
+	//: Projectiles, kinematic movers and pawns that aren't ours move after the query saw them, so keep away from all of them
+	return !World->OverlapAnyTestByObjectType(Clearance.DynamicBox.GetCenter(), FQuat::Identity, FCollisionObjectQueryParams(FCollisionObjectQueryParams::AllDynamicObjects),
+											  FCollisionShape::MakeBox(Clearance.DynamicBox.GetExtent()), Clearance.QueryParams);
+}
+
+void US_MovementManager::ClearFallingMoves(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_CombaxFallClearance);
+	TRACE_CPUPROFILER_EVENT_SCOPE(US_MovementManager::ClearFallingMoves);
+
+	FallClearances.Reset();
+	ReachBoxes.Reset();
+
+	FBox Box;
+	for (US_CharacterMovement *Movement : Movers)
+	{
+		if (!IsValid(Movement) || !Movement->UpdatedPrimitive)
+		{
+			continue;
+		}
+
+		const int32 ReachIndex = ReachBoxes.Add(FBox(ForceInit));
+		if (GetReachBox(Movement, DeltaTime, ReachBoxes[ReachIndex]))
+		{
+			FS_FallClearance &Clearance = FallClearances.AddDefaulted_GetRef();
+			InitClearance(Clearance, Movement, ReachBoxes[ReachIndex], DeltaTime);
+			Clearance.ReachIndex = ReachIndex;
+		}
+	}
+
+	//: Scene queries are read only and safe off the game thread, the same way async traces run them
+	const UWorld *World = GetWorld();
+	ParallelFor(FallClearances.Num(), [this, World](int32 Index)
+				{
+					FS_FallClearance &Clearance = FallClearances[Index];
+					Clearance.bClear = IsSpaceClear(World, Clearance); });
+
+	//: Other movers aren't where the queries saw them by the time we move, so stay out of anywhere they could reach
+	for (int32 Index = 0; Index < FallClearances.Num(); ++Index)
+	{
+		FS_FallClearance &Clearance = FallClearances[Index];
+		for (int32 Other = 0; Clearance.bClear && Other < ReachBoxes.Num(); ++Other)
+		{
+			Clearance.bClear = Other == Clearance.ReachIndex || !ReachBoxes[Other].Intersect(Clearance.Box);
+		}
+		if (Clearance.bClear)
+		{
+			Clearance.Movement->SetClearFallBox(Clearance.Box);
+		}
+	}
+}
+
+//~ ==== Proxy LOD ========================================================================================== ~//
+
+void US_MovementManager::UpdateProxyLODs()
+{
+	FMemory::Memzero(ProxiesAtLOD);
+
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	const APlayerController *PlayerController = GetWorld()->GetFirstPlayerController();
+	const bool bHasView = PlayerController != nullptr;
+	if (bHasView)
+	{
+		PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+	}
+
+	const bool bEnabled = bHasView && CVarMovementLOD.GetValueOnGameThread() != 0;
+	for (US_CharacterMovement *Movement : Movers)
+	{
+		if (!IsValid(Movement) || !Movement->GetCharacterOwner())
+		{
+			continue;
+		}
+
+		//: Possessed or handed authority since the last update, back to the full path
+		if (Movement->GetCharacterOwner()->GetLocalRole() != ROLE_SimulatedProxy)
+		{
+			Movement->SetMovementLOD(ES_MovementLOD::Full);
+			continue;
+		}
+
+		const ES_MovementLOD LOD = bEnabled ? Movement->ComputeMovementLOD(ViewLocation) : ES_MovementLOD::Full;
+		Movement->SetMovementLOD(LOD);
+		++ProxiesAtLOD[static_cast<int32>(LOD)];
+	}
+
+	SET_DWORD_STAT(STAT_CombaxProxiesFullLOD, ProxiesAtLOD[static_cast<int32>(ES_MovementLOD::Full)]);
+	SET_DWORD_STAT(STAT_CombaxProxiesReducedLOD, ProxiesAtLOD[static_cast<int32>(ES_MovementLOD::Reduced)]);
+	SET_DWORD_STAT(STAT_CombaxProxiesMinimalLOD, ProxiesAtLOD[static_cast<int32>(ES_MovementLOD::Minimal)]);
+}
+
+//~ ==== Lag compensation ================================================================================= ~//
+
+double US_MovementManager::GetShooterViewTime(const AController *Shooter) const
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+	if (!Shooter || Shooter->IsLocalController() || !Shooter->PlayerState)
+	{
+		return Now;
+	}
+
+	const double Rewind = Shooter->PlayerState->GetPingInMilliseconds() * 0.0005 + CVarRewindInterpDelay.GetValueOnGameThread();
+	return Now - FMath::Clamp(Rewind, 0.0, static_cast<double>(CVarRewindMaxTime.GetValueOnGameThread()));
+}
+
+bool US_MovementManager::RewindSegmentTest(const FVector &Start, const FVector &End, double ViewTime, const AActor *IgnoreActor, FS_RewindHit &OutHit) const
+{
+	OutHit = FS_RewindHit();
+
+	float Fraction;
+	FVector Location;
+	for (US_CharacterMovement *Movement : Movers)
+	{
+		if (!IsValid(Movement) || Movement->GetOwner() == IgnoreActor)
+		{
+			continue;
+		}
+		if (Movement->GetMovementHistory().IntersectSegment(Start, End, ViewTime, Fraction, Location) && (!OutHit.Movement || Fraction < OutHit.Fraction))
+		{
+			OutHit.Movement = Movement;
+			OutHit.Fraction = Fraction;
+			OutHit.Location = Location;
+		}
+	}
+	return OutHit.Movement != nullptr;
+}
+
+int32 US_MovementManager::SetWorldMovementProfile(US_MovementProfile *Profile)
+{
+	WorldMovementProfile = Profile;
+	bHasWorldMovementProfile = true;
+
+	//: Through the pawns' replicated profile, so clients follow without anything else to keep in sync
+	int32 Characters = 0;
+	for (US_CharacterMovement *Movement : Movers)
+	{
+		if (AS_Character *Character = IsValid(Movement) ? Cast<AS_Character>(Movement->GetCharacterOwner()) : nullptr)
+		{
+			Character->SetMovementProfile(Profile);
+			++Characters;
+		}
+	}
+	return Characters;
+}
+
+//~ ==== Benchmark ========================================================================================== ~//
+
+//~ Sweeps speeds and frame times through both braking modes, reporting the largest deviation and the cost of each
+static void BenchmarkBraking(const TArray<FString> &Args)
+{
+	const int32 Repeats = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 200;
+	const float Friction = 4.0f;
+	const float BrakingDeceleration = 190.5f;
+	const float FrameTimes[] = {1.0f / 300.0f, 1.0f / 144.0f, 1.0f / 60.0f, 1.0f / 30.0f, 1.0f / 20.0f, 1.0f / 10.0f};
+
+	FSourceMoveSettings LoopSettings;
+	LoopSettings.bClosedFormBraking = false;
+	FSourceMoveSettings ClosedFormSettings;
+	ClosedFormSettings.bClosedFormBraking = true;
+
+	for (const float DeltaTime : FrameTimes)
+	{
+		float MaxError = 0.0f;
+		int32 OverTolerance = 0;
+		double LoopTime = 0.0;
+		double ClosedFormTime = 0.0;
+		for (float Speed = 1.0f; Speed <= 3000.0f; Speed *= 1.25f)
+		{
+			const FVector StartVelocity = FVector(0.8f, 0.6f, 0.0f) * Speed;
+
+			FVector LoopVelocity = StartVelocity;
+			FVector ClosedFormVelocity = StartVelocity;
+			FSourceMoveKernel::ApplyBraking(LoopVelocity, DeltaTime, Friction, BrakingDeceleration, LoopSettings);
+			FSourceMoveKernel::ApplyBraking(ClosedFormVelocity, DeltaTime, Friction, BrakingDeceleration, ClosedFormSettings);
+			const float Error = (LoopVelocity - ClosedFormVelocity).Size();
+			MaxError = FMath::Max(MaxError, Error);
+			if (Error > FSourceMoveKernel::GetClosedFormBrakingTolerance(Speed))
+			{
+				++OverTolerance;
+				UE_LOG(LogS_Movement, Error, TEXT("dt %.4f, speed %.2f: closed form braking is %.5f u/s off the substeps, over the %.5f tolerance"), DeltaTime, Speed, Error,
+					   FSourceMoveKernel::GetClosedFormBrakingTolerance(Speed));
+			}
+
+			double Start = FPlatformTime::Seconds();
+			for (int32 Repeat = 0; Repeat < Repeats; ++Repeat)
+			{
+				FVector Velocity = StartVelocity;
+				FSourceMoveKernel::ApplyBraking(Velocity, DeltaTime, Friction, BrakingDeceleration, LoopSettings);
+			}
+			LoopTime += FPlatformTime::Seconds() - Start;
+
+			Start = FPlatformTime::Seconds();
+			for (int32 Repeat = 0; Repeat < Repeats; ++Repeat)
+			{
+				FVector Velocity = StartVelocity;
+				FSourceMoveKernel::ApplyBraking(Velocity, DeltaTime, Friction, BrakingDeceleration, ClosedFormSettings);
+			}
+			ClosedFormTime += FPlatformTime::Seconds() - Start;
+		}
+
+		UE_LOG(LogS_Movement, Display, TEXT("dt %.4f: max error %.5f u/s (%d speeds over tolerance), loop %.3f ms, closed form %.3f ms"), DeltaTime, MaxError, OverTolerance, LoopTime * 1000.0,
+			   ClosedFormTime * 1000.0);
+	}
+}
+
+static FAutoConsoleCommand BenchmarkBrakingCommand(
+	TEXT("sv.braking.bench"),
+	TEXT("Compare substepped and closed form braking over a sweep of speeds and frame times. Optional argument: repeat count."),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkBraking));
+
+//~ Rewinds 64 synthetic pawns with full histories against random shots
+static void BenchmarkRewind(const TArray<FString> &Args)
+{
+	const int32 Shots = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 1000;
+	const int32 PawnCount = 64;
+	const double TickTime = 1.0 / 60.0;
+
+	FRandomStream Random(PawnCount);
+	TArray<FS_MovementHistory> Histories;
+	Histories.SetNum(PawnCount);
+	for (FS_MovementHistory &History : Histories)
+	{
+		FVector Location(Random.FRandRange(-4000.0f, 4000.0f), Random.FRandRange(-4000.0f, 4000.0f), 0.0f);
+		const FVector Velocity = FVector(Random.FRandRange(-1.0f, 1.0f), Random.FRandRange(-1.0f, 1.0f), 0.0f).GetSafeNormal() * 800.0f;
+		for (int32 Tick = 0; Tick < FS_MovementHistory::Capacity; ++Tick)
+		{
+			History.Record(Tick * TickTime, Location, 68.58f, 30.48f);
+			Location += Velocity * TickTime;
+		}
+	}
+
+	const double Newest = (FS_MovementHistory::Capacity - 1) * TickTime;
+	int32 Hits = 0;
+	float Fraction;
+	FVector HitLocation;
+	const double Start = FPlatformTime::Seconds();
+	for (int32 Shot = 0; Shot < Shots; ++Shot)
+	{
+		const FVector ShotStart(Random.FRandRange(-4000.0f, 4000.0f), Random.FRandRange(-4000.0f, 4000.0f), 60.0f);
+		const FVector ShotEnd = ShotStart + FVector(Random.FRandRange(-1.0f, 1.0f), Random.FRandRange(-1.0f, 1.0f), 0.0f).GetSafeNormal() * 8000.0f;
+		const double ViewTime = Newest - Random.FRandRange(0.0f, 0.4f);
+		for (const FS_MovementHistory &History : Histories)
+		{
+			Hits += History.IntersectSegment(ShotStart, ShotEnd, ViewTime, Fraction, HitLocation) ? 1 : 0;
+		}
+	}
+	const double Time = FPlatformTime::Seconds() - Start;
+
+	UE_LOG(LogS_Movement, Display, TEXT("%d shots against %d pawns: %.3f ms total, %.3f us per shot, %d capsule hits"), Shots, PawnCount, Time * 1000.0, Time * 1000000.0 / Shots, Hits);
+}
+
+static FAutoConsoleCommand BenchmarkRewindCommand(
+	TEXT("sv.rewind.bench"),
+	TEXT("Time rewinding 64 pawns per shot. Optional argument: shot count."),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkRewind));
+
+//~ Logs what every registered mover has done since its counters were last reset, most expensive first
+static void DumpMovementCounters(const TArray<FString> &Args, UWorld *World)
+{
+	const US_MovementManager *Manager = World ? World->GetSubsystem<US_MovementManager>() : nullptr;
+	if (!Manager)
+	{
+		return;
+	}
+
+	TArray<US_CharacterMovement *> Movers = Manager->GetMovers();
+	Movers.Sort([](const US_CharacterMovement &A, const US_CharacterMovement &B)
+				{ return A.GetMovementCounters().TickSeconds > B.GetMovementCounters().TickSeconds; });
+
+	if (!FS_MovementCounters::IsTimingEnabled())
+	{
+		UE_LOG(LogS_Movement, Display, TEXT("sv.movement.counters is off, only counts are collected"));
+	}
+
+	FS_MovementCounters Total;
+	double CorrectionsPerSecond = 0.0;
+	for (const US_CharacterMovement *Movement : Movers)
+	{
+		const FS_MovementCounters &Counters = Movement->GetMovementCounters();
+		Total += Counters;
+		CorrectionsPerSecond += Counters.GetCorrectionsPerSecond();
+
+		const int32 Ticks = FMath::Max(1, Counters.Ticks);
+		UE_LOG(LogS_Movement, Display, TEXT("%s [%s] at %s: %d ticks | tick %.4f ms | CalcVelocity %.4f ms | PhysFalling %.4f ms | FindFloor %.4f ms"),
+			   *GetNameSafe(Movement->GetOwner()), *Movement->GetMovementName(), *Movement->GetOwner()->GetActorLocation().ToCompactString(), Counters.Ticks,
+			   Counters.TickSeconds * 1000.0 / Ticks, Counters.CalcVelocitySeconds * 1000.0 / Ticks, Counters.PhysFallingSeconds * 1000.0 / Ticks, Counters.FloorSeconds * 1000.0 / Ticks);
+		UE_LOG(LogS_Movement, Display, TEXT("    %d sweeps, %d floor finds, %d floor traces, %d landing spot checks (%d/%d from the surface index), %d/%d air catches, %d braking substeps, %d falling sweeps skipped, %d/%d batched velocities used"),
+			   Counters.Sweeps, Counters.FloorFinds, Counters.FloorTraces, Counters.LandingSpotChecks, Counters.SurfaceIndexHits, Counters.SurfaceIndexHits + Counters.SurfaceIndexMisses,
+			   Counters.CatchAirs, Counters.CatchAirChecks, Counters.BrakingSubSteps, Counters.FallSweepsSkipped, Counters.BatchedVelocityHits, Counters.BatchedVelocityHits + Counters.BatchedVelocityMisses);
+		if (Counters.ServerMoveResponses > 0 || Counters.Replays > 0)
+		{
+			UE_LOG(LogS_Movement, Display, TEXT("    %d/%d moves corrected (%.2f per second), most after %s, %d errors tolerated, %d corrections deferred, %d replays of %.1f moves on average"),
+				   Counters.Corrections, Counters.ServerMoveResponses, Counters.GetCorrectionsPerSecond(), GetCorrectionSourceName(Counters.GetTopCorrectionSource()), Counters.ClientPositionsAccepted,
+				   Counters.CorrectionsDeferred, Counters.Replays, Counters.Replays > 0 ? double(Counters.ReplayedMoves) / Counters.Replays : 0.0);
+		}
+	}
+
+	const int32 IndexLookups = Total.SurfaceIndexHits + Total.SurfaceIndexMisses;
+	const int32 BatchedVelocities = Total.BatchedVelocityHits + Total.BatchedVelocityMisses;
+	UE_LOG(LogS_Movement, Display, TEXT("%d movers, %d ticks, %.3f ms total, %d sweeps, %d floor traces, surface index hit rate %.1f%% of %d lookups, batched velocity hit rate %.1f%% of %d"),
+		   Movers.Num(), Total.Ticks, Total.TickSeconds * 1000.0, Total.Sweeps, Total.FloorTraces, IndexLookups > 0 ? 100.0 * Total.SurfaceIndexHits / IndexLookups : 0.0, IndexLookups,
+		   BatchedVelocities > 0 ? 100.0 * Total.BatchedVelocityHits / BatchedVelocities : 0.0, BatchedVelocities);
+	if (Total.ServerMoveResponses > 0)
+	{
+		UE_LOG(LogS_Movement, Display, TEXT("Corrections: %d of %d moves, %.2f per second over all connections, %d slope boosting, %d catching air, %d movement mode, %d other, %d deferred by the budget"),
+			   Total.Corrections, Total.ServerMoveResponses, CorrectionsPerSecond, Total.CorrectionsBySource[static_cast<int32>(ES_CorrectionSource::SlopeBoost)],
+			   Total.CorrectionsBySource[static_cast<int32>(ES_CorrectionSource::CatchAir)], Total.CorrectionsBySource[static_cast<int32>(ES_CorrectionSource::ModeMismatch)],
+			   Total.CorrectionsBySource[static_cast<int32>(ES_CorrectionSource::Other)], Total.CorrectionsDeferred);
+	}
+	if (World->GetNetMode() == NM_Client)
+	{
+		UE_LOG(LogS_Movement, Display, TEXT("Simulated proxies by movement LOD: %d full, %d reduced, %d minimal"), Manager->GetNumProxiesAtLOD(ES_MovementLOD::Full),
+			   Manager->GetNumProxiesAtLOD(ES_MovementLOD::Reduced), Manager->GetNumProxiesAtLOD(ES_MovementLOD::Minimal));
+	}
+
+	if (Args.Num() > 0 && Args[0] == TEXT("reset"))
+	{
+		for (US_CharacterMovement *Movement : Movers)
+		{
+			Movement->ResetMovementCounters();
+		}
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs DumpMovementCountersCommand(
+	TEXT("sv.movement.dump"),
+	TEXT("Log the movement counters of every pawn, most expensive first. Pass 'reset' to clear them afterwards."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&DumpMovementCounters));
+
+//~ Starts recording the local player's movement, or stops and saves it if already recording
+static void ToggleMovementRecording(const TArray<FString> &Args, UWorld *World)
+{
+	const APlayerController *PlayerController = World ? World->GetFirstPlayerController() : nullptr;
+	const AS_Character *Character = PlayerController ? Cast<AS_Character>(PlayerController->GetPawn()) : nullptr;
+	US_CharacterMovement *Movement = Character ? Character->GetMovementPtr() : nullptr;
+	if (!Movement)
+	{
+		UE_LOG(LogS_Movement, Warning, TEXT("No local player pawn to record"));
+		return;
+	}
+
+	if (!Movement->IsRecording())
+	{
+		Movement->StartRecording();
+		UE_LOG(LogS_Movement, Display, TEXT("Recording movement, run sv.movement.record again to save"));
+		return;
+	}
+
+	const FString Filename = Args.Num() > 0 ? Args[0] : FPaths::ProjectSavedDir() / TEXT("MovementRecordings") / FDateTime::Now().ToString() + TEXT(".cbxm");
+	if (Movement->StopRecording(Filename))
+	{
+		UE_LOG(LogS_Movement, Display, TEXT("Saved movement recording to %s"), *Filename);
+	}
+	else
+	{
+		UE_LOG(LogS_Movement, Error, TEXT("Failed to write movement recording to %s"), *Filename);
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs ToggleMovementRecordingCommand(
+	TEXT("sv.movement.record"),
+	TEXT("Start recording the local player's movement inputs, or stop and save them. Optional argument when stopping: file name. Replay with -run=S_ReplayMovement."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&ToggleMovementRecording));
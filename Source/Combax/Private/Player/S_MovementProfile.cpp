@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Player/S_MovementProfile.h"
+#include "Player/S_MovementManager.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogS_MovementProfile, Log, All);
+
+const FPrimaryAssetType US_MovementProfile::PrimaryAssetType = TEXT("MovementProfile");
+
+FPrimaryAssetId US_MovementProfile::GetPrimaryAssetId() const
+{
+	return FPrimaryAssetId(PrimaryAssetType, GetFName());
+}
+
+#if WITH_EDITOR
+void US_MovementProfile::PostEditChangeProperty(FPropertyChangedEvent &PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	OnSettingsChanged.Broadcast();
+}
+#endif
+
+//~ Switches every character in the world to the profile at the given object path, or back to their own tunables with none.
+//~ Characters spawned afterwards start with it too.
+static void SetMovementProfile(const TArray<FString> &Args, UWorld *World)
+{
+	US_MovementManager *Manager = World ? World->GetSubsystem<US_MovementManager>() : nullptr;
+	if (!Manager || World->GetNetMode() == NM_Client || Args.Num() == 0)
+	{
+		UE_LOG(LogS_MovementProfile, Warning, TEXT("Usage on a server or standalone: sv.movementprofile <profile path | none>"));
+		return;
+	}
+
+	US_MovementProfile *Profile = nullptr;
+	if (Args[0] != TEXT("none"))
+	{
+		Profile = LoadObject<US_MovementProfile>(nullptr, *Args[0]);
+		if (!Profile)
+		{
+			UE_LOG(LogS_MovementProfile, Warning, TEXT("No movement profile at %s"), *Args[0]);
+			return;
+		}
+	}
+
+	const int32 Characters = Manager->SetWorldMovementProfile(Profile);
+	UE_LOG(LogS_MovementProfile, Display, TEXT("%d characters switched to %s"), Characters, Profile ? *Profile->GetName() : TEXT("their own tunables"));
+}
+
+static FAutoConsoleCommandWithWorldAndArgs SetMovementProfileCommand(
+	TEXT("sv.movementprofile"),
+	TEXT("Switch every character, and every one spawned after, to a movement profile, replicated to clients. Argument: profile object path, or none for each pawn's own tunables, the HL2 defaults unless it migrated old ones."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&SetMovementProfile));
@@ -0,0 +1,246 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Player/S_MovementRecording.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+
+//: Float fields of a frame in the order their bits appear in the change mask, buttons come last
+static constexpr int32 NumFloatFields = 11;
+static constexpr uint32 ButtonsChanged = 1 << NumFloatFields;
+
+static void GetFields(const FS_MovementFrame &Frame, float (&OutFields)[NumFloatFields])
+{
+	OutFields[0] = Frame.DeltaTime;
+	OutFields[1] = Frame.MoveInput.X;
+	OutFields[2] = Frame.MoveInput.Y;
+	OutFields[3] = Frame.Pitch;
+	OutFields[4] = Frame.Yaw;
+	OutFields[5] = Frame.Location.X;
+	OutFields[6] = Frame.Location.Y;
+	OutFields[7] = Frame.Location.Z;
+	OutFields[8] = Frame.Velocity.X;
+	OutFields[9] = Frame.Velocity.Y;
+	OutFields[10] = Frame.Velocity.Z;
+}
+
+static void SetFields(FS_MovementFrame &Frame, const float (&Fields)[NumFloatFields])
+{
+	Frame.DeltaTime = Fields[0];
+	Frame.MoveInput = FVector2f(Fields[1], Fields[2]);
+	Frame.Pitch = Fields[3];
+	Frame.Yaw = Fields[4];
+	Frame.Location = FVector3f(Fields[5], Fields[6], Fields[7]);
+	Frame.Velocity = FVector3f(Fields[8], Fields[9], Fields[10]);
+}
+
+static void WriteVarint(TArray<uint8> &Out, uint32 Value)
+{
+	while (Value >= 0x80)
+	{
+		Out.Add(uint8(Value | 0x80));
+		Value >>= 7;
+	}
+	Out.Add(uint8(Value));
+}
+
+static bool ReadVarint(const uint8 *Data, int64 Size, int64 &Offset, uint32 &OutValue)
+{
+	OutValue = 0;
+	for (int32 Shift = 0; Shift < 35; Shift += 7)
+	{
+		if (Offset >= Size)
+		{
+			return false;
+		}
+		const uint8 Byte = Data[Offset++];
+		OutValue |= uint32(Byte & 0x7F) << Shift;
+		if ((Byte & 0x80) == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+//: Slowly changing floats of the same sign have nearby bit patterns, so their difference is a short varint
+static uint32 EncodeDelta(float Value, float Previous)
+{
+	const int32 Delta = int32(BitCast<uint32>(Value) - BitCast<uint32>(Previous));
+	return (uint32(Delta) << 1) ^ uint32(Delta >> 31);
+}
+
+static float DecodeDelta(uint32 Encoded, float Previous)
+{
+	const int32 Delta = int32(Encoded >> 1) ^ -int32(Encoded & 1);
+	return BitCast<float>(BitCast<uint32>(Previous) + uint32(Delta));
+}
+
+//~ ==== Recorder ============================================================================================= ~//
+
+FS_MovementRecorder::FS_MovementRecorder(const FString &InMapName, const FS_MovementRecordingHeader &InHeader)
+	: MapName(InMapName), Header(InHeader)
+{
+	Header.FrameCount = 0;
+	Previous.Location = FVector3f(Header.StartLocation);
+	Previous.Velocity = Header.StartVelocity;
+	Previous.Yaw = Header.StartYaw;
+}
+
+void FS_MovementRecorder::AddFrame(const FS_MovementFrame &Frame)
+{
+	float Fields[NumFloatFields];
+	float PreviousFields[NumFloatFields];
+	GetFields(Frame, Fields);
+	GetFields(Previous, PreviousFields);
+
+	uint32 Mask = Frame.Buttons != Previous.Buttons ? ButtonsChanged : 0;
+	for (int32 Index = 0; Index < NumFloatFields; ++Index)
+	{
+		if (BitCast<uint32>(Fields[Index]) != BitCast<uint32>(PreviousFields[Index]))
+		{
+			Mask |= 1 << Index;
+		}
+	}
+
+	WriteVarint(Frames, Mask);
+	for (int32 Index = 0; Index < NumFloatFields; ++Index)
+	{
+		if (Mask & (1 << Index))
+		{
+			WriteVarint(Frames, EncodeDelta(Fields[Index], PreviousFields[Index]));
+		}
+	}
+	if (Mask & ButtonsChanged)
+	{
+		Frames.Add(Frame.Buttons);
+	}
+
+	Previous = Frame;
+	++Header.FrameCount;
+}
+
+bool FS_MovementRecorder::Save(const FString &Filename) const
+{
+	const FTCHARToUTF8 MapNameUTF8(*MapName);
+
+	FS_MovementRecordingHeader FileHeader = Header;
+	FileHeader.MapNameLength = MapNameUTF8.Length();
+
+	TArray<uint8> Data;
+	Data.Reserve(sizeof(FileHeader) + FileHeader.MapNameLength + Frames.Num());
+	Data.Append(reinterpret_cast<const uint8 *>(&FileHeader), sizeof(FileHeader));
+	Data.Append(reinterpret_cast<const uint8 *>(MapNameUTF8.Get()), FileHeader.MapNameLength);
+	Data.Append(Frames);
+
+	return FFileHelper::SaveArrayToFile(Data, *Filename);
+}
+
+//~ ==== Reader =============================================================================================== ~//
+
+FS_MovementRecordingReader::FS_MovementRecordingReader() = default;
+
+FS_MovementRecordingReader::~FS_MovementRecordingReader()
+{
+	//: The region has to go before the file it maps
+	MappedRegion.Reset();
+	MappedHandle.Reset();
+}
+
+bool FS_MovementRecordingReader::Open(const FString &Filename)
+{
+	MappedRegion.Reset();
+	MappedHandle.Reset();
+	LoadedData.Empty();
+
+	MappedHandle.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Filename));
+	if (MappedHandle)
+	{
+		MappedRegion.Reset(MappedHandle->MapRegion());
+	}
+
+	if (MappedRegion)
+	{
+		Data = MappedRegion->GetMappedPtr();
+		Size = MappedRegion->GetMappedSize();
+	}
+	else
+	{
+		MappedHandle.Reset();
+		if (!FFileHelper::LoadFileToArray(LoadedData, *Filename))
+		{
+			return false;
+		}
+		Data = LoadedData.GetData();
+		Size = LoadedData.Num();
+	}
+
+	if (Size < int64(sizeof(Header)))
+	{
+		return false;
+	}
+	FMemory::Memcpy(&Header, Data, sizeof(Header));
+	if (Header.Magic != FS_MovementRecordingHeader::ExpectedMagic || Header.Version != FS_MovementRecordingHeader::CurrentVersion)
+	{
+		return false;
+	}
+
+	Offset = sizeof(Header);
+	if (Offset + Header.MapNameLength > Size)
+	{
+		return false;
+	}
+	const FUTF8ToTCHAR MapNameTCHAR(reinterpret_cast<const ANSICHAR *>(Data + Offset), Header.MapNameLength);
+	MapName = FString(MapNameTCHAR.Length(), MapNameTCHAR.Get());
+	Offset += Header.MapNameLength;
+
+	Previous = FS_MovementFrame();
+	Previous.Location = FVector3f(Header.StartLocation);
+	Previous.Velocity = Header.StartVelocity;
+	Previous.Yaw = Header.StartYaw;
+	FramesRead = 0;
+	return true;
+}
+
+bool FS_MovementRecordingReader::Next(FS_MovementFrame &OutFrame)
+{
+	if (!Data || FramesRead >= Header.FrameCount)
+	{
+		return false;
+	}
+
+	uint32 Mask;
+	if (!ReadVarint(Data, Size, Offset, Mask))
+	{
+		return false;
+	}
+
+	float Fields[NumFloatFields];
+	GetFields(Previous, Fields);
+	for (int32 Index = 0; Index < NumFloatFields; ++Index)
+	{
+		uint32 Encoded;
+		if (Mask & (1 << Index))
+		{
+			if (!ReadVarint(Data, Size, Offset, Encoded))
+			{
+				return false;
+			}
+			Fields[Index] = DecodeDelta(Encoded, Fields[Index]);
+		}
+	}
+	SetFields(Previous, Fields);
+
+	if (Mask & ButtonsChanged)
+	{
+		if (Offset >= Size)
+		{
+			return false;
+		}
+		Previous.Buttons = Data[Offset++];
+	}
+
+	++FramesRead;
+	OutFrame = Previous;
+	return true;
+}
@@ -0,0 +1,373 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Player/S_RepMovement.h"
+#include "Player/S_Character.h"
+#include "Player/S_CharacterMovement.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogS_RepMovement, Log, All);
+
+//: Location in tenths of a unit has to stay under this so the difference of two still fits an int32
+static constexpr double MaxQuantizedLocation = double(1 << 29);
+
+//? Everything this server wrote since the last sv.repmovement.size reset
+struct FS_RepMovementTraffic
+{
+	int64 Updates = 0;
+	int64 WholeStates = 0;
+	int64 Fallbacks = 0;
+	int64 Bits = 0;
+	double StartTime = 0.0;
+};
+static FS_RepMovementTraffic RepMovementTraffic;
+
+//? The state last written to one connection. The replication system keeps it per connection and puts back the one before
+//? when a packet is dropped.
+class FS_RepMovementBaseState : public INetDeltaBaseState
+{
+public:
+	FS_RepMovement Movement;
+	uint8 StateId = 0;
+
+	virtual bool IsStateEqual(INetDeltaBaseState *OtherState) override
+	{
+		const FS_RepMovementBaseState *Other = static_cast<FS_RepMovementBaseState *>(OtherState);
+		return StateId == Other->StateId && Movement.IsSameState(Other->Movement);
+	}
+};
+
+static int16 QuantizeAxisSpeed(double Speed, float MaxAxisSpeed)
+{
+	return int16(FMath::Clamp(FMath::RoundToInt(Speed / MaxAxisSpeed * 32767.0), -32767, 32767));
+}
+
+static double DequantizeAxisSpeed(int16 Value, float MaxAxisSpeed)
+{
+	return Value * double(MaxAxisSpeed) / 32767.0;
+}
+
+//~ Small negative values take as few bits as small positive ones
+static uint32 ZigZag(int32 Value)
+{
+	return (uint32(Value) << 1) ^ uint32(Value >> 31);
+}
+
+static int32 UnZigZag(uint32 Value)
+{
+	return int32(Value >> 1) ^ -int32(Value & 1);
+}
+
+//~ A bit for whether any of Values is non-zero, then one bit count shared by all of them the way SerializePackedVector
+//~ shares one between components, then each value zig zagged in that many bits
+template <int32 Num>
+static void SerializePackedInts(FArchive &Ar, int32 (&Values)[Num])
+{
+	uint32 Encoded[Num];
+	uint32 NumBits = 0;
+	if (Ar.IsSaving())
+	{
+		for (int32 Index = 0; Index < Num; ++Index)
+		{
+			Encoded[Index] = ZigZag(Values[Index]);
+			NumBits = FMath::Max(NumBits, 32 - FMath::CountLeadingZeros(Encoded[Index]));
+		}
+	}
+
+	uint8 bNonZero = NumBits > 0;
+	Ar.SerializeBits(&bNonZero, 1);
+	if (!bNonZero)
+	{
+		for (int32 Index = 0; Index < Num; ++Index)
+		{
+			Values[Index] = 0;
+		}
+		return;
+	}
+
+	//: At least one bit, so 1 to 32 fits in five
+	uint32 NumBitsMinusOne = NumBits - 1;
+	Ar.SerializeInt(NumBitsMinusOne, 32);
+	NumBits = NumBitsMinusOne + 1;
+
+	for (int32 Index = 0; Index < Num; ++Index)
+	{
+		if (Ar.IsLoading())
+		{
+			Encoded[Index] = 0;
+		}
+		Ar.SerializeBits(&Encoded[Index], NumBits);
+		Values[Index] = UnZigZag(Encoded[Index]);
+	}
+}
+
+void FS_RepMovement::Set(const FRepMovement &Movement, bool bSprinting, bool bWantsToWalk, float AxisSpeedLimit)
+{
+	Flags = (bSprinting ? Flag_Sprinting : 0) | (bWantsToWalk ? Flag_WantsToWalk : 0);
+
+	//: The movement component clamps every axis to AxisSpeedLimit, anything faster was launched past it and goes out whole
+	const FVector &LinearVelocity = Movement.LinearVelocity;
+	const FVector ScaledLocation = Movement.Location * 10.0;
+	const bool bInRange = AxisSpeedLimit > 0.0f && LinearVelocity.GetAbsMax() <= AxisSpeedLimit && ScaledLocation.GetAbsMax() < MaxQuantizedLocation;
+	if (Movement.bRepPhysics || !bInRange)
+	{
+		Flags |= Flag_Fallback;
+		Fallback = Movement;
+		return;
+	}
+
+	Location = FIntVector(FMath::RoundToInt(ScaledLocation.X), FMath::RoundToInt(ScaledLocation.Y), FMath::RoundToInt(ScaledLocation.Z));
+
+	MaxAxisSpeed = AxisSpeedLimit;
+	Velocity[0] = QuantizeAxisSpeed(LinearVelocity.X, MaxAxisSpeed);
+	Velocity[1] = QuantizeAxisSpeed(LinearVelocity.Y, MaxAxisSpeed);
+	Velocity[2] = QuantizeAxisSpeed(LinearVelocity.Z, MaxAxisSpeed);
+
+	Yaw = FRotator::CompressAxisToShort(Movement.Rotation.Yaw);
+	Pitch = FRotator::CompressAxisToShort(Movement.Rotation.Pitch);
+	Roll = FRotator::CompressAxisToShort(Movement.Rotation.Roll);
+}
+
+void FS_RepMovement::Get(FRepMovement &OutMovement) const
+{
+	if (Flags & Flag_Fallback)
+	{
+		OutMovement = Fallback;
+		return;
+	}
+
+	OutMovement.Location = FVector(Location) / 10.0;
+	OutMovement.LinearVelocity = FVector(DequantizeAxisSpeed(Velocity[0], MaxAxisSpeed), DequantizeAxisSpeed(Velocity[1], MaxAxisSpeed), DequantizeAxisSpeed(Velocity[2], MaxAxisSpeed));
+	OutMovement.AngularVelocity = FVector::ZeroVector;
+	OutMovement.Rotation = FRotator(FRotator::DecompressAxisFromShort(Pitch), FRotator::DecompressAxisFromShort(Yaw), FRotator::DecompressAxisFromShort(Roll));
+	OutMovement.bRepPhysics = false;
+	OutMovement.bSimulatedPhysicSleep = false;
+}
+
+bool FS_RepMovement::ConsumeReceivedState()
+{
+	const bool bUnread = bReceivedStateUnread;
+	bReceivedStateUnread = false;
+	return bUnread;
+}
+
+bool FS_RepMovement::IsSameState(const FS_RepMovement &Other) const
+{
+	if (Flags != Other.Flags)
+	{
+		return false;
+	}
+	if (Flags & Flag_Fallback)
+	{
+		return Fallback.Location == Other.Fallback.Location && Fallback.Rotation == Other.Fallback.Rotation && Fallback.LinearVelocity == Other.Fallback.LinearVelocity &&
+			   Fallback.AngularVelocity == Other.Fallback.AngularVelocity && Fallback.bSimulatedPhysicSleep == Other.Fallback.bSimulatedPhysicSleep;
+	}
+	return Location == Other.Location && MaxAxisSpeed == Other.MaxAxisSpeed && Velocity[0] == Other.Velocity[0] && Velocity[1] == Other.Velocity[1] &&
+		   Velocity[2] == Other.Velocity[2] && Yaw == Other.Yaw && Pitch == Other.Pitch && Roll == Other.Roll;
+}
+
+void FS_RepMovement::SerializeState(FArchive &Ar, const FS_RepMovement *Base, bool &bOutSuccess)
+{
+	//: Sprint and walk change far less often than the rest, so a delta only carries the flags when they differ from the base.
+	//: Deltas are never taken to or from a fallback state, so its flag can't be the one that changed.
+	uint8 bFlagsChanged = !Base || Flags != Base->Flags;
+	if (Base)
+	{
+		Ar.SerializeBits(&bFlagsChanged, 1);
+	}
+	if (bFlagsChanged)
+	{
+		Ar.SerializeBits(&Flags, NumFlagBits);
+	}
+	else if (Ar.IsLoading())
+	{
+		Flags = Base->Flags;
+	}
+
+	if (Flags & Flag_Fallback)
+	{
+		Fallback.NetSerialize(Ar, nullptr, bOutSuccess);
+		return;
+	}
+
+	//: A whole state is the difference from zero, plus the velocity range a delta takes from its base
+	static const FS_RepMovement Zero;
+	const FS_RepMovement &From = Base ? *Base : Zero;
+	if (!Base)
+	{
+		Ar << MaxAxisSpeed;
+	}
+	else if (Ar.IsLoading())
+	{
+		MaxAxisSpeed = Base->MaxAxisSpeed;
+	}
+
+	//: Vertical speed and pitch and roll are zero for long stretches, so they don't share a bit count with what isn't
+	int32 LocationDelta[3] = {Location.X - From.Location.X, Location.Y - From.Location.Y, Location.Z - From.Location.Z};
+	int32 VelocityDelta[2] = {Velocity[0] - From.Velocity[0], Velocity[1] - From.Velocity[1]};
+	int32 VelocityZDelta[1] = {Velocity[2] - From.Velocity[2]};
+	int32 YawDelta[1] = {int16(uint16(Yaw - From.Yaw))};
+	int32 PitchRollDelta[2] = {int16(uint16(Pitch - From.Pitch)), int16(uint16(Roll - From.Roll))};
+
+	SerializePackedInts(Ar, LocationDelta);
+	SerializePackedInts(Ar, VelocityDelta);
+	SerializePackedInts(Ar, VelocityZDelta);
+	SerializePackedInts(Ar, YawDelta);
+	SerializePackedInts(Ar, PitchRollDelta);
+
+	if (Ar.IsLoading())
+	{
+		Location = From.Location + FIntVector(LocationDelta[0], LocationDelta[1], LocationDelta[2]);
+		Velocity[0] = int16(From.Velocity[0] + VelocityDelta[0]);
+		Velocity[1] = int16(From.Velocity[1] + VelocityDelta[1]);
+		Velocity[2] = int16(From.Velocity[2] + VelocityZDelta[0]);
+		Yaw = uint16(From.Yaw + YawDelta[0]);
+		Pitch = uint16(From.Pitch + PitchRollDelta[0]);
+		Roll = uint16(From.Roll + PitchRollDelta[1]);
+	}
+
+	bOutSuccess = !Ar.IsError();
+}
+
+int64 FS_RepMovement::GetWholeStateBits() const
+{
+	FS_RepMovement State = *this;
+	FNetBitWriter Writer(nullptr, 1024);
+	bool bSuccess = true;
+	State.SerializeState(Writer, nullptr, bSuccess);
+	return 1 + NumStateIdBits + Writer.GetNumBits();
+}
+
+bool FS_RepMovement::NetDeltaSerialize(FNetDeltaSerializeInfo &DeltaParms)
+{
+	//: No object references, so there is nothing to gather or map
+	if (DeltaParms.GatherGuidReferences || DeltaParms.MoveGuidToUnmapped || DeltaParms.bUpdateUnmappedObjects)
+	{
+		return false;
+	}
+
+	if (DeltaParms.Writer)
+	{
+		const FS_RepMovementBaseState *OldState = static_cast<FS_RepMovementBaseState *>(DeltaParms.OldState);
+		if (OldState && OldState->Movement.IsSameState(*this))
+		{
+			return false;
+		}
+
+		//: Replays record without acks to roll back on, so every state goes in whole there
+		const bool bDelta = OldState && !DeltaParms.bInternalAck && !((OldState->Movement.Flags | Flags) & Flag_Fallback) && OldState->Movement.MaxAxisSpeed == MaxAxisSpeed;
+
+		const TSharedRef<FS_RepMovementBaseState> NewState = MakeShared<FS_RepMovementBaseState>();
+		NewState->Movement = *this;
+		NewState->StateId = OldState ? uint8(OldState->StateId + 1) : 0;
+		*DeltaParms.NewState = NewState;
+
+		//: A delta names its base, a whole state names itself
+		FBitWriter &Writer = *DeltaParms.Writer;
+		const int64 StartBits = Writer.GetNumBits();
+		uint8 bWriteDelta = bDelta;
+		uint8 StateId = bDelta ? OldState->StateId : NewState->StateId;
+		Writer.SerializeBits(&bWriteDelta, 1);
+		Writer.SerializeBits(&StateId, NumStateIdBits);
+
+		bool bSuccess = true;
+		SerializeState(Writer, bDelta ? &OldState->Movement : nullptr, bSuccess);
+
+		if (RepMovementTraffic.StartTime == 0.0)
+		{
+			RepMovementTraffic.StartTime = FPlatformTime::Seconds();
+		}
+		++RepMovementTraffic.Updates;
+		RepMovementTraffic.WholeStates += bDelta ? 0 : 1;
+		RepMovementTraffic.Fallbacks += (Flags & Flag_Fallback) ? 1 : 0;
+		RepMovementTraffic.Bits += Writer.GetNumBits() - StartBits;
+		return bSuccess;
+	}
+
+	if (DeltaParms.Reader)
+	{
+		FBitReader &Reader = *DeltaParms.Reader;
+		uint8 bDelta = 0;
+		uint8 StateId = 0;
+		Reader.SerializeBits(&bDelta, 1);
+		Reader.SerializeBits(&StateId, NumStateIdBits);
+
+		bool bSuccess = true;
+		if (bDelta && (!bHasReceivedState || StateId != ReceivedStateId))
+		{
+			//: The base went out in a packet that never arrived, skip this one until the server rolls back to what we have
+			FS_RepMovement Skipped;
+			Skipped.SerializeState(Reader, &Skipped, bSuccess);
+			return bSuccess;
+		}
+
+		SerializeState(Reader, bDelta ? this : nullptr, bSuccess);
+		ReceivedStateId = bDelta ? uint8(StateId + 1) : StateId;
+		bHasReceivedState = true;
+		bReceivedStateUnread = true;
+		return bSuccess;
+	}
+
+	return false;
+}
+
+//~ Logs what this server wrote since the last reset, then how big every character's current movement is as a whole
+//~ state next to the engine's encoding. "reset" starts the count over.
+static void DumpRepMovementSizes(const TArray<FString> &Args, UWorld *World)
+{
+	if (!World)
+	{
+		return;
+	}
+
+	if (Args.Num() > 0 && Args[0] == TEXT("reset"))
+	{
+		RepMovementTraffic = FS_RepMovementTraffic();
+		UE_LOG(LogS_RepMovement, Display, TEXT("Replicated movement counts reset"));
+		return;
+	}
+
+	int32 Characters = 0;
+	int64 WholeBits = 0;
+	int64 EngineBits = 0;
+	for (TActorIterator<AS_Character> It(World); It; ++It)
+	{
+		const US_CharacterMovement *Movement = It->GetMovementPtr();
+		if (!Movement)
+		{
+			continue;
+		}
+
+		FRepMovement RepMovement = It->GetReplicatedMovement();
+		bool bSuccess = true;
+
+		FS_RepMovement State;
+		State.Set(RepMovement, It->IsSprinting(), It->DoesWantToWalk(), Movement->GetProfileSettings().AxisSpeedLimit);
+
+		FNetBitWriter EngineWriter(nullptr, 1024);
+		RepMovement.NetSerialize(EngineWriter, nullptr, bSuccess);
+
+		++Characters;
+		WholeBits += State.GetWholeStateBits();
+		EngineBits += EngineWriter.GetNumBits();
+	}
+
+	const UNetDriver *NetDriver = World->GetNetDriver();
+	const int32 Connections = NetDriver ? NetDriver->ClientConnections.Num() : 0;
+	const int64 Updates = RepMovementTraffic.Updates;
+	const double Seconds = RepMovementTraffic.StartTime > 0.0 ? FPlatformTime::Seconds() - RepMovementTraffic.StartTime : 0.0;
+	const double Bytes = RepMovementTraffic.Bits / 8.0;
+	UE_LOG(LogS_RepMovement, Display, TEXT("Sent %lld updates over %.1f s, %lld whole and %lld fallback, %.1f bytes each"), Updates, Seconds, RepMovementTraffic.WholeStates,
+		   RepMovementTraffic.Fallbacks, Updates > 0 ? Bytes / Updates : 0.0);
+	UE_LOG(LogS_RepMovement, Display, TEXT("%d characters to %d connections: %.1f bytes per character per connection per second"), Characters, Connections,
+		   Seconds > 0.0 && Characters > 0 && Connections > 0 ? Bytes / Seconds / Characters / Connections : 0.0);
+	UE_LOG(LogS_RepMovement, Display, TEXT("Current movement as a whole state: %.1f bits each, %.1f with FRepMovement"), Characters > 0 ? double(WholeBits) / Characters : 0.0,
+		   Characters > 0 ? double(EngineBits) / Characters : 0.0);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs DumpRepMovementSizesCommand(
+	TEXT("sv.repmovement.size"),
+	TEXT("Log the bytes of character movement this server sent since the last \"sv.repmovement.size reset\", and the size of every character's current movement next to the engine's encoding."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&DumpRepMovementSizes));
@@ -0,0 +1,194 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Player/S_ReplayMovementCommandlet.h"
+#include "Player/S_Character.h"
+#include "Player/S_CharacterMovement.h"
+#include "Player/S_MovementRecording.h"
+#include "Player/S_MovementStats.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/Parse.h"
+#include "UObject/Package.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogS_ReplayMovement, Log, All);
+
+US_ReplayMovementCommandlet::US_ReplayMovementCommandlet()
+{
+	IsClient = false;
+	IsServer = true;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+//~ Load a map and bring it up as a game world that can be ticked
+static UWorld *LoadReplayWorld(const FString &MapName)
+{
+	UPackage *Package = LoadPackage(nullptr, *MapName, LOAD_None);
+	UWorld *World = Package ? UWorld::FindWorldInPackage(Package) : nullptr;
+	if (!World)
+	{
+		return nullptr;
+	}
+
+	World->AddToRoot();
+	World->WorldType = EWorldType::Game;
+
+	FWorldContext &WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	if (!World->bIsWorldInitialized)
+	{
+		World->InitWorld();
+	}
+	World->UpdateWorldComponents(true, false);
+
+	const FURL URL;
+	World->SetGameMode(URL);
+	World->InitializeActorsForPlay(URL);
+	World->BeginPlay();
+	return World;
+}
+
+static void UnloadReplayWorld(UWorld *World)
+{
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	World->RemoveFromRoot();
+}
+
+int32 US_ReplayMovementCommandlet::Main(const FString &Params)
+{
+	FString RecordingFile;
+	if (!FParse::Value(*Params, TEXT("Recording="), RecordingFile))
+	{
+		UE_LOG(LogS_ReplayMovement, Error, TEXT("Usage: -run=S_ReplayMovement -Recording=<file> [-Map=<package>] [-Tolerance=<cm>] [-Pawn=<class path>]"));
+		return 1;
+	}
+
+	FS_MovementRecordingReader Reader;
+	if (!Reader.Open(RecordingFile))
+	{
+		UE_LOG(LogS_ReplayMovement, Error, TEXT("Could not read movement recording %s"), *RecordingFile);
+		return 1;
+	}
+	const FS_MovementRecordingHeader &Header = Reader.GetHeader();
+
+	FString MapName = Reader.GetMapName();
+	FParse::Value(*Params, TEXT("Map="), MapName);
+
+	float Tolerance = 1.0f;
+	FParse::Value(*Params, TEXT("Tolerance="), Tolerance);
+
+	TSubclassOf<AS_Character> PawnClass = AS_Character::StaticClass();
+	FString PawnClassPath;
+	if (FParse::Value(*Params, TEXT("Pawn="), PawnClassPath))
+	{
+		PawnClass = LoadClass<AS_Character>(nullptr, *PawnClassPath);
+		if (!PawnClass)
+		{
+			UE_LOG(LogS_ReplayMovement, Error, TEXT("%s is not an AS_Character class"), *PawnClassPath);
+			return 1;
+		}
+	}
+
+	UWorld *World = LoadReplayWorld(MapName);
+	if (!World)
+	{
+		UE_LOG(LogS_ReplayMovement, Error, TEXT("Could not load map %s"), *MapName);
+		return 1;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	AS_Character *Character = World->SpawnActor<AS_Character>(PawnClass, Header.StartLocation, FRotator(0.0f, Header.StartYaw, 0.0f), SpawnParams);
+	US_CharacterMovement *Movement = Character ? Character->GetMovementPtr() : nullptr;
+	if (!Movement)
+	{
+		UE_LOG(LogS_ReplayMovement, Error, TEXT("Could not spawn the replay pawn"));
+		UnloadReplayWorld(World);
+		return 1;
+	}
+
+	//: The recording already holds one frame per movement step, so step exactly once per recorded frame
+	Movement->bRunPhysicsWithNoController = true;
+	Movement->SetUseFixedTimestep(false);
+	Movement->Velocity = FVector(Header.StartVelocity);
+	Movement->SetMovementMode(static_cast<EMovementMode>(Header.MovementMode));
+	Character->SetAutoBunnyhop(Header.bAutoBunnyhop != 0);
+
+	IConsoleVariable *CountersVar = IConsoleManager::Get().FindConsoleVariable(TEXT("sv.movement.counters"));
+	const int32 PreviousCounters = CountersVar ? CountersVar->GetInt() : 0;
+	if (CountersVar)
+	{
+		CountersVar->Set(1);
+	}
+	Movement->ResetMovementCounters();
+
+	int32 Frames = 0;
+	int32 ExactFrames = 0;
+	int32 FirstDivergentFrame = INDEX_NONE;
+	float MaxDivergence = 0.0f;
+	float FinalDivergence = 0.0f;
+	double WorldSeconds = 0.0;
+
+	FS_MovementFrame Frame;
+	while (Reader.Next(Frame))
+	{
+		//: Same calls and order as AS_Character::Move, so the input vector comes out identical
+		Character->SetActorRotation(FRotator(0.0f, Frame.Yaw, 0.0f));
+		Character->AddMovementInput(Character->GetActorForwardVector(), Frame.MoveInput.Y);
+		Character->AddMovementInput(Character->GetActorRightVector(), Frame.MoveInput.X);
+
+		if (Frame.IsHeld(RecordedButton_Jump) && !Character->bPressedJump)
+		{
+			Character->Jump();
+		}
+		else if (!Frame.IsHeld(RecordedButton_Jump) && Character->bPressedJump)
+		{
+			Character->StopJumping();
+		}
+		Character->SetSprinting(Frame.IsHeld(RecordedButton_Sprint));
+		Character->SetWantsToWalk(Frame.IsHeld(RecordedButton_Walk));
+
+		const double Start = FPlatformTime::Seconds();
+		World->Tick(LEVELTICK_All, Frame.DeltaTime);
+		WorldSeconds += FPlatformTime::Seconds() - Start;
+
+		const FVector3f Location(Character->GetActorLocation());
+		const float Divergence = FVector3f::Dist(Location, Frame.Location);
+		ExactFrames += Location == Frame.Location && FVector3f(Movement->Velocity) == Frame.Velocity ? 1 : 0;
+		if (Divergence > Tolerance && FirstDivergentFrame == INDEX_NONE)
+		{
+			FirstDivergentFrame = Frames;
+		}
+		MaxDivergence = FMath::Max(MaxDivergence, Divergence);
+		FinalDivergence = Divergence;
+		++Frames;
+	}
+
+	const FS_MovementCounters &Counters = Movement->GetMovementCounters();
+	const int32 Ticks = FMath::Max(1, Counters.Ticks);
+
+	UE_LOG(LogS_ReplayMovement, Display, TEXT("Replayed %d/%u frames of %s on %s"), Frames, Header.FrameCount, *RecordingFile, *MapName);
+	UE_LOG(LogS_ReplayMovement, Display, TEXT("  %d frames bit exact, max divergence %.4f cm, final divergence %.4f cm, first beyond %.2f cm at frame %d"),
+		   ExactFrames, MaxDivergence, FinalDivergence, Tolerance, FirstDivergentFrame);
+	UE_LOG(LogS_ReplayMovement, Display, TEXT("  world tick %.3f ms total | movement tick %.4f ms avg | CalcVelocity %.4f ms | PhysFalling %.4f ms | FindFloor %.4f ms"),
+		   WorldSeconds * 1000.0, Counters.TickSeconds * 1000.0 / Ticks, Counters.CalcVelocitySeconds * 1000.0 / Ticks, Counters.PhysFallingSeconds * 1000.0 / Ticks, Counters.FloorSeconds * 1000.0 / Ticks);
+	UE_LOG(LogS_ReplayMovement, Display, TEXT("  %d sweeps, %d floor finds, %d landing spot checks, %d/%d air catches"),
+		   Counters.Sweeps, Counters.FloorFinds, Counters.LandingSpotChecks, Counters.CatchAirs, Counters.CatchAirChecks);
+
+	if (CountersVar)
+	{
+		CountersVar->Set(PreviousCounters);
+	}
+	UnloadReplayWorld(World);
+
+	if (Frames != static_cast<int32>(Header.FrameCount))
+	{
+		UE_LOG(LogS_ReplayMovement, Error, TEXT("Recording is truncated"));
+		return 1;
+	}
+	return FirstDivergentFrame == INDEX_NONE ? 0 : 1;
+}
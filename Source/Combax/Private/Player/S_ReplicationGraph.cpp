@@ -0,0 +1,148 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Player/S_ReplicationGraph.h"
+#include "Player/S_Character.h"
+#include "CombaxProjectile.h"
+#include "Engine/NetConnection.h"
+#include "GameFramework/PlayerController.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+//~ ==== Fast movers node ===================================================================================== ~//
+
+US_ReplicationGraphNode_FastMovers::US_ReplicationGraphNode_FastMovers()
+{
+	bRequiresPrepareForReplicationCall = true;
+}
+
+void US_ReplicationGraphNode_FastMovers::NotifyAddNetworkActor(const FNewReplicatedActorInfo &ActorInfo)
+{
+	Movers.AddUnique(ActorInfo.Actor);
+}
+
+bool US_ReplicationGraphNode_FastMovers::NotifyRemoveNetworkActor(const FNewReplicatedActorInfo &ActorInfo, bool bWarnIfNotFound)
+{
+	return Movers.RemoveSingleSwap(ActorInfo.Actor) > 0;
+}
+
+void US_ReplicationGraphNode_FastMovers::NotifyResetAllNetworkActors()
+{
+	Movers.Reset();
+}
+
+void US_ReplicationGraphNode_FastMovers::GatherActorListsForConnection(const FConnectionGatherActorListParameters &Params)
+{
+}
+
+void US_ReplicationGraphNode_FastMovers::PrepareForReplication()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(US_ReplicationGraphNode_FastMovers::PrepareForReplication);
+
+	if (!Graph || !GraphGlobals.IsValid())
+	{
+		return;
+	}
+
+	//: Viewer of every connection, looked up once instead of once per mover
+	struct FViewer
+	{
+		UNetReplicationGraphConnection *Connection;
+		FVector Location;
+	};
+	TArray<FViewer, TInlineAllocator<64>> Viewers;
+	for (UNetReplicationGraphConnection *Connection : Graph->Connections)
+	{
+		const UNetConnection *NetConnection = Connection ? Connection->NetConnection : nullptr;
+		const AActor *ViewTarget = NetConnection ? NetConnection->ViewTarget : nullptr;
+		if (ViewTarget)
+		{
+			Viewers.Add({Connection, ViewTarget->GetActorLocation()});
+		}
+	}
+
+	const float NearSquared = FMath::Square(Graph->NearFrequencyDistance);
+	const float FarSquared = FMath::Square(Graph->FarFrequencyDistance);
+	const uint8 MidPeriod = uint8(FMath::Clamp(Graph->MidReplicationPeriod, 1, 255));
+	const uint8 FarPeriod = uint8(FMath::Clamp(Graph->FarReplicationPeriod, 1, 255));
+
+	FGlobalActorReplicationInfoMap &GlobalInfoMap = *GraphGlobals->GlobalActorReplicationInfoMap;
+	for (AActor *Mover : Movers)
+	{
+		//: How far it can get before the next few updates reach anyone
+		const FVector Location = Mover->GetActorLocation();
+		const float Speed = Mover->GetVelocity().Size();
+		const float CullDistance = FMath::Min(Graph->CharacterCullDistance + Speed * Graph->CullLeadTime, Graph->MaxCharacterCullDistance);
+		const float CullDistanceSquared = FMath::Square(CullDistance);
+
+		//: The grid spreads the actor over the cells this covers
+		GlobalInfoMap.Get(Mover).Settings.SetCullDistanceSquared(CullDistanceSquared);
+
+		for (const FViewer &Viewer : Viewers)
+		{
+			FConnectionReplicationActorInfo *ConnectionInfo = Viewer.Connection->ActorInfoMap.Find(Mover);
+			if (!ConnectionInfo)
+			{
+				continue;
+			}
+
+			const float DistanceSquared = FVector::DistSquared(Location, Viewer.Location);
+			ConnectionInfo->SetCullDistanceSquared(CullDistanceSquared);
+			ConnectionInfo->ReplicationPeriodFrame = DistanceSquared < NearSquared ? 1 : DistanceSquared < FarSquared ? MidPeriod : FarPeriod;
+		}
+	}
+}
+
+//~ ==== Graph ================================================================================================ ~//
+
+void US_ReplicationGraph::InitGlobalActorClassSettings()
+{
+	Super::InitGlobalActorClassSettings();
+
+	FClassReplicationInfo CharacterInfo;
+	CharacterInfo.ReplicationPeriodFrame = GetReplicationPeriodFrameForFrequency(GetDefault<AS_Character>()->NetUpdateFrequency);
+	CharacterInfo.SetCullDistanceSquared(FMath::Square(CharacterCullDistance));
+	GlobalActorReplicationInfoMap.SetClassInfo(AS_Character::StaticClass(), CharacterInfo);
+
+	FClassReplicationInfo ProjectileInfo;
+	ProjectileInfo.ReplicationPeriodFrame = GetReplicationPeriodFrameForFrequency(GetDefault<ACombaxProjectile>()->NetUpdateFrequency);
+	ProjectileInfo.SetCullDistanceSquared(FMath::Square(ProjectileCullDistance));
+	GlobalActorReplicationInfoMap.SetClassInfo(ACombaxProjectile::StaticClass(), ProjectileInfo);
+}
+
+void US_ReplicationGraph::InitGlobalGraphNodes()
+{
+	//: Nodes are prepared in the order they are added, and the grid places movers by the cull distances the fast
+	//: movers node sets, so it goes first. The grid and always relevant nodes are UBasicReplicationGraph's, set up
+	//: the way it does instead of through Super so they come after it.
+	FastMoversNode = CreateNewNode<US_ReplicationGraphNode_FastMovers>();
+	FastMoversNode->Graph = this;
+	AddGlobalGraphNode(FastMoversNode);
+
+	GridNode = CreateNewNode<UReplicationGraphNode_GridSpatialization2D>();
+	GridNode->CellSize = GridCellSize;
+	GridNode->SpatialBias = FVector2D(-UE_OLD_WORLD_MAX, -UE_OLD_WORLD_MAX);
+	AddGlobalGraphNode(GridNode);
+
+	AlwaysRelevantNode = CreateNewNode<UReplicationGraphNode_ActorList>();
+	AddGlobalGraphNode(AlwaysRelevantNode);
+}
+
+void US_ReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo &ActorInfo, FGlobalActorReplicationInfo &GlobalInfo)
+{
+	//: Characters and projectiles land in the grid here, dormancy aware
+	Super::RouteAddNetworkActorToNodes(ActorInfo, GlobalInfo);
+
+	if (ActorInfo.Actor->IsA<AS_Character>())
+	{
+		FastMoversNode->NotifyAddNetworkActor(ActorInfo);
+	}
+}
+
+void US_ReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo &ActorInfo)
+{
+	Super::RouteRemoveNetworkActorToNodes(ActorInfo);
+
+	if (ActorInfo.Actor->IsA<AS_Character>())
+	{
+		FastMoversNode->NotifyRemoveNetworkActor(ActorInfo);
+	}
+}
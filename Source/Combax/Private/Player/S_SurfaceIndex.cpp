@@ -0,0 +1,395 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Player/S_SurfaceIndex.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+#include "Engine/Level.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "PhysicsEngine/BodySetup.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogS_SurfaceIndex, Log, All);
+
+//: Roughly a few capsules across, so a lookup only looks at the handful of faces around the pawn
+static constexpr float CellSize = 512.0f;
+
+//: Faces bigger than this many cells are left to physics instead of bloating the grid
+static constexpr int32 MaxCellsPerFace = 4096;
+
+//: How far the surface point may be off the plane, covers the floor sweep's contact offset
+static constexpr float PlaneTolerance = 1.0f;
+
+//: Same threshold as FS_SourceSlidePolicy::VerticalSlopeNormalZ
+static constexpr float MinNormalZ = 0.001f;
+
+bool US_SurfaceIndex::ShouldCreateSubsystem(UObject *Outer) const
+{
+	const UWorld *World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld();
+}
+
+void US_SurfaceIndex::OnWorldBeginPlay(UWorld &InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &US_SurfaceIndex::OnLevelAdded);
+	LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &US_SurfaceIndex::OnLevelRemoved);
+
+	Build();
+}
+
+void US_SurfaceIndex::Deinitialize()
+{
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+	FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+
+	Levels.Empty();
+	Cells.Empty();
+
+	Super::Deinitialize();
+}
+
+void US_SurfaceIndex::OnLevelAdded(ULevel *Level, UWorld *InWorld)
+{
+	if (Level && InWorld == GetWorld())
+	{
+		AddLevel(Level);
+	}
+}
+
+void US_SurfaceIndex::OnLevelRemoved(ULevel *Level, UWorld *InWorld)
+{
+	if (InWorld != GetWorld())
+	{
+		return;
+	}
+
+	//: No level means the whole world is going away
+	if (Level)
+	{
+		RemoveLevel(Level);
+	}
+	else
+	{
+		Levels.Empty();
+		Cells.Empty();
+	}
+}
+
+FIntPoint US_SurfaceIndex::GetCell(double X, double Y) const
+{
+	return FIntPoint(FMath::FloorToInt32(X / CellSize), FMath::FloorToInt32(Y / CellSize));
+}
+
+void US_SurfaceIndex::Build()
+{
+	Levels.Empty();
+	Cells.Empty();
+
+	const UWorld *World = GetWorld();
+	if (!World)
+	{
+		return;
+	}
+
+	for (ULevel *Level : World->GetLevels())
+	{
+		if (Level && Level->bIsVisible)
+		{
+			AddLevel(Level);
+		}
+	}
+}
+
+void US_SurfaceIndex::AddLevel(ULevel *Level)
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	RemoveLevel(Level);
+
+	const int32 LevelIndex = Levels.Add(FLevelSurfaces());
+	FLevelSurfaces &Surfaces = Levels[LevelIndex];
+	Surfaces.Level = Level;
+
+	for (AActor *Actor : Level->Actors)
+	{
+		if (IsValid(Actor))
+		{
+			Actor->ForEachComponent<UPrimitiveComponent>(false, [this, &Surfaces](UPrimitiveComponent *Component)
+														 { AddComponent(Surfaces, Component); });
+		}
+	}
+
+	//: Remember the cells as well, so removing the level only touches the cells it is in
+	TSet<FIntPoint> LevelCells;
+	int32 SkippedFaces = 0;
+	for (int32 FaceIndex = 0; FaceIndex < Surfaces.Faces.Num(); ++FaceIndex)
+	{
+		const FS_SurfaceFace &Face = Surfaces.Faces[FaceIndex];
+		FVector Min = Face.Vertices[0];
+		FVector Max = Face.Vertices[0];
+		for (int32 Vertex = 1; Vertex < Face.NumVertices; ++Vertex)
+		{
+			Min = Min.ComponentMin(Face.Vertices[Vertex]);
+			Max = Max.ComponentMax(Face.Vertices[Vertex]);
+		}
+
+		const FIntPoint MinCell = GetCell(Min.X, Min.Y);
+		const FIntPoint MaxCell = GetCell(Max.X, Max.Y);
+		if (int64(MaxCell.X - MinCell.X + 1) * (MaxCell.Y - MinCell.Y + 1) > MaxCellsPerFace)
+		{
+			++SkippedFaces;
+			continue;
+		}
+
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+			{
+				const FIntPoint Cell(X, Y);
+				Cells.FindOrAdd(Cell).Add({LevelIndex, FaceIndex});
+				LevelCells.Add(Cell);
+			}
+		}
+	}
+	Surfaces.Cells = LevelCells.Array();
+
+	UE_LOG(LogS_SurfaceIndex, Log, TEXT("Indexed %d surfaces of %d components in %s into %d cells in %.2f ms, %d too large to index"),
+		   Surfaces.Faces.Num(), Surfaces.NumComponents, *GetNameSafe(Level->GetOuter()), Surfaces.Cells.Num(), (FPlatformTime::Seconds() - StartTime) * 1000.0, SkippedFaces);
+}
+
+void US_SurfaceIndex::RemoveLevel(const ULevel *Level)
+{
+	for (auto It = Levels.CreateIterator(); It; ++It)
+	{
+		if (It->Level != Level)
+		{
+			continue;
+		}
+
+		const int32 LevelIndex = It.GetIndex();
+		for (const FIntPoint &CellKey : It->Cells)
+		{
+			TArray<FFaceRef> *Cell = Cells.Find(CellKey);
+			if (!Cell)
+			{
+				continue;
+			}
+			Cell->RemoveAllSwap([LevelIndex](const FFaceRef &Ref)
+								{ return Ref.Level == LevelIndex; });
+			if (Cell->Num() == 0)
+			{
+				Cells.Remove(CellKey);
+			}
+		}
+		It.RemoveCurrent();
+		return;
+	}
+}
+
+void US_SurfaceIndex::AddComponent(FLevelSurfaces &Surfaces, UPrimitiveComponent *Component)
+{
+	if (!Component->IsRegistered() || Component->Mobility != EComponentMobility::Static || !Component->IsQueryCollisionEnabled())
+	{
+		return;
+	}
+	//: Characters are pawns, anything they don't block isn't a floor
+	if (Component->GetCollisionResponseToChannel(ECC_Pawn) != ECR_Block)
+	{
+		return;
+	}
+	if (Component->GetWalkableSlopeOverride().GetWalkableSlopeBehavior() != WalkableSlope_Default)
+	{
+		return;
+	}
+
+	//: Floor sweeps run against simple collision, so that's what the index has to match
+	const UBodySetup *BodySetup = Component->GetBodySetup();
+	if (!BodySetup || BodySetup->GetCollisionTraceFlag() == CTF_UseComplexAsSimple)
+	{
+		return;
+	}
+
+	const FKAggregateGeom &AggGeom = BodySetup->AggGeom;
+	if (AggGeom.BoxElems.Num() == 0 && AggGeom.ConvexElems.Num() == 0)
+	{
+		return;
+	}
+
+	++Surfaces.NumComponents;
+	const FTransform &ComponentTransform = Component->GetComponentTransform();
+
+	for (const FKBoxElem &Box : AggGeom.BoxElems)
+	{
+		const FTransform ElemTransform = Box.GetTransform();
+		const FVector Extent(Box.X * 0.5f, Box.Y * 0.5f, Box.Z * 0.5f);
+
+		FVector Corners[8];
+		for (int32 Corner = 0; Corner < 8; ++Corner)
+		{
+			const FVector Local((Corner & 1) ? Extent.X : -Extent.X, (Corner & 2) ? Extent.Y : -Extent.Y, (Corner & 4) ? Extent.Z : -Extent.Z);
+			Corners[Corner] = ComponentTransform.TransformPosition(ElemTransform.TransformPosition(Local));
+		}
+		const FVector Inside = ComponentTransform.TransformPosition(ElemTransform.GetLocation());
+
+		//: Corners of each face in winding order, normals are pointed away from Inside anyway. Kept as quads so a
+		//: capsule standing across a face's diagonal is still inside one face.
+		static const int32 Faces[6][4] = {{0, 2, 6, 4}, {1, 3, 7, 5}, {0, 1, 5, 4}, {2, 3, 7, 6}, {0, 1, 3, 2}, {4, 5, 7, 6}};
+		for (const int32(&Face)[4] : Faces)
+		{
+			const FVector Quad[4] = {Corners[Face[0]], Corners[Face[1]], Corners[Face[2]], Corners[Face[3]]};
+			AddFace(Surfaces, Quad, Inside, Component);
+		}
+	}
+
+	TArray<FVector> Vertices;
+	for (const FKConvexElem &Convex : AggGeom.ConvexElems)
+	{
+		if (Convex.VertexData.Num() < 4 || Convex.IndexData.Num() < 3)
+		{
+			continue;
+		}
+
+		const FTransform ElemTransform = Convex.GetTransform();
+		Vertices.Reset(Convex.VertexData.Num());
+		FVector Inside = FVector::ZeroVector;
+		for (const FVector &Vertex : Convex.VertexData)
+		{
+			Inside += Vertices.Add_GetRef(ComponentTransform.TransformPosition(ElemTransform.TransformPosition(Vertex)));
+		}
+		Inside /= Vertices.Num();
+
+		for (int32 Index = 0; Index + 2 < Convex.IndexData.Num(); Index += 3)
+		{
+			const FVector Triangle[3] = {Vertices[Convex.IndexData[Index]], Vertices[Convex.IndexData[Index + 1]], Vertices[Convex.IndexData[Index + 2]]};
+			AddFace(Surfaces, Triangle, Inside, Component);
+		}
+	}
+}
+
+void US_SurfaceIndex::AddFace(FLevelSurfaces &Surfaces, TArrayView<const FVector> Vertices, const FVector &Inside, const UPrimitiveComponent *Component)
+{
+	check(Vertices.Num() >= 3 && Vertices.Num() <= FS_SurfaceFace::MaxVertices);
+
+	FVector Normal = (Vertices[1] - Vertices[0]) ^ (Vertices[2] - Vertices[0]);
+	const double DoubleArea = Normal.Size();
+	if (DoubleArea < 1.0)
+	{
+		return;
+	}
+	Normal /= DoubleArea;
+	if ((Normal | (Vertices[0] - Inside)) < 0.0)
+	{
+		Normal = -Normal;
+	}
+
+	//: Walls and ceilings can't be landed on
+	if (Normal.Z <= MinNormalZ)
+	{
+		return;
+	}
+
+	FS_SurfaceFace &Face = Surfaces.Faces.AddDefaulted_GetRef();
+	for (int32 Vertex = 0; Vertex < Vertices.Num(); ++Vertex)
+	{
+		Face.Vertices[Vertex] = Vertices[Vertex];
+	}
+	Face.NumVertices = Vertices.Num();
+	Face.Normal = Normal;
+	Face.Component = Component;
+}
+
+//~ Whether the circle lies entirely inside the convex face, looking straight down
+static bool ContainsCircle2D(const FS_SurfaceFace &Face, double X, double Y, double Radius)
+{
+	//: Upward facing, so the winding seen from above is counter-clockwise when the normal is +Z
+	const FVector &A = Face.Vertices[0];
+	const double Winding = (((Face.Vertices[1] - A) ^ (Face.Vertices[2] - A)).Z) > 0.0 ? 1.0 : -1.0;
+
+	for (int32 Edge = 0; Edge < Face.NumVertices; ++Edge)
+	{
+		const FVector &P = Face.Vertices[Edge];
+		const FVector &Q = Face.Vertices[Edge + 1 < Face.NumVertices ? Edge + 1 : 0];
+		const double EdgeX = Q.X - P.X;
+		const double EdgeY = Q.Y - P.Y;
+		const double Length = FMath::Sqrt(EdgeX * EdgeX + EdgeY * EdgeY);
+		if (Length < KINDA_SMALL_NUMBER)
+		{
+			return false;
+		}
+
+		//: Signed distance from the edge, positive on the inside
+		const double Distance = Winding * (EdgeX * (Y - P.Y) - EdgeY * (X - P.X)) / Length;
+		if (Distance < Radius)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+const FS_SurfaceFace *US_SurfaceIndex::FindFace(const UPrimitiveComponent *Component, const FVector &SurfacePoint, const FVector &Center, float Radius) const
+{
+	const TArray<FFaceRef> *Cell = Cells.Find(GetCell(Center.X, Center.Y));
+	if (!Cell)
+	{
+		return nullptr;
+	}
+
+	for (const FFaceRef &Ref : *Cell)
+	{
+		const FS_SurfaceFace &Face = Levels[Ref.Level].Faces[Ref.Face];
+		if (Face.Component != Component)
+		{
+			continue;
+		}
+		if (FMath::Abs((SurfacePoint - Face.Vertices[0]) | Face.Normal) > PlaneTolerance)
+		{
+			continue;
+		}
+		if (ContainsCircle2D(Face, Center.X, Center.Y, Radius))
+		{
+			return &Face;
+		}
+	}
+	return nullptr;
+}
+
+int32 US_SurfaceIndex::NumFaces() const
+{
+	int32 Faces = 0;
+	for (const FLevelSurfaces &Surfaces : Levels)
+	{
+		Faces += Surfaces.Faces.Num();
+	}
+	return Faces;
+}
+
+SIZE_T US_SurfaceIndex::GetAllocatedSize() const
+{
+	SIZE_T Size = Levels.GetAllocatedSize() + Cells.GetAllocatedSize();
+	for (const FLevelSurfaces &Surfaces : Levels)
+	{
+		Size += Surfaces.Faces.GetAllocatedSize() + Surfaces.Cells.GetAllocatedSize();
+	}
+	for (const TPair<FIntPoint, TArray<FFaceRef>> &Cell : Cells)
+	{
+		Size += Cell.Value.GetAllocatedSize();
+	}
+	return Size;
+}
+
+static void DumpSurfaceIndex(const TArray<FString> &Args, UWorld *World)
+{
+	const US_SurfaceIndex *Index = World ? World->GetSubsystem<US_SurfaceIndex>() : nullptr;
+	if (!Index)
+	{
+		return;
+	}
+	UE_LOG(LogS_SurfaceIndex, Display, TEXT("%d surfaces of %d levels in %d cells, %.1f KB"), Index->NumFaces(), Index->NumLevels(), Index->NumCells(), Index->GetAllocatedSize() / 1024.0);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs DumpSurfaceIndexCommand(
+	TEXT("sv.surfaceindex.dump"),
+	TEXT("Log the size of the surface index. Lookup hit rates are in sv.movement.dump."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&DumpSurfaceIndex));
@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/PlayerController.h"
+#include "S_BotController.generated.h"
+
+class AS_Character;
+
+/**
+ * Player controller of a headless bot client. AS_GameMode gives it to connections that log in with ?Bot, and the
+ * owning client drives its pawn with scripted Source style movement: strafe jumping with the view swept side to side,
+ * auto bunnyhopping, sprinting on and off and firing whatever weapon the pawn holds. Input goes through the same
+ * character and movement component paths as a real player's, so the server sees ordinary client moves.
+ */
+UCLASS(config = Game)
+class COMBAX_API AS_BotController : public APlayerController
+{
+	GENERATED_BODY()
+
+public:
+	AS_BotController();
+
+	virtual void PlayerTick(float DeltaTime) override;
+
+protected:
+	virtual void OnPossess(APawn *InPawn) override;
+
+	//? Degrees the view swings either side of the heading while strafe jumping
+	UPROPERTY(EditDefaultsOnly, Category = "Bot")
+	float StrafeSweepAngle;
+
+	//? Full side to side swings per second
+	UPROPERTY(EditDefaultsOnly, Category = "Bot")
+	float StrafeSweepRate;
+
+	//? Seconds between picking a new heading
+	UPROPERTY(EditDefaultsOnly, Category = "Bot")
+	float HeadingInterval;
+
+	//? Seconds of sprinting, then the same again of running
+	UPROPERTY(EditDefaultsOnly, Category = "Bot")
+	float SprintInterval;
+
+	//? Seconds between shots, 0 never fires
+	UPROPERTY(EditDefaultsOnly, Category = "Bot")
+	float FireInterval;
+
+	//? Ground speed below which a bot that is trying to move counts as stuck and turns around
+	UPROPERTY(EditDefaultsOnly, Category = "Bot")
+	float StuckSpeed;
+
+private:
+	//~ Set up a newly possessed pawn the way the bot plays, on whichever side owns it
+	void SetupPawn(AS_Character *Character);
+
+	void DrivePawn(AS_Character *Character, float DeltaTime);
+
+	//~ Fire the weapon held by Character, if it has one
+	void FireWeapon(AS_Character *Character);
+
+	TWeakObjectPtr<AS_Character> DrivenCharacter;
+
+	FRandomStream Random;
+	float Time = 0.0f;
+	float Heading = 0.0f;
+	float NextHeadingTime = 0.0f;
+	float NextFireTime = 0.0f;
+	float StuckTime = 0.0f;
+};
@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformProcess.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "S_BotLauncher.generated.h"
+
+class US_CharacterMovement;
+
+/**
+ * Load testing for servers. Launches headless bot clients of this build as separate processes, connected to this
+ * server with ?Bot so they get an AS_BotController, and while any are running writes a CSV of server frame and game
+ * thread time, net driver bandwidth and the share of client moves that had to be corrected.
+ *
+ * Started from the console with sv.bots.add, or for unattended runs from the server's command line with
+ * -CombaxBots=<count> and optionally -CombaxBotSeconds=<seconds>, after which the server exits.
+ */
+UCLASS()
+class COMBAX_API US_BotLauncher : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject *Outer) const override;
+	virtual void OnWorldBeginPlay(UWorld &InWorld) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	//~ Launch Count more bot clients against this server
+	void AddBots(int32 Count);
+
+	//~ Close every bot client this server launched and finish the metrics file
+	void RemoveAllBots();
+
+	int32 NumBots() const
+	{
+		return BotProcesses.Num();
+	}
+
+private:
+	void StartMetrics();
+	void StopMetrics();
+
+	//~ Append one row covering everything since the last one
+	void WriteSample();
+
+	TArray<FProcHandle> BotProcesses;
+	int32 BotsLaunched = 0;
+
+	//: Exit once this many seconds of metrics are written, 0 runs until the bots are removed
+	float RunSeconds = 0.0f;
+
+	FString MetricsFilename;
+	bool bWritingMetrics = false;
+	double MetricsSeconds = 0.0;
+
+	//: Accumulated over the frames since the last sample
+	double SampleSeconds = 0.0;
+	int32 SampleFrames = 0;
+	double SampleGameThreadMs = 0.0;
+	double SampleMaxFrameMs = 0.0;
+	double SampleMaxGameThreadMs = 0.0;
+
+	//: Move counts of each mover at the last sample, its counters may be reset by other tools in between
+	TMap<TWeakObjectPtr<US_CharacterMovement>, FIntVector> LastMoveCounts;
+};
@@ -0,0 +1,30 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Camera/CameraModifier.h"
+#include "S_CameraRollModifier.generated.h"
+
+/**
+ * Rolls the view into sideways movement, Source style. Added to the camera manager of local players only, so it runs
+ * once per rendered frame and never touches the control rotation. The roll target comes from the view target's
+ * US_CharacterMovement and is eased towards, so it stays smooth at any frame and movement tick rate.
+ */
+UCLASS()
+class COMBAX_API US_CameraRollModifier : public UCameraModifier
+{
+	GENERATED_BODY()
+
+public:
+	US_CameraRollModifier();
+
+	virtual bool ModifyCamera(float DeltaTime, FMinimalViewInfo &InOutPOV) override;
+
+	//? How quickly the roll catches up with its target, 0 snaps straight to it
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera Roll", meta = (ClampMin = "0", UIMin = "0"))
+	float RollInterpSpeed = 12.0f;
+
+private:
+	float CurrentRoll;
+};
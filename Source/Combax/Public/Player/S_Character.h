@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "InputActionValue.h"
+#include "Player/S_RepMovement.h"
 #include "S_Character.generated.h"
 
 class UInputComponent;
@@ -14,6 +15,7 @@ class UCameraComponent;
 class UAnimMontage;
 class USoundBase;
 class US_CharacterMovement;
+class US_MovementProfile;
 
 inline float SimpleSpline(float Value)
 {
@@ -47,6 +49,12 @@ public:
 
 	void Move(const FInputActionValue &Value);
 	void Look(const FInputActionValue &Value);
+
+	//~ Move action value applied this frame, zero if the action didn't trigger
+	FVector2D GetMoveInput() const
+	{
+		return MoveInputFrame == GFrameCounter ? MoveInput : FVector2D::ZeroVector;
+	}
 	// void Jump() override;
 	// virtual void ClearJumpInput(float DeltaTime) override;
 	// virtual void StopJumping() override;
@@ -56,6 +64,30 @@ public:
 
 	void RecalculateBaseEyeHeight() override;
 
+	//~ Adds the camera roll modifier once we are possessed by a local player
+	virtual void PawnClientRestart() override;
+
+	//~ Orders the movement manager's batch gather after the new controller's tick, which adds the input it reads
+	virtual void PossessedBy(AController *NewController) override;
+	virtual void UnPossessed() override;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty> &OutLifetimeProps) const override;
+
+	//~ Quantizes the movement gathered by AActor for simulated proxies
+	virtual void PreReplication(IRepChangedPropertyTracker &ChangedPropertyTracker) override;
+
+	//~ Switch movement to Profile on the server and every client, without respawning
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Player Movement")
+	void SetMovementProfile(US_MovementProfile *Profile);
+
+	US_MovementProfile *GetMovementProfile() const
+	{
+		return MovementProfile;
+	}
+
+	//~ Shift the camera and meshes by a world space offset from the capsule, used to draw fixed timestep movement in between steps
+	void SetMovementRenderOffset(const FVector &Offset);
+
 	float GetLastJumpTime()
 	{
 		return LastJumpTime;
@@ -89,8 +121,29 @@ private:
 
 	bool bIsSprinting;
 	bool bWantsToWalk;
+
+	//? Sent to simulated proxies in place of AActor::ReplicatedMovement
+	UPROPERTY(ReplicatedUsing = OnRep_S_ReplicatedMovement)
+	FS_RepMovement S_ReplicatedMovement;
+
+	UFUNCTION()
+	void OnRep_S_ReplicatedMovement();
+
+	//? Movement tunables of this pawn on the server and every client, the only place the profile is set. Null runs the HL2 defaults, or whatever the movement component migrated from its old tunables.
+	UPROPERTY(EditAnywhere, ReplicatedUsing = OnRep_MovementProfile, meta = (AllowPrivateAccess = "true"), Category = "PB Player|Movement")
+	US_MovementProfile *MovementProfile;
+
+	UFUNCTION()
+	void OnRep_MovementProfile();
 	bool bDeferJumpStop;
 
+	FVector DefaultCameraRelativeLocation;
+	bool bHasMovementRenderOffset;
+
+	//: Last Move action value and the frame it was triggered on, for recording
+	FVector2D MoveInput;
+	uint64 MoveInputFrame;
+
 public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
 	class UInputAction *LookAction;
@@ -116,6 +169,16 @@ public:
 	{
 		return bWantsToWalk;
 	}
+	UFUNCTION(Category = "PB Setters", BlueprintCallable)
+	void SetSprinting(bool val)
+	{
+		bIsSprinting = val;
+	};
+	UFUNCTION(Category = "PB Setters", BlueprintCallable)
+	void SetWantsToWalk(bool val)
+	{
+		bWantsToWalk = val;
+	};
 	UFUNCTION(Category = "PB Getters", BlueprintPure)
 	FORCEINLINE float GetBaseTurnRate() const
 	{
@@ -5,8 +5,90 @@
 #include "CoreMinimal.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Runtime/Launch/Resources/Version.h"
+#include "Player/S_MoveKernel.h"
+#include "Player/S_MovementHistory.h"
+#include "Player/S_MovementPolicy.h"
+#include "Player/S_MovementProfile.h"
+#include "Player/S_MovementRecording.h"
+#include "Player/S_MovementStats.h"
 #include "S_CharacterMovement.generated.h"
 
+class UCurveFloat;
+class UPhysicalMaterial;
+class US_CharacterMovement;
+class US_SurfaceIndex;
+
+//? Landing or takeoff handed to OnMovementTransition listeners. The floor sweep behind GetFloorHit only runs if a listener asks for it.
+struct COMBAX_API FS_MovementTransition
+{
+	FS_MovementTransition(US_CharacterMovement *InMovement, EMovementMode InPreviousMovementMode, const FVector &InImpactVelocity);
+
+	US_CharacterMovement *Movement;
+	EMovementMode PreviousMovementMode;
+	EMovementMode MovementMode;
+
+	//? Velocity before the new mode touched it, so landings still carry their fall speed
+	FVector ImpactVelocity;
+
+	//? Left the ground by walking into a fall
+	bool bJumped;
+
+	bool IsLanding() const
+	{
+		return PreviousMovementMode == MOVE_Falling && MovementMode == MOVE_Walking;
+	}
+
+	//~ Downwards speed at the moment of the transition
+	float GetImpactSpeed() const
+	{
+		return FMath::Max(0.0f, -ImpactVelocity.Z);
+	}
+
+	//~ Complex floor sweep with physical material, traced on first use
+	const FHitResult &GetFloorHit() const;
+
+	float GetSurfaceFriction() const;
+
+private:
+	mutable TOptional<FHitResult> FloorHit;
+};
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FS_OnMovementTransition, const FS_MovementTransition &);
+
+//? Saved move carrying the sprint, walk and autobunnyhop state in the compressed flags
+class COMBAX_API FSavedMove_S_Character : public FSavedMove_Character
+{
+public:
+	typedef FSavedMove_Character Super;
+
+	enum ECompressedFlags : uint8
+	{
+		FLAG_Sprinting = FLAG_Custom_0,
+		FLAG_WantsToWalk = FLAG_Custom_1,
+		FLAG_AutoBunnyhop = FLAG_Custom_2,
+	};
+
+	uint8 bSavedSprinting : 1;
+	uint8 bSavedWantsToWalk : 1;
+	uint8 bSavedAutoBunnyhop : 1;
+
+	virtual void Clear() override;
+	virtual uint8 GetCompressedFlags() const override;
+	virtual bool CanCombineWith(const FSavedMovePtr &NewMove, ACharacter *InCharacter, float MaxDelta) const override;
+	virtual void SetMoveFor(ACharacter *C, float InDeltaTime, FVector const &NewAccel, FNetworkPredictionData_Client_Character &ClientData) override;
+	virtual void PrepMoveFor(ACharacter *C) override;
+};
+
+class COMBAX_API FNetworkPredictionData_Client_S_Character : public FNetworkPredictionData_Client_Character
+{
+public:
+	typedef FNetworkPredictionData_Client_Character Super;
+
+	FNetworkPredictionData_Client_S_Character(const UCharacterMovementComponent &ClientMovement);
+
+	virtual FSavedMovePtr AllocateNewMove() override;
+};
+
 UCLASS()
 class COMBAX_API US_CharacterMovement : public UCharacterMovementComponent
 {
@@ -18,44 +100,60 @@ protected:
 	//? If we are stepping left, else, right
 	bool StepSide;
 
-	//? The multiplier for acceleration when on ground.
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Walking")
-	float GroundAccelerationMultiplier;
+	//? If the player has already landed for a frame, and breaking may be applied.
+	bool bBrakingFrameTolerated;
 
-	//? The multiplier for acceleration when in air.
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Walking")
-	float AirAccelerationMultiplier;
+	//? Maps speed between the profile's SpeedMultMin and SpeedMultMax, as 0 to 1, to how far step height and walkable floor are scaled down. Unset squares the speed.
+	UPROPERTY(Category = "Character Movement: Walking", EditAnywhere, BlueprintReadWrite)
+	UCurveFloat *StepScaleCurve;
 
-	//? The vector differential magnitude cap when in air.
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Jumping / Falling")
-	float AirSpeedCap;
+	//? The owning AS_Character's replicated profile, only ever set from it. Null runs MigratedProfile if there is one,
+	//? otherwise the HL2 defaults.
+	UPROPERTY(Transient)
+	US_MovementProfile *MovementProfile;
 
-	//? the minimum step height from moving fast
-	UPROPERTY(Category = "Character Movement: Walking", EditAnywhere, BlueprintReadWrite)
-	float MinStepHeight;
+	//? Tunables this component or its blueprint set before they moved into movement profiles, used while the pawn has
+	//? no profile of its own. Built from the deprecated properties below by MigrateDeprecatedSettings.
+	UPROPERTY(Transient)
+	US_MovementProfile *MigratedProfile;
 
-	//? If the player has already landed for a frame, and breaking may be applied.
-	bool bBrakingFrameTolerated;
+	//: Tunables that moved into FS_MovementProfileSettings, still loaded so old overrides carry over. Renamed by the
+	//: CoreRedirects in DefaultEngine.ini.
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Set in a movement profile on the pawn"))
+	float GroundAccelerationMultiplier_DEPRECATED;
 
-	//? The target ground speed when running.
-	UPROPERTY(Category = "Character Movement: Walking", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0", UIMin = "0"))
-	float RunSpeed;
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Set in a movement profile on the pawn"))
+	float AirAccelerationMultiplier_DEPRECATED;
 
-	//? The target ground speed when sprinting.
-	UPROPERTY(Category = "Character Movement: Walking", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0", UIMin = "0"))
-	float SprintSpeed;
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Set in a movement profile on the pawn"))
+	float AirSpeedCap_DEPRECATED;
 
-	//? The target ground speed when walking slowly.
-	UPROPERTY(Category = "Character Movement: Walking", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0", UIMin = "0"))
-	float WalkSpeed;
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Set in a movement profile on the pawn"))
+	float MinStepHeight_DEPRECATED;
 
-	//? The minimum speed to scale up from for slope movement
-	UPROPERTY(Category = "Character Movement: Walking", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0", UIMin = "0"))
-	float SpeedMultMin;
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Set in a movement profile on the pawn"))
+	float WalkSpeed_DEPRECATED;
 
-	//? The maximum speed to scale up to for slope movement
-	UPROPERTY(Category = "Character Movement: Walking", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0", UIMin = "0"))
-	float SpeedMultMax;
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Set in a movement profile on the pawn"))
+	float RunSpeed_DEPRECATED;
+
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Set in a movement profile on the pawn"))
+	float SprintSpeed_DEPRECATED;
+
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Set in a movement profile on the pawn"))
+	float SpeedMultMin_DEPRECATED;
+
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Set in a movement profile on the pawn"))
+	float SpeedMultMax_DEPRECATED;
+
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Set in a movement profile on the pawn"))
+	float AxisSpeedLimit_DEPRECATED;
+
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Set in a movement profile on the pawn"))
+	float BounceMultiplier_DEPRECATED;
+
+	UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Set in a movement profile on the pawn"))
+	ES_SlidePolicy SlidePolicy_DEPRECATED;
 
 	//? The maximum angle we can roll for camera adjust
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement (General Settings)")
@@ -65,26 +163,89 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement (General Settings)")
 	float RollSpeed = 0.0f;
 
-	//? Speed of rolling the camera
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement (General Settings)")
-	float BounceMultiplier = 0.0f;
-
-	UPROPERTY(Category = "Character Movement: Walking", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0", UIMin = "0"))
-	float AxisSpeedLimit = 6667.5f;
-
 	//? Threshold relating to speed ratio and friction which causes us to catch air
 	UPROPERTY(Category = "Character Movement: Walking", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0", UIMin = "0"))
 	float SlideLimit = 0.5f;
 
+	//? Compute ground braking in one step instead of subdividing it by BrakingSubStepTime. Matches the substeps within
+	//? FSourceMoveKernel::GetClosedFormBrakingTolerance, checked by the Combax.Movement.ClosedFormBraking test.
+	UPROPERTY(Category = "Character Movement: Walking", EditAnywhere, BlueprintReadWrite)
+	bool bClosedFormBraking = false;
+
 	//? Fraction of uncrouch half-height to check for before doing starting an uncrouch.
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement (General Settings)")
 	float GroundUncrouchCheckFactor = 0.75f;
 
+	//? Moves whose input hasn't changed since the last acknowledged one are sent this many times less often, so more of them combine.
+	//? Off at 1, anything above adds up to that many send intervals of latency to the held moves.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement (Networking)", meta = (ClampMin = "1", UIMin = "1", UIMax = "4"))
+	float IdenticalMoveSendDeltaScale = 1.0f;
+
+	//? Round velocity to the precision it is sent at after the moves of a remotely controlled pawn, on its owning client
+	//? and on the server, so replayed moves start from the state the server saw. Other pawns keep full precision.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement (Networking)")
+	bool bQuantizeMoveVelocity = true;
+
+	//? Client position error the server takes the client's word for, per unit of speed, on top of the engine's fixed allowance
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement (Networking)", meta = (ClampMin = "0", UIMin = "0", UIMax = "0.02"))
+	float ClientErrorPerSpeed = 0.004f;
+
+	//? Most position error ClientErrorPerSpeed can excuse, however fast the pawn goes
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement (Networking)", meta = (ClampMin = "0", UIMin = "0"))
+	float MaxClientErrorTolerance = 16.0f;
+
+	//? Corrections the server sends this connection per second, on average
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement (Networking)", meta = (ClampMin = "0.1", UIMin = "0.1", UIMax = "30"))
+	float CorrectionsPerSecond = 4.0f;
+
+	//? Corrections that can go out back to back before CorrectionsPerSecond applies
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement (Networking)", meta = (ClampMin = "1", UIMin = "1", UIMax = "16"))
+	float CorrectionBurst = 4.0f;
+
+	//? Errors up to this size wait for the correction budget while the server keeps its own position, larger ones are corrected right away
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement (Networking)", meta = (ClampMin = "0", UIMin = "0"))
+	float MaxDeferredCorrectionError = 64.0f;
+
+	//? Integrate locally controlled movement in fixed steps of 1 / FixedTickRate, like a Source tickrate, so the outcome doesn't depend on frame rate
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement (General Settings)")
+	bool bUseFixedTimestep = false;
+
+	//? Steps per second in fixed timestep mode
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement (General Settings)", meta = (ClampMin = "10", UIMin = "10", UIMax = "300", EditCondition = "bUseFixedTimestep"))
+	float FixedTickRate = 66.0f;
+
+	//? Time beyond this many steps in a single frame is dropped instead of spiralling
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement (General Settings)", meta = (ClampMin = "1", UIMin = "1", EditCondition = "bUseFixedTimestep"))
+	int32 MaxFixedStepsPerFrame = 8;
+
+	//? Simulated proxies further than this from the local view drop to the reduced movement LOD
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement (Networking)", meta = (ClampMin = "0", UIMin = "0"))
+	float ReducedLODDistance = 2500.0f;
+
+	//? Simulated proxies further than this from the local view drop to the minimal movement LOD
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement (Networking)", meta = (ClampMin = "0", UIMin = "0"))
+	float MinimalLODDistance = 6000.0f;
+
+	//? Simulated proxies that haven't been rendered for this many seconds drop one movement LOD further
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement (Networking)", meta = (ClampMin = "0", UIMin = "0"))
+	float OffscreenLODDelay = 0.5f;
+
+	//? Simulation steps per second of simulated proxies at the reduced LOD. Smoothing still runs every frame.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement (Networking)", meta = (ClampMin = "1", UIMin = "1", UIMax = "60"))
+	float ReducedLODTickRate = 30.0f;
+
+	//? Simulation steps per second of simulated proxies at the minimal LOD. Smoothing still runs every frame.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement (Networking)", meta = (ClampMin = "1", UIMin = "1", UIMax = "60"))
+	float MinimalLODTickRate = 10.0f;
+
 public:
 	US_CharacterMovement();
 
+	virtual void PostLoad() override;
 	virtual void InitializeComponent() override;
 	void OnRegister() override;
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	//? Overrides for Source-like movement
 	void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction) override;
@@ -99,25 +260,41 @@ public:
 
 	void UpdateSurfaceFriction(bool bIsSliding = false);
 
+	//~ Forget the cached floor friction, eg after changing a floor's physical material at runtime
+	void InvalidateFloorFrictionCache();
+
 	//? Jump overrides
 	bool CanAttemptJump() const override;
 	bool DoJump(bool bClientSimulation) override;
 
-	void TwoWallAdjust(FVector &OutDelta, const FHitResult &Hit, const FVector &OldHitNormal) const override;
-	float SlideAlongSurface(const FVector &Delta, float Time, const FVector &Normal, FHitResult &Hit, bool bHandleImpact = false) override;
 	FVector ComputeSlideVector(const FVector &Delta, const float Time, const FVector &Normal, const FHitResult &Hit) const override;
 	FVector HandleSlopeBoosting(const FVector &SlideResult, const FVector &Delta, const float Time, const FVector &Normal, const FHitResult &Hit) const override;
 	bool ShouldCatchAir(const FFindFloorResult &OldFloor, const FFindFloorResult &NewFloor) override;
-	bool IsWithinEdgeTolerance(const FVector &CapsuleLocation, const FVector &TestImpactPoint, const float CapsuleRadius) const override;
 	bool IsValidLandingSpot(const FVector &CapsuleLocation, const FHitResult &Hit) const override;
 	bool ShouldCheckForValidLandingSpot(float DeltaTime, const FVector &Delta, const FHitResult &Hit) const override;
 
 	void TraceCharacterFloor(FHitResult &OutHit);
 
+	virtual void FindFloor(const FVector &CapsuleLocation, FFindFloorResult &OutFloorResult, bool bCanUseCachedLocation, const FHitResult *DownwardSweepResult = nullptr) const override;
+
+	//~ Calls, sweeps and (with sv.movement.counters) time spent since the last reset
+	const FS_MovementCounters &GetMovementCounters() const
+	{
+		return MovementCounters;
+	}
+
+	void ResetMovementCounters()
+	{
+		MovementCounters.Reset();
+	}
+
 	virtual void OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode);
 
-	//~ Do camera roll effect based on velocity
-	float GetCameraRoll();
+	//? Broadcast when walking into a fall or falling onto the ground
+	FS_OnMovementTransition OnMovementTransition;
+
+	//~ View roll for moving sideways relative to ViewRotation, see US_CameraRollModifier
+	float GetCameraRoll(const FRotator &ViewRotation) const;
 
 	bool IsBrakingFrameTolerated() const
 	{
@@ -132,11 +309,233 @@ public:
 
 	virtual float GetMaxSpeed() const override;
 
+	//~ Whether this frame's movement is integrated in fixed steps. Only applies where movement is simulated locally, simulated proxies keep their smoothing.
+	bool ShouldUseFixedTimestep() const;
+
+	void SetUseFixedTimestep(bool bEnable)
+	{
+		bUseFixedTimestep = bEnable;
+	}
+
+	float GetFixedDeltaTime() const
+	{
+		return 1.0f / FMath::Max(FixedTickRate, 1.0f);
+	}
+
+	//~ World space offset from the capsule to where it should be drawn, interpolating between the last two fixed steps
+	FVector GetFixedStepRenderOffset() const
+	{
+		return FixedStepRenderOffset;
+	}
+
+	//~ Past capsule positions, recorded on the server for lag compensation
+	const FS_MovementHistory &GetMovementHistory() const
+	{
+		return MovementHistory;
+	}
+
+	//~ Record the input and result of every movement step from now on, until StopRecording
+	void StartRecording();
+
+	//~ Stop recording and write what was recorded to Filename. Returns false if nothing was being recorded or the write failed.
+	bool StopRecording(const FString &Filename);
+
+	bool IsRecording() const
+	{
+		return MovementRecorder.IsValid();
+	}
+
+	//? Client prediction
+	virtual FNetworkPredictionData_Client *GetPredictionData_Client() const override;
+
+	//~ Snapshot of the tunables consumed by FSourceMoveKernel
+	FSourceMoveSettings GetMoveSettings() const;
+
+	//~ Snapshot of the tunables the speed scaled step height and walkable floor are worked out from
+	FSourceStepLimitSettings GetStepLimitSettings() const;
+
+	//~ Copy the tunables of a profile the engine reads from its own members, rebuilding whatever is derived from them.
+	//~ The Source tunables are read from the profile as they are needed, see GetProfileSettings.
+	void ApplyMovementSettings(const FS_MovementProfileSettings &Settings);
+
+	//~ Switch to Profile, or back to MigratedProfile or the HL2 defaults with null. Only AS_Character calls this, as its replicated profile changes.
+	void SetMovementProfile(US_MovementProfile *Profile);
+
+	//~ Tunables of the current profile, or the HL2 defaults without one. MovementProfile is MigratedProfile when the pawn has none.
+	const FS_MovementProfileSettings &GetProfileSettings() const
+	{
+		return MovementProfile ? MovementProfile->Settings : DefaultProfileSettings;
+	}
+
+	US_MovementProfile *GetMovementProfile() const
+	{
+		return MovementProfile;
+	}
+
+	//~ Fill in the velocity step this component is about to take, if it can be batched by US_MovementManager
+	bool GatherBatchedMove(float DeltaTime, FSourceMoveState &OutState, FSourceMoveInput &OutInput);
+
+	//~ Result of the batched step, used by the next CalcVelocity if its inputs match the gathered ones
+	void SetBatchedVelocity(const FSourceMoveState &State);
+
+	//~ World box this frame's falling moves should stay inside, for US_MovementManager to check for anything in the way.
+	//~ Only pawns that simulate their own moves ask, the moves a server replays for a remote client always sweep.
+	bool GetFallClearanceQuery(float DeltaTime, FBox &OutBox) const;
+
+	//~ Nothing we block or overlap is inside Box, and no dynamic object is near enough to get into it this frame, so
+	//~ falling moves that stay in it can skip their sweep
+	void SetClearFallBox(const FBox &Box);
+
+	//~ Times Count falling slides through the Source slide policy, inlined the same way PhysFalling's are, cycling through
+	//~ Deltas and Hits. Results are added to InOutSum so they can't be optimized away. Used by sv.slide.bench.
+	double TimeInlinedSlides(TArrayView<const FVector> Deltas, TArrayView<const FHitResult> Hits, float Time, int32 Count, FVector &InOutSum) const;
+
+	//~ LOD this simulated proxy should run at, seen from ViewLocation
+	ES_MovementLOD ComputeMovementLOD(const FVector &ViewLocation) const;
+
+	//~ Switch to another LOD, changing the simulation rate to match
+	void SetMovementLOD(ES_MovementLOD LOD);
+
+	//~ Seconds between simulation steps at the current LOD, 0 for every frame
+	float GetMovementLODInterval() const;
+
+	ES_MovementLOD GetMovementLOD() const
+	{
+		return MovementLOD;
+	}
+
+protected:
+	virtual bool MoveUpdatedComponentImpl(const FVector &Delta, const FQuat &NewRotation, bool bSweep, FHitResult *OutHit = nullptr, ETeleportType Teleport = ETeleportType::None) override;
+	virtual void UpdateFromCompressedFlags(uint8 Flags) override;
+	virtual float GetClientNetSendDeltaTime(const APlayerController *PC, const FNetworkPredictionData_Client_Character *ClientData, const FSavedMovePtr &NewMove) const override;
+	virtual void ServerSendMoveResponse(const FClientAdjustment &PendingAdjustment) override;
+	virtual void ServerMove_PerformMovement(const FCharacterNetworkMoveData &MoveData) override;
+	virtual bool ServerExceedsAllowablePositionError(float ClientTimeStamp, float DeltaTime, const FVector &Accel, const FVector &ClientWorldLocation, const FVector &RelativeClientLocation,
+													 UPrimitiveComponent *ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode) override;
+	virtual bool ServerShouldUseAuthoritativePosition(float ClientTimeStamp, float DeltaTime, const FVector &Accel, const FVector &ClientWorldLocation, const FVector &RelativeClientLocation,
+													  UPrimitiveComponent *ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode) override;
+	virtual bool ClientUpdatePositionAfterServerUpdate() override;
+	virtual void OnMovementUpdated(float DeltaSeconds, const FVector &OldLocation, const FVector &OldVelocity) override;
+	virtual void ControlledCharacterMove(const FVector &InputVector, float DeltaSeconds) override;
+	virtual void SimulateMovement(float DeltaTime) override;
+
 private:
 	float DefaultStepHeight;
 	float DefaultWalkableFloorZ;
 	float SurfaceFriction;
 
+	FDelegateHandle MovementProfileChangedHandle;
+	void OnMovementProfileChanged();
+
+	//~ Gather the deprecated tunables, and the engine ones a profile now overwrites, into MigratedProfile if any of them
+	//~ differ from the HL2 defaults. Drops MigratedProfile if none do.
+	void MigrateDeprecatedSettings();
+
+	static const FS_MovementProfileSettings DefaultProfileSettings;
+
+	//~ Apply the step height and walkable floor of the current speed and surface
+	void UpdateStepLimits();
+
+	//~ Slope speed multiplier of the current speed and surface, through StepScaleCurve when set
+	float GetStepLimitMultiplier() const;
+
+	//: Floor component the friction cache belongs to, and the physical material the last sweep found on it
+	TWeakObjectPtr<const UPrimitiveComponent> CachedFrictionFloor;
+	TWeakObjectPtr<UPhysicalMaterial> CachedFrictionMaterial;
+	bool bFloorFrictionCacheValid;
+
+	//~ Friction of CurrentFloor, only sweeping for its physical material when the floor changed
+	float GetFloorSurfaceFriction();
+
 	bool bHasDeferredMovementMode;
 	EMovementMode DeferredMovementMode;
+
+	ES_MovementLOD MovementLOD;
+
+	//: Time simulated proxies below full LOD have waited for their next simulation step
+	float MovementLODPendingTime;
+
+	FS_MovementHistory MovementHistory;
+
+	//: Owned by the world, cleared in EndPlay
+	US_SurfaceIndex *SurfaceIndex;
+
+	//~ Whether the hit is on an indexed static surface that FindFloor would accept as walkable floor
+	bool IsLandingOnIndexedSurface(const FVector &CapsuleLocation, const FHitResult &Hit) const;
+
+	//: Mutable so const queries like FindFloor can count themselves
+	mutable FS_MovementCounters MovementCounters;
+
+	//: Server side correction state: the divergent path the current move took, mutable for HandleSlopeBoosting, and
+	//: what the pending correction is put down to
+	mutable ES_CorrectionSource MoveDivergenceSource;
+	ES_CorrectionSource PendingCorrectionSource;
+
+	//: The last checked error was tolerated, take the client's position instead of keeping ours
+	bool bAcceptClientPosition;
+
+	//: Correction budget, refilled at CorrectionsPerSecond up to CorrectionBurst
+	float CorrectionTokens;
+	double LastCorrectionTokenTime;
+
+	//~ Whether this move is one of an owning client's, predicted there or run by the server from its move
+	bool ShouldQuantizeMoveVelocity() const;
+
+	//~ Whether the capsule can sweep from the server's position to the client's without hitting anything
+	bool IsClientPositionReachable(const FVector &ServerLocation, const FVector &ClientLocation) const;
+
+	TUniquePtr<FS_MovementRecorder> MovementRecorder;
+
+	//: Fixed timestep state
+	float FixedTimeAccumulator;
+	FVector FixedStepRenderOffset;
+	FVector FixedStepStartLocation;
+	FVector CarriedFixedStepInput;
+	bool bFixedStepFrame;
+
+	//~ PhysFalling with the slide rules of TPolicy inlined
+	template <typename TPolicy>
+	void PhysFallingFor(float deltaTime, int32 Iterations);
+
+	//~ ComputeSlideVector with the slide rules of TPolicy inlined
+	template <typename TPolicy>
+	FVector ComputeSlideVectorFor(const FVector &Delta, float Time, const FVector &Normal, const FHitResult &Hit) const;
+
+	float GetBounceCoefficient() const
+	{
+		return 1.0f + GetProfileSettings().BounceMultiplier * (1.0f - SurfaceFriction);
+	}
+
+	//~ The engine tick for the frame, with the recorder and the bookkeeping every move needs around it
+	void TickMovementStep(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction);
+
+	//~ Bookkeeping after every move, once per frame or once per fixed step
+	void FinishMovementStep();
+
+	//~ Recorder frame for a move of DeltaTime, from the input the move is about to consume
+	FS_MovementFrame CaptureRecordedFrame(float DeltaTime) const;
+
+	//~ Fill in where the move ended up and add the frame to the recording
+	void AddRecordedFrame(FS_MovementFrame &RecordedFrame);
+
+	//~ Run as many fixed steps as the accumulated time allows and update the render offset
+	void RunFixedSteps(const FVector &InputVector, float DeltaTime);
+
+	//: Inputs gathered by the movement manager and the result it computed from them
+	FSourceMoveState BatchedInState;
+	FSourceMoveInput BatchedInput;
+	FSourceMoveState BatchedOutState;
+	bool bHasBatchedVelocity;
+
+	bool ConsumeBatchedVelocity(const FSourceMoveState &State, const FSourceMoveInput &Input, FSourceMoveState &OutState);
+
+	//: Space the movement manager found empty this frame
+	FBox ClearFallBox;
+	bool bHasClearFallBox;
+
+	//~ Whether the capsule moving by Delta from Start stays inside ClearFallBox
+	bool IsFallClear(const FVector &Start, const FVector &Delta) const;
+
+	//~ Autonomous proxies and locally controlled or controller-less authority pawns, which integrate their own moves every frame
+	bool IsSimulatingOwnMoves() const;
 };
@@ -16,4 +16,11 @@ class COMBAX_API AS_GameMode : public AGameModeBase
 
 public:
 	AS_GameMode();	
+
+	//~ Connections logging in with ?Bot get BotControllerClass instead of the usual player controller
+	virtual APlayerController *SpawnPlayerController(ENetRole InRemoteRole, const FString &Options) override;
+
+protected:
+	UPROPERTY(EditDefaultsOnly, Category = "Classes")
+	TSubclassOf<APlayerController> BotControllerClass;
 };
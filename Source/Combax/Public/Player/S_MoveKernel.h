@@ -0,0 +1,166 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+//? Tunables shared by every mover advanced through FSourceMoveKernel
+struct COMBAX_API FSourceMoveSettings
+{
+	//? HL2's sv_accelerate
+	float GroundAccelerationMultiplier = 10.0f;
+
+	//? HL2's sv_airaccelerate
+	float AirAccelerationMultiplier = 10.0f;
+
+	//? The vector differential magnitude cap when in air
+	float AirSpeedCap = 57.15f;
+
+	//? Per axis clamp applied before and after acceleration
+	float AxisSpeedLimit = 6667.5f;
+
+	float BrakingFrictionFactor = 1.0f;
+	float BrakingSubStepTime = 0.015f;
+
+	//? Solve the braking substep loop analytically instead of iterating it
+	bool bClosedFormBraking = false;
+
+	bool operator==(const FSourceMoveSettings &Other) const
+	{
+		return GroundAccelerationMultiplier == Other.GroundAccelerationMultiplier && AirAccelerationMultiplier == Other.AirAccelerationMultiplier &&
+			   AirSpeedCap == Other.AirSpeedCap && AxisSpeedLimit == Other.AxisSpeedLimit &&
+			   BrakingFrictionFactor == Other.BrakingFrictionFactor && BrakingSubStepTime == Other.BrakingSubStepTime &&
+			   bClosedFormBraking == Other.bClosedFormBraking;
+	}
+};
+
+//? Everything the kernel needs to know about a single step of a single mover
+struct COMBAX_API FSourceMoveInput
+{
+	float DeltaTime = 0.0f;
+
+	//? Fluid friction, already clamped to >= 0
+	float Friction = 0.0f;
+
+	//? Ground friction before surface friction is applied
+	float BrakingFriction = 0.0f;
+
+	float BrakingDeceleration = 0.0f;
+
+	//? Max speed with the analog input modifier already applied
+	float MaxSpeed = 0.0f;
+
+	bool bIsGroundMove = false;
+	bool bFluid = false;
+	bool bCheatFlying = false;
+
+	bool operator==(const FSourceMoveInput &Other) const
+	{
+		return DeltaTime == Other.DeltaTime && Friction == Other.Friction && BrakingFriction == Other.BrakingFriction &&
+			   BrakingDeceleration == Other.BrakingDeceleration && MaxSpeed == Other.MaxSpeed &&
+			   bIsGroundMove == Other.bIsGroundMove && bFluid == Other.bFluid && bCheatFlying == Other.bCheatFlying;
+	}
+};
+
+//? Mover state that is carried from one step to the next
+struct COMBAX_API FSourceMoveState
+{
+	FVector Velocity = FVector::ZeroVector;
+
+	//? Input acceleration, clamped by the step the same way the component clamps it
+	FVector Acceleration = FVector::ZeroVector;
+
+	float SurfaceFriction = 1.0f;
+
+	bool operator==(const FSourceMoveState &Other) const
+	{
+		return Velocity == Other.Velocity && Acceleration == Other.Acceleration && SurfaceFriction == Other.SurfaceFriction;
+	}
+};
+
+//? Structure of arrays for stepping many movers at once. All movers in a batch share one delta time and one settings block.
+struct COMBAX_API FSourceMoveBatch
+{
+	enum EFlags : uint8
+	{
+		Flag_GroundMove = 1 << 0,
+		Flag_Fluid = 1 << 1,
+		Flag_CheatFlying = 1 << 2,
+	};
+
+	TArray<float> VelocityX;
+	TArray<float> VelocityY;
+	TArray<float> VelocityZ;
+	TArray<float> AccelerationX;
+	TArray<float> AccelerationY;
+	TArray<float> AccelerationZ;
+	TArray<float> SurfaceFriction;
+	TArray<float> Friction;
+	TArray<float> BrakingFriction;
+	TArray<float> BrakingDeceleration;
+	TArray<float> MaxSpeed;
+	TArray<uint8> Flags;
+
+	int32 Num() const
+	{
+		return VelocityX.Num();
+	}
+
+	void SetNum(int32 NewNum);
+	void Reset();
+
+	int32 Add(const FSourceMoveState &State, const FSourceMoveInput &Input);
+	void GetState(int32 Index, FSourceMoveState &OutState) const;
+	void GetInput(int32 Index, float DeltaTime, FSourceMoveInput &OutInput) const;
+	void SetState(int32 Index, const FSourceMoveState &State);
+};
+
+//? Inputs of the speed scaled step height and walkable floor
+struct COMBAX_API FSourceStepLimitSettings
+{
+	float DefaultStepHeight = 34.29f;
+	float MinStepHeight = 10.0f;
+	float DefaultWalkableFloorZ = 0.7f;
+
+	//? Walkable floor Z at full speed, cos(10 degrees)
+	float FastWalkableFloorZ = 0.9848f;
+
+	//? Speeds the multiplier starts rising at and reaches one at
+	float SpeedMultMin = 0.0f;
+	float SpeedMultMax = 1.0f;
+};
+
+//? Step height and walkable floor Z at a given slope speed multiplier
+struct FSourceStepLimits
+{
+	float StepHeight = 0.0f;
+	float WalkableFloorZ = 0.0f;
+};
+
+//~ Engine independent Source movement math. No UWorld, no components, just state in and state out.
+struct COMBAX_API FSourceMoveKernel
+{
+	static constexpr float MinTickTime = 1e-6f;
+
+	//~ Accelerate / air accelerate / friction / axis clamp for one mover. Returns the braking substeps taken.
+	static int32 CalcVelocity(FSourceMoveState &State, const FSourceMoveInput &Input, const FSourceMoveSettings &Settings);
+
+	//~ Brake towards zero along the current velocity. Returns the substeps taken, 0 if no braking applied.
+	static int32 ApplyBraking(FVector &Velocity, float DeltaTime, float Friction, float BrakingDeceleration, const FSourceMoveSettings &Settings);
+
+	//~ Largest difference closed form braking may have from the substeps, starting from StartSpeed. Both lose the same
+	//~ speed along the same direction, so this only has to cover float error accumulated over the substeps.
+	static float GetClosedFormBrakingTolerance(float StartSpeed)
+	{
+		return FMath::Max(StartSpeed * 1e-4f, 1e-3f);
+	}
+
+	//~ Advance every mover of the batch by one step. Walking and falling movers are stepped four at a time with vector math.
+	static void AdvanceBatch(FSourceMoveBatch &Batch, float DeltaTime, const FSourceMoveSettings &Settings);
+
+	//~ Multiplier used to scale step height and walkable floor down at high speeds
+	static float GetSlopeSpeedMultiplier(float Speed2D, float SpeedMultMin, float SpeedMultMax, float SurfaceFriction, bool bFalling);
+
+	//~ Step height and walkable floor Z scaled down by a slope speed multiplier
+	static FSourceStepLimits GetStepLimits(const FSourceStepLimitSettings &Settings, float SpeedMultiplier);
+};
@@ -0,0 +1,119 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Player/S_MovementStats.h"
+#include "Tickable.h"
+
+class AActor;
+class AS_Character;
+class UWorld;
+
+//? Test geometry each group of pawns runs on
+enum class ES_BenchCourse : uint8
+{
+	Flat,
+	Ramp,
+	Stairs,
+	Surf,
+	Air,
+	Count
+};
+
+COMBAX_API const TCHAR *GetBenchCourseName(ES_BenchCourse Course);
+
+//? Pawn driven through a course with scripted input
+struct FS_BenchPawn
+{
+	TWeakObjectPtr<AS_Character> Character;
+	ES_BenchCourse Course = ES_BenchCourse::Flat;
+	FVector Start = FVector::ZeroVector;
+	float Phase = 0.0f;
+};
+
+/**
+ * Spawns pawns on generated courses (flat ground, ramps at the walkable limit, stairs at MaxStepHeight, surf ramps
+ * and a long drop that keeps them airborne), drives them with strafe jumping input for a while and reports per pawn tick costs from
+ * FS_MovementCounters against the sv.movement.bench budgets. Ticked by the world it runs in, so it works the same from the
+ * sv.movement.bench command, under -nullrhi, and from the Combax.Movement.Bench automation tests that tick a world by hand.
+ */
+class COMBAX_API FS_MovementBenchmark : public FTickableGameObject
+{
+public:
+	FS_MovementBenchmark(UWorld *InWorld, int32 PawnCount, float InDuration, ES_BenchCourse InOnlyCourse);
+
+	//~ Remove the pawns and geometry and put the timing cvar back
+	void Cleanup();
+
+	bool IsFinished() const
+	{
+		return bFinished;
+	}
+
+	//~ Whether every course stayed inside the budgets, valid once finished
+	bool HasPassed() const
+	{
+		return bFinished && Failures.Num() == 0;
+	}
+
+	//~ One line per budget a course went over
+	const TArray<FString> &GetFailures() const
+	{
+		return Failures;
+	}
+
+	//~ Counters summed over the measured frames of every pawn on a course
+	const FS_MovementCounters &GetCourseTotals(ES_BenchCourse Course) const
+	{
+		return Totals[static_cast<int32>(Course)];
+	}
+
+	int32 GetMeasuredFrames() const
+	{
+		return MeasuredFrames;
+	}
+
+	//~ FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override
+	{
+		RETURN_QUICK_DECLARE_CYCLE_STAT(FS_MovementBenchmark, STATGROUP_Tickables);
+	}
+	virtual ETickableTickType GetTickableTickType() const override
+	{
+		return ETickableTickType::Always;
+	}
+	virtual UWorld *GetTickableGameObjectWorld() const override
+	{
+		return World.Get();
+	}
+
+private:
+	void BuildCourses();
+	void AddBox(const FVector &Center, const FVector &Size, const FRotator &Rotation = FRotator::ZeroRotator);
+	void SpawnPawns(int32 PawnCount);
+	void DrivePawn(FS_BenchPawn &Pawn, float Time);
+	void Report();
+
+	TWeakObjectPtr<UWorld> World;
+	float Duration;
+
+	//: Every pawn runs this course, or they are spread over all of them when it's Count
+	ES_BenchCourse OnlyCourse;
+
+	float Elapsed = 0.0f;
+	bool bFinished = false;
+	bool bCleanedUp = false;
+	int32 PreviousTimingValue = 0;
+
+	TArray<FS_BenchPawn> Pawns;
+	TArray<TWeakObjectPtr<AActor>> Geometry;
+
+	//: Counters summed per course once warmed up
+	FS_MovementCounters Totals[static_cast<int32>(ES_BenchCourse::Count)];
+	int32 MeasuredFrames = 0;
+	double MeasuredFrameSeconds = 0.0;
+
+	TArray<FString> Failures;
+};
@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StaticArray.h"
+
+//? One recorded capsule position. Capsules stay upright, so no rotation is needed.
+struct FS_CapsuleSample
+{
+	double Time = 0.0;
+	FVector Location = FVector::ZeroVector;
+	float HalfHeight = 0.0f;
+};
+
+//? Fixed size ring of past capsule positions, recorded by the server once per tick. Never allocates.
+class COMBAX_API FS_MovementHistory
+{
+public:
+	//: A little over a second at 120 Hz, covers any ping we'd want to compensate for
+	static constexpr int32 Capacity = 128;
+
+	void Reset()
+	{
+		Head = 0;
+		Count = 0;
+	}
+
+	int32 Num() const
+	{
+		return Count;
+	}
+
+	float GetRadius() const
+	{
+		return Radius;
+	}
+
+	//~ Sample at index 0 is the oldest
+	const FS_CapsuleSample &GetSample(int32 Index) const
+	{
+		check(Index >= 0 && Index < Count);
+		return Samples[(Head + Capacity - Count + Index) % Capacity];
+	}
+
+	//~ Add a sample, replacing the one at the same time if the server ticks twice without time passing
+	void Record(double Time, const FVector &Location, float HalfHeight, float InRadius);
+
+	//~ Capsule at Time, interpolated between the surrounding samples and clamped to the recorded range
+	bool GetCapsuleAt(double Time, FVector &OutLocation, float &OutHalfHeight) const;
+
+	//~ Test a line segment against the capsule as it was at Time. OutFraction and OutLocation are where the segment first
+	//~ enters the capsule, or its start if it starts inside.
+	bool IntersectSegment(const FVector &Start, const FVector &End, double Time, float &OutFraction, FVector &OutLocation) const;
+
+private:
+	TStaticArray<FS_CapsuleSample, Capacity> Samples;
+	int32 Head = 0;
+	int32 Count = 0;
+	float Radius = 0.0f;
+};
@@ -0,0 +1,186 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CollisionQueryParams.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Player/S_MoveKernel.h"
+#include "Player/S_MovementStats.h"
+#include "S_MovementManager.generated.h"
+
+class AController;
+class US_CharacterMovement;
+class US_MovementProfile;
+
+//? Ticks the movement manager in TG_PrePhysics, ahead of every registered movement component
+USTRUCT()
+struct FS_MovementManagerTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	class US_MovementManager *Manager = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef &MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template <>
+struct TStructOpsTypeTraits<FS_MovementManagerTickFunction> : public TStructOpsTypeTraitsBase2<FS_MovementManagerTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+//? Movers sharing one settings block, stepped together
+struct FS_MovementBatchGroup
+{
+	FSourceMoveSettings Settings;
+	FSourceMoveBatch Batch;
+	TArray<US_CharacterMovement *> Movers;
+};
+
+//? Space a falling mover is going to move through this frame, checked for anything in the way
+struct FS_FallClearance
+{
+	US_CharacterMovement *Movement = nullptr;
+	FBox Box;
+
+	//? Box grown by how far a dynamic object we don't move could travel into it this frame
+	FBox DynamicBox;
+	ECollisionChannel Channel = ECC_Pawn;
+	FCollisionQueryParams QueryParams;
+	FCollisionResponseParams ResponseParams;
+
+	//? Own entry in the reach boxes
+	int32 ReachIndex = INDEX_NONE;
+	bool bClear = false;
+};
+
+//? Result of testing a shot against rewound movers
+struct FS_RewindHit
+{
+	US_CharacterMovement *Movement = nullptr;
+
+	//? Fraction along the shot
+	float Fraction = 1.0f;
+
+	FVector Location = FVector::ZeroVector;
+};
+
+/**
+ * Keeps track of every US_CharacterMovement in the world. With sv.batchmovement enabled it gathers the velocity
+ * inputs of all eligible movers into SoA buffers before they tick, advances them with the vector kernel and hands
+ * the results back. Each component only uses its batched result if its real inputs match the gathered ones.
+ */
+UCLASS()
+class COMBAX_API US_MovementManager : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject *Outer) const override;
+	virtual void OnWorldBeginPlay(UWorld &InWorld) override;
+	virtual void Deinitialize() override;
+
+	void Register(US_CharacterMovement *Movement);
+	void Unregister(US_CharacterMovement *Movement);
+
+	const TArray<US_CharacterMovement *> &GetMovers() const
+	{
+		return Movers;
+	}
+
+	FTickFunction &GetTickFunction()
+	{
+		return TickFunction;
+	}
+
+	void Tick(float DeltaTime);
+
+	//~ Make the batch gather wait for Controller's tick, which adds the pending input it reads, the way
+	//~ AController::AddPawnTickDependency orders the pawn's movement after it
+	void AddControllerPrerequisite(AController *Controller);
+	void RemoveControllerPrerequisite(AController *Controller);
+
+	//~ Time spent gathering, stepping and scattering batches since the last reset, only collected while sv.movement.counters is on
+	double GetBatchSeconds() const
+	{
+		return BatchSeconds;
+	}
+
+	void ResetBatchSeconds()
+	{
+		BatchSeconds = 0.0;
+	}
+
+	static bool IsBatchingEnabled();
+
+	//~ See sv.batchfallsweeps
+	static bool IsFallBatchingEnabled();
+
+	//~ Simulated proxies at each ES_MovementLOD after the last update
+	int32 GetNumProxiesAtLOD(ES_MovementLOD LOD) const
+	{
+		return ProxiesAtLOD[static_cast<int32>(LOD)];
+	}
+
+	//~ Server time the shooter was looking at: half their round trip plus the delay simulated proxies are drawn behind
+	double GetShooterViewTime(const AController *Shooter) const;
+
+	//~ Test a shot against every mover's capsule as it was at ViewTime, returning the first one hit along the segment.
+	//~ For server side hit validation of hitscan weapons. Nothing calls it yet, UTP_WeaponComponent only fires projectiles.
+	bool RewindSegmentTest(const FVector &Start, const FVector &End, double ViewTime, const AActor *IgnoreActor, FS_RewindHit &OutHit) const;
+
+	//~ Switch every character in the world to Profile, or to their own tunables with null, and remember it for the ones
+	//~ spawned later. Server only. Returns the number of characters switched.
+	int32 SetWorldMovementProfile(US_MovementProfile *Profile);
+
+	//~ Whether SetWorldMovementProfile was called, characters keep the profile they were placed with until then
+	bool HasWorldMovementProfile() const
+	{
+		return bHasWorldMovementProfile;
+	}
+
+	US_MovementProfile *GetWorldMovementProfile() const
+	{
+		return WorldMovementProfile;
+	}
+
+private:
+	void GatherBatches(float DeltaTime);
+	void ScatterBatches(float DeltaTime);
+
+	//~ Check the space every falling mover is about to fall through in one parallel batch of overlap queries
+	void ClearFallingMoves(float DeltaTime);
+
+	//~ Pick the movement LOD of every simulated proxy from where the local player is looking from
+	void UpdateProxyLODs();
+
+	//~ Box Movement can reach this frame. Returns true if it is falling and its box can be checked for clearance.
+	static bool GetReachBox(US_CharacterMovement *Movement, float DeltaTime, FBox &OutBox);
+
+	static void InitClearance(FS_FallClearance &Clearance, US_CharacterMovement *Movement, const FBox &Box, float DeltaTime);
+
+	UPROPERTY(Transient)
+	TArray<US_CharacterMovement *> Movers;
+
+	TArray<FS_MovementBatchGroup> Groups;
+
+	TArray<FS_FallClearance> FallClearances;
+	TArray<FBox> ReachBoxes;
+
+
+	int32 ProxiesAtLOD[static_cast<int32>(ES_MovementLOD::Count)] = {};
+
+	double BatchSeconds = 0.0;
+
+	UPROPERTY(Transient)
+	US_MovementProfile *WorldMovementProfile = nullptr;
+	bool bHasWorldMovementProfile = false;
+
+	FS_MovementManagerTickFunction TickFunction;
+};
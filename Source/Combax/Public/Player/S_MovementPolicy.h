@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "S_MovementPolicy.generated.h"
+
+//? How falling moves slide off what they hit, picked per component by designers
+UENUM(BlueprintType)
+enum class ES_SlidePolicy : uint8
+{
+	//? Source's ClipVelocity: bounce off the surface by BounceMultiplier, no matter which way it faces
+	Source,
+
+	//? The engine's slide: project onto the surface and don't let it boost the pawn up slopes
+	Engine,
+};
+
+//? Compile time rules of the Source slide
+struct FS_SourceSlidePolicy
+{
+	static constexpr ES_SlidePolicy Policy = ES_SlidePolicy::Source;
+
+	//? Clip against the surface ourselves instead of the engine's projection and slope boosting
+	static constexpr bool bClipVelocity = true;
+
+	//? Slope is vertical if Abs(Normal.Z) <= this threshold. Accounts for precision problems that sometimes angle
+	//? normals slightly off horizontal for vertical surface.
+	static constexpr float VerticalSlopeNormalZ = 0.001f;
+};
+
+//? Compile time rules of the engine's slide
+struct FS_EngineSlidePolicy
+{
+	static constexpr ES_SlidePolicy Policy = ES_SlidePolicy::Engine;
+	static constexpr bool bClipVelocity = false;
+	static constexpr float VerticalSlopeNormalZ = 0.001f;
+};
+
+/**
+ * Slide math of a policy, inlined into the movement paths instantiated for it. US_CharacterMovement picks the
+ * instantiation once per PhysFalling from its SlidePolicy, so the moves inside don't go through virtual slide calls.
+ */
+template <typename TPolicy>
+struct TS_SlideMath
+{
+	//~ Normal to clip against for a hit. Steep and flat hits use the more stable hit normal.
+	static FORCEINLINE const FVector &GetClipNormal(const FVector &Normal, const FVector &ImpactNormal)
+	{
+		const float WallAngle = FMath::Abs(ImpactNormal.Z);
+		return (WallAngle <= TPolicy::VerticalSlopeNormalZ || WallAngle == 1.0f) ? Normal : ImpactNormal;
+	}
+
+	//~ Source's ClipVelocity of Delta against ClipNormal
+	static FORCEINLINE FVector ClipToSurface(const FVector &Delta, float Time, const FVector &ClipNormal, float BounceCoefficient)
+	{
+		return (Delta - BounceCoefficient * Delta.ProjectOnToNormal(ClipNormal)) * Time;
+	}
+};
@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "Player/S_MovementPolicy.h"
+#include "S_MovementProfile.generated.h"
+
+//? The Source tunables a movement profile sets, defaulting to HL2's
+USTRUCT(BlueprintType)
+struct COMBAX_API FS_MovementProfileSettings
+{
+	GENERATED_BODY()
+
+	//? HL2 cl_(forward & side)speed = 450Hu
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Speeds", meta = (ClampMin = "0", UIMin = "0"))
+	float MaxAcceleration = 857.25f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Speeds", meta = (ClampMin = "0", UIMin = "0"))
+	float WalkSpeed = 285.75f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Speeds", meta = (ClampMin = "0", UIMin = "0"))
+	float RunSpeed = 361.9f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Speeds", meta = (ClampMin = "0", UIMin = "0"))
+	float SprintSpeed = 609.6f;
+
+	//? Per axis velocity clamp
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Speeds", meta = (ClampMin = "0", UIMin = "0"))
+	float AxisSpeedLimit = 6667.5f;
+
+	//? HL2's sv_accelerate
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Acceleration")
+	float GroundAccelerationMultiplier = 10.0f;
+
+	//? HL2's sv_airaccelerate
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Acceleration")
+	float AirAccelerationMultiplier = 10.0f;
+
+	//? 30 air speed cap from HL2
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Acceleration")
+	float AirSpeedCap = 57.15f;
+
+	//? HL2's sv_friction, used for braking too
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Friction", meta = (ClampMin = "0", UIMin = "0"))
+	float GroundFriction = 4.0f;
+
+	//? HL2's sv_stopspeed
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Friction", meta = (ClampMin = "0", UIMin = "0"))
+	float BrakingDecelerationWalking = 190.5f;
+
+	//? Jump z from HL2's 160Hu, 21Hu jump height, 510ms jump time
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Jumping / Falling", meta = (ClampMin = "0", UIMin = "0"))
+	float JumpZVelocity = 304.8f;
+
+	//? Moving up faster than this, a pawn can't land or be controlled vertically by the player
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Jumping / Falling", meta = (ClampMin = "0", UIMin = "0"))
+	float MaxLandingVelocityZ = 266.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Jumping / Falling")
+	float GravityZ = -1143.0f;
+
+	//? How much of the velocity into a surface bounces back off it, scaled down by the surface's friction
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Jumping / Falling")
+	float BounceMultiplier = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Jumping / Falling")
+	ES_SlidePolicy SlidePolicy = ES_SlidePolicy::Source;
+
+	//? HL2 step height
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Slopes", meta = (ClampMin = "0", UIMin = "0"))
+	float MaxStepHeight = 34.29f;
+
+	//? Step height at and above SpeedMultMax
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Slopes", meta = (ClampMin = "0", UIMin = "0"))
+	float MinStepHeight = 10.0f;
+
+	//? Slope angle is 45.57 degrees
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Slopes", meta = (ClampMin = "0", ClampMax = "1", UIMin = "0", UIMax = "1"))
+	float WalkableFloorZ = 0.7f;
+
+	//? Speeds step height and walkable floor start and finish scaling down between, 1.7 and 2.5 times the sprint speed
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Slopes", meta = (ClampMin = "0", UIMin = "0"))
+	float SpeedMultMin = 1036.32f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Slopes", meta = (ClampMin = "0", UIMin = "0"))
+	float SpeedMultMax = 1524.0f;
+};
+
+/**
+ * A named set of movement tunables, such as surf, bhop or vanilla. Characters point at one through a replicated
+ * property, so switching profiles in a running game doesn't respawn anyone. The movement component reads the Source
+ * tunables straight from it and only copies the ones the engine reads from its own members. Editing a profile in the
+ * editor reapplies those to every mover using it, in PIE included.
+ */
+UCLASS(BlueprintType)
+class COMBAX_API US_MovementProfile : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	static const FPrimaryAssetType PrimaryAssetType;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Movement", meta = (ShowOnlyInnerProperties))
+	FS_MovementProfileSettings Settings;
+
+	virtual FPrimaryAssetId GetPrimaryAssetId() const override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent &PropertyChangedEvent) override;
+#endif
+
+	//? Settings were changed in place, movers using the profile apply them again
+	FSimpleMulticastDelegate OnSettingsChanged;
+};
@@ -0,0 +1,126 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+//? Buttons held during a recorded step
+enum ES_RecordedButtons : uint8
+{
+	RecordedButton_Jump = 1 << 0,
+	RecordedButton_Sprint = 1 << 1,
+	RecordedButton_Walk = 1 << 2,
+};
+
+//? One movement step: the input that went into it and where it left the capsule
+struct COMBAX_API FS_MovementFrame
+{
+	float DeltaTime = 0.0f;
+
+	//? Move action value, X is right and Y is forward
+	FVector2f MoveInput = FVector2f::ZeroVector;
+
+	//? View rotation the step was taken with. Look input is captured after the controller has applied it.
+	float Pitch = 0.0f;
+	float Yaw = 0.0f;
+
+	uint8 Buttons = 0;
+
+	FVector3f Location = FVector3f::ZeroVector;
+	FVector3f Velocity = FVector3f::ZeroVector;
+
+	bool IsHeld(ES_RecordedButtons Button) const
+	{
+		return (Buttons & Button) != 0;
+	}
+};
+
+//? Fixed size start of a recording file. Followed by the map name in UTF-8, then the encoded frames.
+struct FS_MovementRecordingHeader
+{
+	static constexpr uint32 ExpectedMagic = 0x4D584243; //: "CBXM"
+	static constexpr uint16 CurrentVersion = 2;
+
+	uint32 Magic = ExpectedMagic;
+	uint16 Version = CurrentVersion;
+	uint8 bAutoBunnyhop = 0;
+	uint8 MovementMode = 0;
+	uint32 FrameCount = 0;
+	uint32 MapNameLength = 0;
+
+	//: Doubles, so a replay spawns the pawn exactly where the recording started however far out that was
+	FVector StartLocation = FVector::ZeroVector;
+	FVector3f StartVelocity = FVector3f::ZeroVector;
+	float StartYaw = 0.0f;
+};
+
+/**
+ * Builds a recording in memory. Each frame only stores the fields that changed since the previous one, as zigzag varints
+ * of the difference between their float bit patterns, so decoding gives back the exact values that were recorded.
+ */
+class COMBAX_API FS_MovementRecorder
+{
+public:
+	FS_MovementRecorder(const FString &InMapName, const FS_MovementRecordingHeader &InHeader);
+
+	void AddFrame(const FS_MovementFrame &Frame);
+
+	int32 Num() const
+	{
+		return Header.FrameCount;
+	}
+
+	//~ Write the header, map name and frames to a file
+	bool Save(const FString &Filename) const;
+
+private:
+	FString MapName;
+	FS_MovementRecordingHeader Header;
+	FS_MovementFrame Previous;
+	TArray<uint8> Frames;
+};
+
+/**
+ * Reads a recording frame by frame. The file is memory mapped where the platform allows it, so long recordings are
+ * decoded straight out of the page cache instead of being loaded up front.
+ */
+class COMBAX_API FS_MovementRecordingReader
+{
+public:
+	FS_MovementRecordingReader();
+	~FS_MovementRecordingReader();
+
+	bool Open(const FString &Filename);
+
+	const FS_MovementRecordingHeader &GetHeader() const
+	{
+		return Header;
+	}
+
+	const FString &GetMapName() const
+	{
+		return MapName;
+	}
+
+	//~ Decode the next frame. Returns false at the end of the recording or if it is truncated.
+	bool Next(FS_MovementFrame &OutFrame);
+
+private:
+	TUniquePtr<IMappedFileHandle> MappedHandle;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+
+	//: Used instead of the mapping where the platform can't map files
+	TArray<uint8> LoadedData;
+
+	const uint8 *Data = nullptr;
+	int64 Size = 0;
+	int64 Offset = 0;
+
+	FS_MovementRecordingHeader Header;
+	FString MapName;
+	FS_MovementFrame Previous;
+	uint32 FramesRead = 0;
+};
@@ -0,0 +1,167 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformTime.h"
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("CombaxMovement"), STATGROUP_CombaxMovement, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Movement tick"), STAT_CombaxMovementTick, STATGROUP_CombaxMovement, COMBAX_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("CalcVelocity"), STAT_CombaxCalcVelocity, STATGROUP_CombaxMovement, COMBAX_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("PhysFalling"), STAT_CombaxPhysFalling, STATGROUP_CombaxMovement, COMBAX_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ApplyVelocityBraking"), STAT_CombaxApplyVelocityBraking, STATGROUP_CombaxMovement, COMBAX_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ShouldCatchAir"), STAT_CombaxShouldCatchAir, STATGROUP_CombaxMovement, COMBAX_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("IsValidLandingSpot"), STAT_CombaxIsValidLandingSpot, STATGROUP_CombaxMovement, COMBAX_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("FindFloor"), STAT_CombaxFindFloor, STATGROUP_CombaxMovement, COMBAX_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("TraceCharacterFloor"), STAT_CombaxTraceCharacterFloor, STATGROUP_CombaxMovement, COMBAX_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Falling clearance batch"), STAT_CombaxFallClearance, STATGROUP_CombaxMovement, COMBAX_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Capsule sweeps"), STAT_CombaxMovementSweeps, STATGROUP_CombaxMovement, COMBAX_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Landing spot checks"), STAT_CombaxLandingSpotChecks, STATGROUP_CombaxMovement, COMBAX_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Catch air checks"), STAT_CombaxCatchAirChecks, STATGROUP_CombaxMovement, COMBAX_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Catch air taken"), STAT_CombaxCatchAirs, STATGROUP_CombaxMovement, COMBAX_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Braking substeps"), STAT_CombaxBrakingSubSteps, STATGROUP_CombaxMovement, COMBAX_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Surface index hits"), STAT_CombaxSurfaceIndexHits, STATGROUP_CombaxMovement, COMBAX_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Surface index misses"), STAT_CombaxSurfaceIndexMisses, STATGROUP_CombaxMovement, COMBAX_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Falling sweeps skipped"), STAT_CombaxFallSweepsSkipped, STATGROUP_CombaxMovement, COMBAX_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Batched velocities used"), STAT_CombaxBatchedVelocityHits, STATGROUP_CombaxMovement, COMBAX_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Batched velocities discarded"), STAT_CombaxBatchedVelocityMisses, STATGROUP_CombaxMovement, COMBAX_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Proxies at full LOD"), STAT_CombaxProxiesFullLOD, STATGROUP_CombaxMovement, COMBAX_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Proxies at reduced LOD"), STAT_CombaxProxiesReducedLOD, STATGROUP_CombaxMovement, COMBAX_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Proxies at minimal LOD"), STAT_CombaxProxiesMinimalLOD, STATGROUP_CombaxMovement, COMBAX_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Corrections sent"), STAT_CombaxCorrections, STATGROUP_CombaxMovement, COMBAX_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Corrections deferred"), STAT_CombaxCorrectionsDeferred, STATGROUP_CombaxMovement, COMBAX_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Moves replayed"), STAT_CombaxReplayedMoves, STATGROUP_CombaxMovement, COMBAX_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Floor friction sweeps"), STAT_CombaxFloorFrictionSweeps, STATGROUP_CombaxMovement, COMBAX_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Floor friction sweeps saved"), STAT_CombaxFloorFrictionSweepsSaved, STATGROUP_CombaxMovement, COMBAX_API);
+
+//? Movement code a server correction is put down to, the last path known to magnify small client differences that the corrected move took
+enum class ES_CorrectionSource : uint8
+{
+	Other,
+	SlopeBoost,
+	CatchAir,
+	ModeMismatch,
+	Count
+};
+
+COMBAX_API const TCHAR *GetCorrectionSourceName(ES_CorrectionSource Source);
+
+//? How much of the movement path a simulated proxy runs, picked by US_MovementManager from its distance and visibility
+enum class ES_MovementLOD : uint8
+{
+	//? Every frame, with floor friction and dynamic step height
+	Full,
+
+	//? Simulated ReducedLODTickRate times a second, smoothed in between
+	Reduced,
+
+	//? Simulated MinimalLODTickRate times a second, smoothed in between
+	Minimal,
+
+	Count
+};
+
+//? Work done by one mover since its counters were last reset. Times are inclusive of nested work.
+struct COMBAX_API FS_MovementCounters
+{
+	int32 Ticks = 0;
+
+	//? Game time the counters cover, for rates
+	double GameSeconds = 0.0;
+
+	//? Swept moves of the capsule, not counting floor queries
+	int32 Sweeps = 0;
+
+	int32 FloorFinds = 0;
+
+	//? Complex floor sweeps for physical materials
+	int32 FloorTraces = 0;
+
+	int32 CalcVelocityCalls = 0;
+	int32 PhysFallingCalls = 0;
+
+	int32 LandingSpotChecks = 0;
+
+	//? ShouldCatchAir calls, and how many of them left the ground
+	int32 CatchAirChecks = 0;
+	int32 CatchAirs = 0;
+
+	int32 BrakingSubSteps = 0;
+
+	//? Landing spots answered by US_SurfaceIndex, and those that needed a floor query
+	int32 SurfaceIndexHits = 0;
+	int32 SurfaceIndexMisses = 0;
+
+	//? Falling moves made without a sweep because US_MovementManager found their space empty
+	int32 FallSweepsSkipped = 0;
+
+	//? Velocity steps taken from US_MovementManager's batch, and batched steps thrown away because the inputs changed
+	//? after the gather, which then ran the scalar kernel as well
+	int32 BatchedVelocityHits = 0;
+	int32 BatchedVelocityMisses = 0;
+
+	//? Server only: client moves answered, and how many of the answers were corrections
+	int32 ServerMoveResponses = 0;
+	int32 Corrections = 0;
+
+	//? Server only: errors inside the speed scaled tolerance that took the client's position after a clear sweep to it, and
+	//? corrections the budget held back while keeping the server's position
+	int32 ClientPositionsAccepted = 0;
+	int32 CorrectionsDeferred = 0;
+
+	//? Server only: corrections sent, by the path the corrected move took
+	int32 CorrectionsBySource[static_cast<int32>(ES_CorrectionSource::Count)] = {};
+
+	//? Client only: corrections received and the saved moves replayed after them
+	int32 Replays = 0;
+	int32 ReplayedMoves = 0;
+
+	double TickSeconds = 0.0;
+	double CalcVelocitySeconds = 0.0;
+	double PhysFallingSeconds = 0.0;
+	double FloorSeconds = 0.0;
+
+	void Reset()
+	{
+		*this = FS_MovementCounters();
+	}
+
+	FS_MovementCounters &operator+=(const FS_MovementCounters &Other);
+
+	ES_CorrectionSource GetTopCorrectionSource() const;
+
+	//~ Corrections sent per second of game time covered
+	double GetCorrectionsPerSecond() const
+	{
+		return GameSeconds > 0.0 ? Corrections / GameSeconds : 0.0;
+	}
+
+	//~ Whether times are collected as well as counts, see sv.movement.counters
+	static bool IsTimingEnabled();
+};
+
+//? Adds the time spent in a scope to a counter while timing is enabled
+struct FS_MovementCounterScope
+{
+	explicit FS_MovementCounterScope(double &InSeconds)
+		: Seconds(InSeconds), StartCycles(FS_MovementCounters::IsTimingEnabled() ? FPlatformTime::Cycles64() : 0)
+	{
+	}
+
+	~FS_MovementCounterScope()
+	{
+		if (StartCycles != 0)
+		{
+			Seconds += FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+		}
+	}
+
+private:
+	double &Seconds;
+	uint64 StartCycles;
+};
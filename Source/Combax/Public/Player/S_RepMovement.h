@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/NetSerialization.h"
+#include "Engine/ReplicatedState.h"
+#include "S_RepMovement.generated.h"
+
+/**
+ * Replicated movement of an AS_Character, sent to simulated proxies instead of AActor::ReplicatedMovement.
+ *
+ * Values are quantized when they are set: location in tenths of a unit, each velocity axis as 16 bit fixed point over
+ * the pawn's AxisSpeedLimit and rotation as shorts. Every update after the first is written as the difference from the
+ * last state sent on that connection, which the replication system rolls back to the one before a dropped packet, so
+ * the base is always one the client either has or will reject. Each group of values, the sprint and walk flags included,
+ * costs a bit when it didn't change. Velocity outside the limit, or a pawn simulating physics, falls back to the
+ * engine's FRepMovement encoding.
+ *
+ * sv.repmovement.size reports the bits actually sent.
+ */
+USTRUCT()
+struct COMBAX_API FS_RepMovement
+{
+	GENERATED_BODY()
+
+	enum EFlags : uint8
+	{
+		Flag_Sprinting = 1 << 0,
+		Flag_WantsToWalk = 1 << 1,
+		Flag_Fallback = 1 << 2,
+	};
+	static constexpr int32 NumFlagBits = 3;
+
+	//? Bits of the state ID a delta names its base with
+	static constexpr int32 NumStateIdBits = 8;
+
+	//~ Quantize the gathered movement of the server's pawn, with velocity fixed point over AxisSpeedLimit
+	void Set(const FRepMovement &Movement, bool bSprinting, bool bWantsToWalk, float AxisSpeedLimit);
+
+	//~ Unpack into the movement the character's OnRep_ReplicatedMovement reads
+	void Get(FRepMovement &OutMovement) const;
+
+	//~ True once per state received since the last call, false when the updates since only named a base this client missed
+	bool ConsumeReceivedState();
+
+	bool IsSprinting() const
+	{
+		return (Flags & Flag_Sprinting) != 0;
+	}
+
+	bool WantsToWalk() const
+	{
+		return (Flags & Flag_WantsToWalk) != 0;
+	}
+
+	//~ Same quantized values, so nothing would go on the wire
+	bool IsSameState(const FS_RepMovement &Other) const;
+
+	//~ Size on the wire without a base to take the difference from, header included
+	int64 GetWholeStateBits() const;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo &DeltaParms);
+
+private:
+	//~ Writes or reads this state as the difference from Base, or as a whole state without one
+	void SerializeState(FArchive &Ar, const FS_RepMovement *Base, bool &bOutSuccess);
+
+	uint8 Flags = 0;
+
+	//: Tenths of a unit
+	FIntVector Location = FIntVector::ZeroValue;
+
+	//: Fixed point, MaxAxisSpeed is 32767
+	int16 Velocity[3] = {0, 0, 0};
+	float MaxAxisSpeed = 0.0f;
+
+	//: FRotator::CompressAxisToShort
+	uint16 Yaw = 0;
+	uint16 Pitch = 0;
+	uint16 Roll = 0;
+
+	//: Used instead of the fields above with Flag_Fallback
+	FRepMovement Fallback;
+
+	//: Receiving side, the ID of the last state accepted and whether OnRep has seen it
+	uint8 ReceivedStateId = 0;
+	bool bHasReceivedState = false;
+	bool bReceivedStateUnread = false;
+};
+
+template <>
+struct TStructOpsTypeTraits<FS_RepMovement> : public TStructOpsTypeTraitsBase2<FS_RepMovement>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
@@ -0,0 +1,26 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "S_ReplayMovementCommandlet.generated.h"
+
+/**
+ * Replays a movement recording made with sv.movement.record on its map, headless, and reports how far the replayed
+ * pawn strays from the recorded trajectory and how long its movement took.
+ *
+ * -run=S_ReplayMovement -Recording=<file> [-Map=<package>] [-Tolerance=<cm>] [-Pawn=<class path>]
+ *
+ * Returns non-zero if the trajectory diverges by more than the tolerance.
+ */
+UCLASS()
+class COMBAX_API US_ReplayMovementCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	US_ReplayMovementCommandlet();
+
+	virtual int32 Main(const FString &Params) override;
+};
@@ -0,0 +1,93 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BasicReplicationGraph.h"
+#include "S_ReplicationGraph.generated.h"
+
+class US_ReplicationGraph;
+
+/**
+ * Keeps the per-connection replication of fast movers in step with how they move. Every frame it widens each
+ * character's cull distance by how far it could travel in CullLeadTime, so sprinting and bunnyhopping pawns are
+ * already relevant by the time they arrive, and puts it in a frequency bucket for each connection by its distance
+ * to that connection's viewer. Gathers nothing itself, the grid does that.
+ */
+UCLASS()
+class COMBAX_API US_ReplicationGraphNode_FastMovers : public UReplicationGraphNode
+{
+	GENERATED_BODY()
+
+public:
+	US_ReplicationGraphNode_FastMovers();
+
+	virtual void NotifyAddNetworkActor(const FNewReplicatedActorInfo &ActorInfo) override;
+	virtual bool NotifyRemoveNetworkActor(const FNewReplicatedActorInfo &ActorInfo, bool bWarnIfNotFound = true) override;
+	virtual void NotifyResetAllNetworkActors() override;
+	virtual void PrepareForReplication() override;
+	virtual void GatherActorListsForConnection(const FConnectionGatherActorListParameters &Params) override;
+
+	US_ReplicationGraph *Graph = nullptr;
+
+private:
+	//: Removed by the graph before they are destroyed
+	TArray<AActor *> Movers;
+};
+
+/**
+ * Replication graph for Combax. Pawns and projectiles go into the spatial grid of UBasicReplicationGraph, which
+ * treats dormant actors as static, so pooled projectiles cost nothing while they wait to be fired. Characters are
+ * also tracked by US_ReplicationGraphNode_FastMovers for velocity aware cull distances and per-connection frequency
+ * buckets. Set as the net driver's replication driver in DefaultEngine.ini.
+ */
+UCLASS(transient, config = Engine)
+class COMBAX_API US_ReplicationGraph : public UBasicReplicationGraph
+{
+	GENERATED_BODY()
+
+public:
+	virtual void InitGlobalActorClassSettings() override;
+	virtual void InitGlobalGraphNodes() override;
+	virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo &ActorInfo, FGlobalActorReplicationInfo &GlobalInfo) override;
+	virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo &ActorInfo) override;
+
+	//? Size of a spatial grid cell. Bigger cells mean fewer cells to visit per connection, smaller ones fewer actors per cell.
+	UPROPERTY(Config)
+	float GridCellSize = 10000.0f;
+
+	//? Characters are relevant this far away when standing still
+	UPROPERTY(Config)
+	float CharacterCullDistance = 15000.0f;
+
+	//? Seconds of movement added to a character's cull distance, so fast movers don't pop in
+	UPROPERTY(Config)
+	float CullLeadTime = 1.5f;
+
+	//? Cap on the velocity aware cull distance
+	UPROPERTY(Config)
+	float MaxCharacterCullDistance = 30000.0f;
+
+	//? Projectiles are small and short lived, nobody needs them from far away
+	UPROPERTY(Config)
+	float ProjectileCullDistance = 8000.0f;
+
+	//? Characters nearer than this to a connection's viewer replicate to it every frame
+	UPROPERTY(Config)
+	float NearFrequencyDistance = 3000.0f;
+
+	//? Characters further than this from a connection's viewer replicate to it every FarReplicationPeriod frames
+	UPROPERTY(Config)
+	float FarFrequencyDistance = 8000.0f;
+
+	//? Frames between updates in between the near and far distances
+	UPROPERTY(Config)
+	int32 MidReplicationPeriod = 2;
+
+	UPROPERTY(Config)
+	int32 FarReplicationPeriod = 4;
+
+private:
+	UPROPERTY()
+	US_ReplicationGraphNode_FastMovers *FastMoversNode;
+};
@@ -0,0 +1,103 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "S_SurfaceIndex.generated.h"
+
+class ULevel;
+class UPrimitiveComponent;
+
+//? Upward facing convex face of static simple collision, in world space. Box faces are kept whole as quads, convex
+//? hulls are indexed by their triangles. Doubles, so faces far from the origin keep their shape.
+struct FS_SurfaceFace
+{
+	static constexpr int32 MaxVertices = 4;
+
+	FVector Vertices[MaxVertices];
+	int32 NumVertices = 0;
+	FVector Normal = FVector::UpVector;
+
+	//: Compared against, never dereferenced
+	const UPrimitiveComponent *Component = nullptr;
+};
+
+/**
+ * Spatial index of the planar surfaces characters can land on. Built from the simple collision of static, pawn
+ * blocking geometry when the world begins play, and updated one level at a time as levels stream in or out. Faces are
+ * bucketed into a 2D grid so the movement component can ask what plane lies under the capsule without a physics query.
+ *
+ * Only box and convex collision is indexed. Components with complex-as-simple collision, a walkable slope override,
+ * or no simple collision are left to the physics queries.
+ */
+UCLASS()
+class COMBAX_API US_SurfaceIndex : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject *Outer) const override;
+	virtual void OnWorldBeginPlay(UWorld &InWorld) override;
+	virtual void Deinitialize() override;
+
+	//~ Throw the index away and rebuild it from the static geometry of every visible level
+	void Build();
+
+	//~ Index the static geometry of Level, replacing whatever was indexed for it before
+	void AddLevel(ULevel *Level);
+
+	//~ Drop the faces of Level from the index
+	void RemoveLevel(const ULevel *Level);
+
+	//~ Face of Component whose plane passes through SurfacePoint and which, seen from above, contains the whole circle
+	//~ of Radius around Center. Null if there is none and physics has to be asked instead.
+	const FS_SurfaceFace *FindFace(const UPrimitiveComponent *Component, const FVector &SurfacePoint, const FVector &Center, float Radius) const;
+
+	int32 NumFaces() const;
+
+	int32 NumCells() const
+	{
+		return Cells.Num();
+	}
+
+	int32 NumLevels() const
+	{
+		return Levels.Num();
+	}
+
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	void OnLevelAdded(ULevel *Level, UWorld *InWorld);
+	void OnLevelRemoved(ULevel *Level, UWorld *InWorld);
+
+	//? Faces of one level, and the cells they were bucketed into so they can be taken out again
+	struct FLevelSurfaces
+	{
+		const ULevel *Level = nullptr;
+		TArray<FS_SurfaceFace> Faces;
+		TArray<FIntPoint> Cells;
+		int32 NumComponents = 0;
+	};
+
+	//? Face Face of Levels[Level]
+	struct FFaceRef
+	{
+		int32 Level = INDEX_NONE;
+		int32 Face = INDEX_NONE;
+	};
+
+	void AddComponent(FLevelSurfaces &Surfaces, UPrimitiveComponent *Component);
+	void AddFace(FLevelSurfaces &Surfaces, TArrayView<const FVector> Vertices, const FVector &Inside, const UPrimitiveComponent *Component);
+
+	FIntPoint GetCell(double X, double Y) const;
+
+	//: Sparse, so the face references of other levels stay valid as levels come and go
+	TSparseArray<FLevelSurfaces> Levels;
+
+	TMap<FIntPoint, TArray<FFaceRef>> Cells;
+
+	FDelegateHandle LevelAddedHandle;
+	FDelegateHandle LevelRemovedHandle;
+};
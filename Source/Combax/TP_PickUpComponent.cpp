@@ -18,8 +18,8 @@ void UTP_PickUpComponent::BeginPlay()
 
 void UTP_PickUpComponent::OnSphereBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
 {
-	// Checking if it is a First Person Character overlapping
-	ACombaxCharacter* Character = Cast<ACombaxCharacter>(OtherActor);
+	// Checking if it is a character overlapping, either the template one or AS_Character
+	ACharacter* Character = Cast<ACharacter>(OtherActor);
 	if(Character != nullptr)
 	{
 		// Notify that the actor is being picked up
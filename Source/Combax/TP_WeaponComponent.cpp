@@ -4,12 +4,28 @@
 #include "TP_WeaponComponent.h"
 #include "CombaxCharacter.h"
 #include "CombaxProjectile.h"
+#include "CombaxProjectileManager.h"
+#include "CombaxProjectilePool.h"
+#include "Player/S_Character.h"
 #include "GameFramework/PlayerController.h"
-#include "Camera/PlayerCameraManager.h"
 #include "Kismet/GameplayStatics.h"
 #include "EnhancedInputComponent.h"
 #include "EnhancedInputSubsystems.h"
 
+// First person arms of either character class, the third person mesh of any other character
+static USkeletalMeshComponent* GetArmsMesh(ACharacter* Character)
+{
+	if (ACombaxCharacter* CombaxCharacter = Cast<ACombaxCharacter>(Character))
+	{
+		return CombaxCharacter->GetMesh1P();
+	}
+	if (AS_Character* SourceCharacter = Cast<AS_Character>(Character))
+	{
+		return SourceCharacter->GetMesh1P();
+	}
+	return Character->GetMesh();
+}
+
 // Sets default values for this component's properties
 UTP_WeaponComponent::UTP_WeaponComponent()
 {
@@ -31,17 +47,32 @@ void UTP_WeaponComponent::Fire()
 		UWorld* const World = GetWorld();
 		if (World != nullptr)
 		{
-			APlayerController* PlayerController = Cast<APlayerController>(Character->GetController());
-			const FRotator SpawnRotation = PlayerController->PlayerCameraManager->GetCameraRotation();
+			// Aim where the controller looks, so bots and other controllers without a camera manager fire too
+			const FRotator SpawnRotation = Character->GetControlRotation();
 			// MuzzleOffset is in camera space, so transform it to world space before offsetting from the character location to find the final muzzle position
 			const FVector SpawnLocation = GetOwner()->GetActorLocation() + SpawnRotation.RotateVector(MuzzleOffset);
 	
-			//Set Spawn Collision Handling Override
-			FActorSpawnParameters ActorSpawnParams;
-			ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
-	
-			// Spawn the projectile at the muzzle
-			World->SpawnActor<ACombaxProjectile>(ProjectileClass, SpawnLocation, SpawnRotation, ActorSpawnParams);
+			UCombaxProjectileManager* ProjectileManager = World->GetSubsystem<UCombaxProjectileManager>();
+			UCombaxProjectilePool* Pool = World->GetSubsystem<UCombaxProjectilePool>();
+			if (bLightweightProjectiles && ProjectileManager != nullptr)
+			{
+				// No actor at all, just a struct the manager steps and draws
+				ProjectileManager->Fire(ProjectileClass, LightweightProjectileMesh, SpawnLocation, SpawnRotation);
+			}
+			else if (Pool != nullptr && UCombaxProjectilePool::IsPoolingEnabled())
+			{
+				// Launch a recycled projectile from the muzzle
+				Pool->Acquire(ProjectileClass, SpawnLocation, SpawnRotation);
+			}
+			else
+			{
+				//Set Spawn Collision Handling Override
+				FActorSpawnParameters ActorSpawnParams;
+				ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
+
+				// Spawn the projectile at the muzzle
+				World->SpawnActor<ACombaxProjectile>(ProjectileClass, SpawnLocation, SpawnRotation, ActorSpawnParams);
+			}
 		}
 	}
 	
@@ -55,7 +86,8 @@ void UTP_WeaponComponent::Fire()
 	if (FireAnimation != nullptr)
 	{
 		// Get the animation object for the arms mesh
-		UAnimInstance* AnimInstance = Character->GetMesh1P()->GetAnimInstance();
+		USkeletalMeshComponent* ArmsMesh = GetArmsMesh(Character);
+		UAnimInstance* AnimInstance = ArmsMesh != nullptr ? ArmsMesh->GetAnimInstance() : nullptr;
 		if (AnimInstance != nullptr)
 		{
 			AnimInstance->Montage_Play(FireAnimation, 1.f);
@@ -63,7 +95,7 @@ void UTP_WeaponComponent::Fire()
 	}
 }
 
-void UTP_WeaponComponent::AttachWeapon(ACombaxCharacter* TargetCharacter)
+void UTP_WeaponComponent::AttachWeapon(ACharacter* TargetCharacter)
 {
 	Character = TargetCharacter;
 	if (Character == nullptr)
@@ -73,10 +105,20 @@ void UTP_WeaponComponent::AttachWeapon(ACombaxCharacter* TargetCharacter)
 
 	// Attach the weapon to the First Person Character
 	FAttachmentTransformRules AttachmentRules(EAttachmentRule::SnapToTarget, true);
-	AttachToComponent(Character->GetMesh1P(), AttachmentRules, FName(TEXT("GripPoint")));
+	AttachToComponent(GetArmsMesh(Character), AttachmentRules, FName(TEXT("GripPoint")));
 	
 	// switch bHasRifle so the animation blueprint can switch to another animation set
-	Character->SetHasRifle(true);
+	if (ACombaxCharacter* CombaxCharacter = Cast<ACombaxCharacter>(Character))
+	{
+		CombaxCharacter->SetHasRifle(true);
+	}
+
+	// Have projectiles ready before the first shot
+	UCombaxProjectilePool* Pool = GetWorld()->GetSubsystem<UCombaxProjectilePool>();
+	if (Pool != nullptr && !bLightweightProjectiles)
+	{
+		Pool->Prewarm(ProjectileClass, PoolPrewarmCount);
+	}
 
 	// Set up action bindings
 	if (APlayerController* PlayerController = Cast<APlayerController>(Character->GetController()))
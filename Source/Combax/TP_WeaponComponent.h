@@ -6,7 +6,8 @@
 #include "Components/SkeletalMeshComponent.h"
 #include "TP_WeaponComponent.generated.h"
 
-class ACombaxCharacter;
+class ACharacter;
+class UStaticMesh;
 
 UCLASS(Blueprintable, BlueprintType, ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class COMBAX_API UTP_WeaponComponent : public USkeletalMeshComponent
@@ -26,6 +27,18 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
 	UAnimMontage* FireAnimation;
 
+	//** Simulate projectiles as lightweight structs in UCombaxProjectileManager instead of spawning actors */
+	UPROPERTY(EditDefaultsOnly, Category=Projectile)
+	bool bLightweightProjectiles = false;
+
+	//** Mesh drawn for each lightweight projectile */
+	UPROPERTY(EditDefaultsOnly, Category=Projectile, meta=(EditCondition = "bLightweightProjectiles"))
+	UStaticMesh* LightweightProjectileMesh = nullptr;
+
+	//** Projectiles pooled ahead of time when the weapon is picked up */
+	UPROPERTY(EditDefaultsOnly, Category=Projectile, meta=(ClampMin = "0"))
+	int32 PoolPrewarmCount = 32;
+
 	//** Gun muzzle's offset from the characters location */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Gameplay)
 	FVector MuzzleOffset;
@@ -41,9 +54,9 @@ public:
 	//** Sets default values for this component's properties */
 	UTP_WeaponComponent();
 
-	//** Attaches the actor to a FirstPersonCharacter */
+	//** Attaches the actor to a character, to its first person arms if it has them */
 	UFUNCTION(BlueprintCallable, Category="Weapon")
-	void AttachWeapon(ACombaxCharacter* TargetCharacter);
+	void AttachWeapon(ACharacter* TargetCharacter);
 
 	//** Make the weapon Fire a Projectile */
 	UFUNCTION(BlueprintCallable, Category="Weapon")
@@ -56,5 +69,5 @@ protected:
 
 private:
 	//** The Character holding this weapon*/
-	ACombaxCharacter* Character;
+	ACharacter* Character;
 };
@@ -0,0 +1,153 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/Engine.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "Components/StaticMeshComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "Player/S_Character.h"
+#include "Player/S_CharacterMovement.h"
+#include "UObject/UnrealType.h"
+
+/**
+ * Empty game world for headless tests, ticked by hand at whatever frame time a test asks for so results don't depend
+ * on how fast the machine running them is. Game world subsystems such as US_MovementManager are created and begin
+ * play with it. Destroyed with the helper.
+ */
+class FCombaxTestWorld
+{
+public:
+	FCombaxTestWorld()
+	{
+		World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("CombaxTestWorld"));
+		FWorldContext &Context = GEngine->CreateNewWorldContext(EWorldType::Game);
+		Context.SetCurrentWorld(World);
+
+		World->InitializeActorsForPlay(FURL());
+		World->BeginPlay();
+	}
+
+	~FCombaxTestWorld()
+	{
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	}
+
+	FCombaxTestWorld(const FCombaxTestWorld &) = delete;
+	FCombaxTestWorld &operator=(const FCombaxTestWorld &) = delete;
+
+	UWorld *Get() const
+	{
+		return World;
+	}
+
+	//~ Ticks the world Frames times with a fixed frame time
+	void Tick(float DeltaTime, int32 Frames = 1)
+	{
+		for (int32 Frame = 0; Frame < Frames; ++Frame)
+		{
+			World->Tick(LEVELTICK_All, DeltaTime);
+			++GFrameCounter;
+		}
+	}
+
+	//~ Ticks for at least Seconds of game time
+	void TickFor(float Seconds, float DeltaTime)
+	{
+		Tick(DeltaTime, FMath::CeilToInt(Seconds / DeltaTime));
+	}
+
+	//~ Movable basic cube centred on Location. The cube is 100 units on a side before Scale.
+	AStaticMeshActor *SpawnCube(const FVector &Location, const FVector &Scale)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		AStaticMeshActor *Cube = World->SpawnActor<AStaticMeshActor>(Location, FRotator::ZeroRotator, SpawnParams);
+		if (!Cube)
+		{
+			return nullptr;
+		}
+
+		Cube->GetStaticMeshComponent()->SetMobility(EComponentMobility::Movable);
+		Cube->GetStaticMeshComponent()->SetStaticMesh(LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube")));
+		Cube->SetActorScale3D(Scale);
+		return Cube;
+	}
+
+	//~ Cube floor with its top at Z 0
+	AStaticMeshActor *SpawnFloor(const FVector &Scale)
+	{
+		return SpawnCube(FVector(0.0f, 0.0f, -50.0f * Scale.Z), Scale);
+	}
+
+	//~ Pawn at Location moved without a controller. Null if it or its movement component failed to spawn.
+	AS_Character *SpawnPawn(const FVector &Location)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		AS_Character *Character = World->SpawnActor<AS_Character>(AS_Character::StaticClass(), Location, FRotator::ZeroRotator, SpawnParams);
+		if (!Character || !Character->GetMovementPtr())
+		{
+			return nullptr;
+		}
+
+		Character->GetMovementPtr()->bRunPhysicsWithNoController = true;
+		return Character;
+	}
+
+private:
+	UWorld *World = nullptr;
+};
+
+//~ Set a tunable the component keeps protected through reflection, the way the editor would. Returns false if Object
+//~ has no property Name of TValue's size.
+template <typename TValue>
+bool SetTestProperty(UObject *Object, FName Name, const TValue &Value)
+{
+	FProperty *Property = Object ? FindFProperty<FProperty>(Object->GetClass(), Name) : nullptr;
+	if (!Property || Property->ElementSize != sizeof(TValue))
+	{
+		return false;
+	}
+	Property->CopySingleValue(Property->ContainerPtrToValuePtr<void>(Object), &Value);
+	return true;
+}
+
+//? Sets a console variable for the life of the scope and puts the old value back after
+struct FS_ScopedConsoleVariable
+{
+	FS_ScopedConsoleVariable(const TCHAR *Name, int32 Value)
+		: Variable(IConsoleManager::Get().FindConsoleVariable(Name))
+	{
+		if (Variable)
+		{
+			OldValue = Variable->GetInt();
+			Variable->Set(Value, ECVF_SetByCode);
+		}
+	}
+
+	~FS_ScopedConsoleVariable()
+	{
+		if (Variable)
+		{
+			Variable->Set(OldValue, ECVF_SetByCode);
+		}
+	}
+
+	void Set(int32 Value)
+	{
+		if (Variable)
+		{
+			Variable->Set(Value, ECVF_SetByCode);
+		}
+	}
+
+private:
+	IConsoleVariable *Variable = nullptr;
+	int32 OldValue = 0;
+};
@@ -0,0 +1,6 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Modules/ModuleManager.h"
+
+//: Automation tests only, run them with Automation RunTests Combax
+IMPLEMENT_MODULE(FDefaultModuleImpl, CombaxTests);
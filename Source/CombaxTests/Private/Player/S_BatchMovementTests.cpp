@@ -0,0 +1,227 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CombaxTestWorld.h"
+#include "Player/S_Character.h"
+#include "Player/S_CharacterMovement.h"
+#include "Player/S_MovementManager.h"
+#include "Player/S_MoveKernel.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+static constexpr float BatchTestFrameTime = 1.0f / 60.0f;
+static constexpr int32 BatchTestFrames = 120;
+
+//? What the movers spent on their velocity step over one run
+struct FS_BatchTestRun
+{
+	double Seconds = 0.0;
+	int32 CalcVelocityCalls = 0;
+	int32 Hits = 0;
+	int32 Misses = 0;
+};
+
+//~ Walks every pawn in its own direction for a run of frames and sums their CalcVelocity time, plus the manager's batch
+//~ time when batching is on
+static FS_BatchTestRun RunBatchTestFrames(FCombaxTestWorld &World, const TArray<AS_Character *> &Characters)
+{
+	US_MovementManager *Manager = World.Get()->GetSubsystem<US_MovementManager>();
+	for (AS_Character *Character : Characters)
+	{
+		Character->GetMovementPtr()->ResetMovementCounters();
+	}
+	Manager->ResetBatchSeconds();
+
+	for (int32 Frame = 0; Frame < BatchTestFrames; ++Frame)
+	{
+		for (int32 Index = 0; Index < Characters.Num(); ++Index)
+		{
+			const FRotator Facing(0.0f, Index * 37.0f + Frame * 3.0f, 0.0f);
+			Characters[Index]->AddMovementInput(Facing.Vector(), Frame % 40 < 30 ? 1.0f : 0.0f);
+		}
+		World.Tick(BatchTestFrameTime);
+	}
+
+	FS_BatchTestRun Run;
+	Run.Seconds = Manager->GetBatchSeconds();
+	for (AS_Character *Character : Characters)
+	{
+		const FS_MovementCounters &Counters = Character->GetMovementPtr()->GetMovementCounters();
+		Run.Seconds += Counters.CalcVelocitySeconds;
+		Run.CalcVelocityCalls += Counters.CalcVelocityCalls;
+		Run.Hits += Counters.BatchedVelocityHits;
+		Run.Misses += Counters.BatchedVelocityMisses;
+	}
+	return Run;
+}
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FS_BatchMovementTest, "Combax.Movement.BatchVelocity", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+void FS_BatchMovementTest::GetTests(TArray<FString> &OutBeautifiedNames, TArray<FString> &OutTestCommands) const
+{
+	for (const int32 Count : {64, 256, 1024})
+	{
+		OutBeautifiedNames.Add(FString::Printf(TEXT("%d pawns"), Count));
+		OutTestCommands.Add(FString::FromInt(Count));
+	}
+}
+
+//~ Walks the same pawns through the per-component CalcVelocity and then through sv.batchmovement, logging the cost of
+//~ each per pawn and frame. The batched cost includes the gather and scatter, and the scalar kernel pawns still run
+//~ after a discarded batched step.
+bool FS_BatchMovementTest::RunTest(const FString &Parameters)
+{
+	const int32 Count = FCString::Atoi(*Parameters);
+
+	FS_ScopedConsoleVariable Timing(TEXT("sv.movement.counters"), 1);
+	FS_ScopedConsoleVariable Batching(TEXT("sv.batchmovement"), 0);
+
+	FCombaxTestWorld World;
+	if (!TestNotNull(TEXT("Spawned floor"), World.SpawnFloor(FVector(200.0f, 200.0f, 1.0f))))
+	{
+		return false;
+	}
+
+	//: A grid wide enough apart that pawns only now and then walk into each other
+	const int32 Columns = FMath::CeilToInt(FMath::Sqrt(float(Count)));
+	TArray<AS_Character *> Characters;
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		const FVector Location((Index % Columns - Columns / 2) * 250.0f, (Index / Columns - Columns / 2) * 250.0f, 100.0f);
+		AS_Character *Character = World.SpawnPawn(Location);
+		if (!TestNotNull(TEXT("Spawned pawn"), Character))
+		{
+			return false;
+		}
+		Characters.Add(Character);
+	}
+
+	//: Land everyone first so both runs start on the ground
+	World.TickFor(0.5f, BatchTestFrameTime);
+
+	const FS_BatchTestRun Scalar = RunBatchTestFrames(World, Characters);
+	Batching.Set(1);
+	const FS_BatchTestRun Batched = RunBatchTestFrames(World, Characters);
+
+	const double Frames = double(BatchTestFrames);
+	AddInfo(FString::Printf(TEXT("%d pawns: per-component %.3f us per pawn per frame, batched %.3f us (%.2fx), %d of %d batched steps used"), Count,
+							Scalar.Seconds * 1e6 / Count / Frames, Batched.Seconds * 1e6 / Count / Frames, Scalar.Seconds / FMath::Max(Batched.Seconds, SMALL_NUMBER),
+							Batched.Hits, Batched.Hits + Batched.Misses));
+
+	TestTrue(TEXT("Velocity stepped in both runs"), Scalar.CalcVelocityCalls > 0 && Batched.CalcVelocityCalls > 0);
+	TestEqual(TEXT("Batched steps without sv.batchmovement"), Scalar.Hits + Scalar.Misses, 0);
+	TestTrue(FString::Printf(TEXT("Most batched steps used, %d discarded"), Batched.Misses), Batched.Hits > Batched.Misses);
+	return true;
+}
+
+//? One mover of the lane test, stepped through the batch and on its own
+struct FS_LaneTestCase
+{
+	const TCHAR *Name;
+	FVector Velocity;
+	FVector Acceleration;
+	float SurfaceFriction;
+	bool bIsGroundMove;
+	bool bFluid;
+
+	//? Whether the step should change the velocity at all
+	bool bActive;
+};
+
+//: Max speed and full input acceleration of the default movement component
+static constexpr float LaneTestMaxSpeed = 361.9f;
+static constexpr float LaneTestAcceleration = 857.25f;
+static constexpr float LaneTestTolerance = 0.01f;
+
+static const FS_LaneTestCase LaneTestCases[] = {
+	{TEXT("ground accelerate from rest"), FVector(0.0f), FVector(LaneTestAcceleration, 0.0f, 0.0f), 1.0f, true, false, true},
+	{TEXT("ground accelerate while veering"), FVector(200.0f, 150.0f, 0.0f), FVector(0.0f, LaneTestAcceleration, 0.0f), 1.0f, true, false, true},
+	{TEXT("ground friction"), FVector(300.0f, -100.0f, 0.0f), FVector(0.0f), 1.0f, true, false, true},
+	{TEXT("ground friction on a slippery surface"), FVector(-250.0f, 0.0f, 0.0f), FVector(0.0f), 0.25f, true, false, true},
+	{TEXT("ground braking held at max speed"), FVector(370.0f, 0.0f, 0.0f), FVector(LaneTestAcceleration, 0.0f, 0.0f), 1.0f, true, false, true},
+	{TEXT("ground at rest"), FVector(0.0f), FVector(0.0f), 1.0f, true, false, false},
+	{TEXT("air accelerate clamped to the air speed cap"), FVector(0.0f, 0.0f, -200.0f), FVector(0.0f, LaneTestAcceleration, 0.0f), 1.0f, false, false, true},
+	{TEXT("air strafe"), FVector(400.0f, 0.0f, -50.0f), FVector(-300.0f, LaneTestAcceleration, 0.0f), 1.0f, false, false, true},
+	{TEXT("air already past the air speed cap"), FVector(0.0f, 400.0f, 0.0f), FVector(0.0f, LaneTestAcceleration, 0.0f), 1.0f, false, false, false},
+	{TEXT("air without input"), FVector(100.0f, 0.0f, -300.0f), FVector(0.0f), 1.0f, false, false, false},
+	{TEXT("ground in a fluid"), FVector(200.0f, 0.0f, 0.0f), FVector(LaneTestAcceleration, 0.0f, 0.0f), 1.0f, true, true, true},
+};
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FS_BatchLanesTest, "Combax.Movement.BatchLanes", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+//~ Steps a batch that mixes ground and air movers, accelerating and idle ones, and a fluid mover that sends its group of
+//~ four down the scalar path, then expects every lane to match CalcVelocity on the same mover
+bool FS_BatchLanesTest::RunTest(const FString &Parameters)
+{
+	const FSourceMoveSettings Settings;
+	constexpr int32 NumCases = UE_ARRAY_COUNT(LaneTestCases);
+
+	int32 Failures = 0;
+	for (const float DeltaTime : {1.0f / 144.0f, 1.0f / 60.0f, 1.0f / 20.0f})
+	{
+		//: Striding through the cases puts each one in every lane of a group, with a few leftovers past the last group
+		FSourceMoveBatch Batch;
+		TArray<FSourceMoveState> Expected;
+		TArray<int32> Cases;
+		for (int32 Index = 0; Index < NumCases * 4 + 3; ++Index)
+		{
+			const int32 CaseIndex = Index * 5 % NumCases;
+			const FS_LaneTestCase &Case = LaneTestCases[CaseIndex];
+
+			FSourceMoveState State;
+			State.Velocity = Case.Velocity;
+			State.Acceleration = Case.Acceleration;
+			State.SurfaceFriction = Case.SurfaceFriction;
+
+			FSourceMoveInput Input;
+			Input.DeltaTime = DeltaTime;
+			Input.Friction = 8.0f;
+			Input.BrakingFriction = 4.0f;
+			Input.BrakingDeceleration = 190.5f;
+			Input.MaxSpeed = LaneTestMaxSpeed;
+			Input.bIsGroundMove = Case.bIsGroundMove;
+			Input.bFluid = Case.bFluid;
+
+			Batch.Add(State, Input);
+			FSourceMoveKernel::CalcVelocity(State, Input, Settings);
+			Expected.Add(State);
+			Cases.Add(CaseIndex);
+		}
+
+		FSourceMoveKernel::AdvanceBatch(Batch, DeltaTime, Settings);
+
+		for (int32 Index = 0; Index < Batch.Num(); ++Index)
+		{
+			const FS_LaneTestCase &Case = LaneTestCases[Cases[Index]];
+			FSourceMoveState State;
+			Batch.GetState(Index, State);
+
+			if (!State.Velocity.Equals(Expected[Index].Velocity, LaneTestTolerance) || !State.Acceleration.Equals(Expected[Index].Acceleration, LaneTestTolerance))
+			{
+				++Failures;
+				AddInfo(FString::Printf(TEXT("dt %.4f, lane %d, %s: velocity %s against %s"), DeltaTime, Index, Case.Name, *State.Velocity.ToString(),
+										*Expected[Index].Velocity.ToString()));
+			}
+			if (Index < NumCases)
+			{
+				TestEqual(FString::Printf(TEXT("%s changed the velocity"), Case.Name), !Expected[Index].Velocity.Equals(Case.Velocity, LaneTestTolerance), Case.bActive);
+			}
+		}
+
+		//: The clamp lane starts with no horizontal speed, so all it may gain in a frame is the cap
+		const FS_LaneTestCase &CapCase = LaneTestCases[6];
+		FSourceMoveState CapState;
+		CapState.Velocity = CapCase.Velocity;
+		CapState.Acceleration = CapCase.Acceleration;
+		FSourceMoveInput CapInput;
+		CapInput.DeltaTime = DeltaTime;
+		CapInput.MaxSpeed = LaneTestMaxSpeed;
+		FSourceMoveKernel::CalcVelocity(CapState, CapInput, Settings);
+		TestTrue(FString::Printf(TEXT("Air speed gained in %.4f s within the cap"), DeltaTime), CapState.Velocity.Size2D() <= Settings.AirSpeedCap + LaneTestTolerance);
+	}
+
+	TestEqual(TEXT("Batched lanes off the scalar step"), Failures, 0);
+	return true;
+}
+
+#endif
@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Player/S_MoveKernel.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+//: Ground friction and braking deceleration of the default movement component
+static constexpr float BrakingTestFriction = 4.0f;
+static constexpr float BrakingTestDeceleration = 190.5f;
+
+static const float BrakingTestFrameTimes[] = {1.0f / 300.0f, 1.0f / 144.0f, 1.0f / 60.0f, 1.0f / 30.0f, 1.0f / 20.0f, 1.0f / 10.0f};
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FS_ClosedFormBrakingTest, "Combax.Movement.ClosedFormBraking.Scalar", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+//~ Brakes a sweep of speeds, directions and frame times both ways and expects the closed form within tolerance of the substeps
+bool FS_ClosedFormBrakingTest::RunTest(const FString &Parameters)
+{
+	FSourceMoveSettings LoopSettings;
+	LoopSettings.bClosedFormBraking = false;
+	FSourceMoveSettings ClosedFormSettings;
+	ClosedFormSettings.bClosedFormBraking = true;
+
+	int32 Checks = 0;
+	int32 Failures = 0;
+	for (const float DeltaTime : BrakingTestFrameTimes)
+	{
+		for (float Yaw = 0.0f; Yaw < 360.0f; Yaw += 22.5f)
+		{
+			const FVector Direction = FRotator(0.0f, Yaw, 0.0f).Vector();
+			for (float Speed = 0.5f; Speed <= 6000.0f; Speed *= 1.1f)
+			{
+				FVector LoopVelocity = Direction * Speed;
+				FVector ClosedFormVelocity = Direction * Speed;
+				const int32 LoopSteps = FSourceMoveKernel::ApplyBraking(LoopVelocity, DeltaTime, BrakingTestFriction, BrakingTestDeceleration, LoopSettings);
+				const int32 ClosedFormSteps = FSourceMoveKernel::ApplyBraking(ClosedFormVelocity, DeltaTime, BrakingTestFriction, BrakingTestDeceleration, ClosedFormSettings);
+
+				++Checks;
+				const float Error = (LoopVelocity - ClosedFormVelocity).Size();
+				if (Error > FSourceMoveKernel::GetClosedFormBrakingTolerance(Speed) || (LoopSteps == 0) != (ClosedFormSteps == 0))
+				{
+					++Failures;
+					AddInfo(FString::Printf(TEXT("dt %.4f, speed %.2f, yaw %.1f: %s against %s"), DeltaTime, Speed, Yaw, *ClosedFormVelocity.ToString(), *LoopVelocity.ToString()));
+				}
+			}
+		}
+	}
+
+	TestEqual(FString::Printf(TEXT("Brakes over tolerance out of %d"), Checks), Failures, 0);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FS_ClosedFormBrakingBatchTest, "Combax.Movement.ClosedFormBraking.Batch", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+//~ Same comparison through the vectorized batch, with some movers accelerating so lanes mix braking and not braking
+bool FS_ClosedFormBrakingBatchTest::RunTest(const FString &Parameters)
+{
+	FSourceMoveSettings LoopSettings;
+	LoopSettings.bClosedFormBraking = false;
+	FSourceMoveSettings ClosedFormSettings;
+	ClosedFormSettings.bClosedFormBraking = true;
+
+	FRandomStream Random(7);
+	int32 Failures = 0;
+	for (const float DeltaTime : BrakingTestFrameTimes)
+	{
+		FSourceMoveBatch LoopBatch;
+		TArray<float> StartSpeeds;
+		for (int32 Index = 0; Index < 64; ++Index)
+		{
+			FSourceMoveState State;
+			State.Velocity = FVector(Random.FRandRange(-1.0f, 1.0f), Random.FRandRange(-1.0f, 1.0f), 0.0f).GetSafeNormal() * Random.FRandRange(0.0f, 1500.0f);
+			State.Acceleration = Index % 3 == 0 ? FVector(857.25f, 0.0f, 0.0f) : FVector::ZeroVector;
+
+			FSourceMoveInput Input;
+			Input.DeltaTime = DeltaTime;
+			Input.Friction = BrakingTestFriction;
+			Input.BrakingFriction = BrakingTestFriction;
+			Input.BrakingDeceleration = BrakingTestDeceleration;
+			Input.MaxSpeed = 361.9f;
+			Input.bIsGroundMove = Index % 7 != 0;
+
+			LoopBatch.Add(State, Input);
+			StartSpeeds.Add(State.Velocity.Size());
+		}
+		FSourceMoveBatch ClosedFormBatch = LoopBatch;
+
+		FSourceMoveKernel::AdvanceBatch(LoopBatch, DeltaTime, LoopSettings);
+		FSourceMoveKernel::AdvanceBatch(ClosedFormBatch, DeltaTime, ClosedFormSettings);
+
+		for (int32 Index = 0; Index < LoopBatch.Num(); ++Index)
+		{
+			FSourceMoveState LoopState;
+			FSourceMoveState ClosedFormState;
+			LoopBatch.GetState(Index, LoopState);
+			ClosedFormBatch.GetState(Index, ClosedFormState);
+
+			const float Error = (LoopState.Velocity - ClosedFormState.Velocity).Size();
+			if (Error > FSourceMoveKernel::GetClosedFormBrakingTolerance(StartSpeeds[Index]))
+			{
+				++Failures;
+				AddInfo(FString::Printf(TEXT("dt %.4f, mover %d: %s against %s"), DeltaTime, Index, *ClosedFormState.Velocity.ToString(), *LoopState.Velocity.ToString()));
+			}
+		}
+	}
+
+	TestEqual(TEXT("Batched movers over tolerance"), Failures, 0);
+	return true;
+}
+
+#endif
@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CombaxTestWorld.h"
+#include "Components/CapsuleComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "Player/S_Character.h"
+#include "Player/S_CharacterMovement.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+static constexpr float FallTestFrameTime = 1.0f / 60.0f;
+static constexpr float FallTestSeconds = 1.0f;
+static const FVector FallTestStart(0.0f, 0.0f, 100000.0f);
+
+//~ Drops a pawn from high up, with a dynamic pillar Gap units beside its path if Gap is positive, and returns how many of
+//~ its falling sweeps were skipped
+static int32 RunFallClearance(FAutomationTestBase &Test, float Gap)
+{
+	FCombaxTestWorld World;
+	AS_Character *Character = World.SpawnPawn(FallTestStart);
+	if (!Test.TestNotNull(TEXT("Spawned pawn"), Character))
+	{
+		return INDEX_NONE;
+	}
+	US_CharacterMovement *Movement = Character->GetMovementPtr();
+	Movement->SetMovementMode(MOVE_Falling);
+
+	if (Gap > 0.0f)
+	{
+		//: The basic cube is 100 units on a side. Not a registered mover, and far enough out that the pawn never touches it.
+		float Radius, HalfHeight;
+		Character->GetCapsuleComponent()->GetScaledCapsuleSize(Radius, HalfHeight);
+		AStaticMeshActor *Pillar = World.SpawnCube(FallTestStart + FVector(Radius + Gap + 50.0f, 0.0f, 0.0f), FVector(1.0f, 1.0f, 100.0f));
+		if (!Test.TestNotNull(TEXT("Spawned pillar"), Pillar))
+		{
+			return INDEX_NONE;
+		}
+		Pillar->GetStaticMeshComponent()->SetCollisionProfileName(UCollisionProfile::BlockAllDynamic_ProfileName);
+	}
+
+	World.TickFor(FallTestSeconds, FallTestFrameTime);
+	Test.TestTrue(TEXT("Pawn fell"), Movement->IsFalling() && Character->GetActorLocation().Z < FallTestStart.Z - 100.0f);
+	return Movement->GetMovementCounters().FallSweepsSkipped;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FS_FallClearanceDynamicTest, "Combax.Movement.FallClearance.Dynamic", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+//~ Falling through empty space skips sweeps, but not with a dynamic object the manager doesn't move close enough to get
+//~ in the way within a frame, even though nothing was inside the clearance box when it was queried
+bool FS_FallClearanceDynamicTest::RunTest(const FString &Parameters)
+{
+	FS_ScopedConsoleVariable FallSweeps(TEXT("sv.batchfallsweeps"), 1);
+
+	const int32 OpenSkipped = RunFallClearance(*this, 0.0f);
+	const int32 NearSkipped = RunFallClearance(*this, 40.0f);
+	AddInfo(FString::Printf(TEXT("Sweeps skipped in the open %d, next to a dynamic pillar %d"), OpenSkipped, NearSkipped));
+
+	TestTrue(TEXT("Sweeps skipped in the open"), OpenSkipped > 0);
+	TestEqual(TEXT("Sweeps skipped next to a dynamic pillar"), NearSkipped, 0);
+	return true;
+}
+
+#endif
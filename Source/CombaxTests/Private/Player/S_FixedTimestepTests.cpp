@@ -0,0 +1,120 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CombaxTestWorld.h"
+#include "Player/S_Character.h"
+#include "Player/S_CharacterMovement.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+//: 64 doesn't divide evenly into any of the frame rates, so every run ends part way into a step
+static constexpr float FixedTestTickRate = 64.0f;
+static constexpr float FixedTestSeconds = 2.0f / 3.0f;
+
+//~ Pawn standing just above a wide floor, moved without a controller in fixed steps
+static AS_Character *SpawnFixedStepPawn(FCombaxTestWorld &World)
+{
+	if (!World.SpawnFloor(FVector(100.0f, 100.0f, 1.0f)))
+	{
+		return nullptr;
+	}
+
+	//: Start in the air so the runs also go through a landing
+	AS_Character *Character = World.SpawnPawn(FVector(0.0f, 0.0f, 150.0f));
+	if (!Character)
+	{
+		return nullptr;
+	}
+
+	US_CharacterMovement *Movement = Character->GetMovementPtr();
+	Movement->SetUseFixedTimestep(true);
+	SetTestProperty(Movement, TEXT("FixedTickRate"), FixedTestTickRate);
+	return Character;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FS_FixedTimestepDeterminismTest, "Combax.Movement.FixedTimestep.Determinism", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+//~ Holds the same input for the same game time at 30, 60, 144 and 300 fps and expects the pawn to end up in the same place,
+//~ since each run takes the same number of fixed steps and only the leftover time in the accumulator differs
+bool FS_FixedTimestepDeterminismTest::RunTest(const FString &Parameters)
+{
+	const float FrameRates[] = {30.0f, 60.0f, 144.0f, 300.0f};
+
+	TArray<FVector> FinalLocations;
+	for (const float FrameRate : FrameRates)
+	{
+		FCombaxTestWorld World;
+		AS_Character *Character = SpawnFixedStepPawn(World);
+		if (!TestNotNull(TEXT("Spawned pawn"), Character))
+		{
+			return false;
+		}
+
+		const float DeltaTime = 1.0f / FrameRate;
+		const int32 Frames = FMath::RoundToInt(FixedTestSeconds * FrameRate);
+		for (int32 Frame = 0; Frame < Frames; ++Frame)
+		{
+			Character->AddMovementInput(FVector::ForwardVector, 1.0f);
+			Character->AddMovementInput(FVector::RightVector, 0.5f);
+			World.Tick(DeltaTime);
+		}
+
+		FinalLocations.Add(Character->GetActorLocation());
+		AddInfo(FString::Printf(TEXT("%.0f fps: %s"), FrameRate, *FinalLocations.Last().ToString()));
+	}
+
+	TestTrue(TEXT("Pawn moved"), FinalLocations[0].Size2D() > 1.0f);
+	for (int32 Index = 1; Index < FinalLocations.Num(); ++Index)
+	{
+		TestEqual(FString::Printf(TEXT("Final location at %.0f fps"), FrameRates[Index]), FinalLocations[Index], FinalLocations[0], 0.01f);
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FS_FixedTimestepCarriedInputTest, "Combax.Movement.FixedTimestep.CarriedInput", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+//~ Input added on a frame too short for a fixed step should move the pawn on the next step instead of being dropped
+bool FS_FixedTimestepCarriedInputTest::RunTest(const FString &Parameters)
+{
+	FCombaxTestWorld World;
+	AS_Character *Character = SpawnFixedStepPawn(World);
+	if (!TestNotNull(TEXT("Spawned pawn"), Character))
+	{
+		return false;
+	}
+
+	//: Settle on the floor first
+	World.TickFor(1.0f, 1.0f / 60.0f);
+	US_CharacterMovement *Movement = Character->GetMovementPtr();
+	TestTrue(TEXT("Pawn landed"), Movement->IsMovingOnGround());
+	const FVector StartLocation = Character->GetActorLocation();
+
+	//: At 300 fps most frames are shorter than a 64 Hz step, tick until one without a step comes up
+	const float DeltaTime = 1.0f / 300.0f;
+	for (int32 Frame = 0; Frame < 8; ++Frame)
+	{
+		const FVector BeforeFrame = Character->GetActorLocation();
+		Character->AddMovementInput(FVector::ForwardVector, 1.0f);
+		World.Tick(DeltaTime);
+		if (Character->GetActorLocation() != BeforeFrame)
+		{
+			//: A step ran and used the input straight away, start over on the next frame
+			Movement->Velocity = FVector::ZeroVector;
+			Character->SetActorLocation(StartLocation);
+			continue;
+		}
+
+		//: No step this frame, nothing else adds input until the pawn moves
+		for (int32 EmptyFrame = 0; EmptyFrame < 8; ++EmptyFrame)
+		{
+			World.Tick(DeltaTime);
+		}
+		TestTrue(TEXT("Input from a frame without a step moved the pawn"), Movement->Velocity.Size2D() > 0.0f);
+		return true;
+	}
+
+	AddError(TEXT("Never got a frame without a fixed step"));
+	return false;
+}
+
+#endif
@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CombaxTestWorld.h"
+#include "Player/S_MovementBenchmark.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+//: Enough pawns per course that per pawn averages are stable, few enough to run in a few seconds under -nullrhi
+static constexpr int32 BenchPawnsPerCourse = 16;
+static constexpr float BenchSeconds = 4.0f;
+static constexpr float BenchFrameTime = 1.0f / 60.0f;
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FS_MovementBenchTest, "Combax.Movement.Bench", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+void FS_MovementBenchTest::GetTests(TArray<FString> &OutBeautifiedNames, TArray<FString> &OutTestCommands) const
+{
+	for (int32 CourseIndex = 0; CourseIndex < static_cast<int32>(ES_BenchCourse::Count); ++CourseIndex)
+	{
+		const FString Name = GetBenchCourseName(static_cast<ES_BenchCourse>(CourseIndex));
+		OutBeautifiedNames.Add(Name.Left(1).ToUpper() + Name.Mid(1));
+		OutTestCommands.Add(FString::FromInt(CourseIndex));
+	}
+}
+
+//~ Runs the pawns of one course through the bench and fails on every budget sv.movement.bench.maxtickms and
+//~ sv.movement.bench.maxsweeps set that the course went over
+bool FS_MovementBenchTest::RunTest(const FString &Parameters)
+{
+	const ES_BenchCourse Course = static_cast<ES_BenchCourse>(FCString::Atoi(*Parameters));
+
+	FCombaxTestWorld World;
+	FS_MovementBenchmark Benchmark(World.Get(), BenchPawnsPerCourse, BenchSeconds, Course);
+
+	//: The bench settles for a second before measuring, and finishes itself on the first tick after its duration
+	World.TickFor(BenchSeconds + 1.0f, BenchFrameTime);
+	World.Tick(BenchFrameTime, 2);
+	Benchmark.Cleanup();
+
+	if (!TestTrue(TEXT("Benchmark finished"), Benchmark.IsFinished()))
+	{
+		return false;
+	}
+
+	const FS_MovementCounters &Totals = Benchmark.GetCourseTotals(Course);
+	TestTrue(TEXT("Pawns ticked while measured"), Totals.Ticks >= BenchPawnsPerCourse * Benchmark.GetMeasuredFrames() / 2);
+	if (Course == ES_BenchCourse::Air)
+	{
+		TestTrue(TEXT("Pawns fell through the air course"), Totals.PhysFallingCalls > 0);
+	}
+
+	for (const FString &Failure : Benchmark.GetFailures())
+	{
+		AddError(Failure);
+	}
+	return Benchmark.HasPassed();
+}
+
+#endif
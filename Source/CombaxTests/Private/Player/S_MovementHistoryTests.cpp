@@ -0,0 +1,102 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CombaxTestWorld.h"
+#include "Player/S_Character.h"
+#include "Player/S_CharacterMovement.h"
+#include "Player/S_MovementHistory.h"
+#include "Player/S_MovementManager.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+static constexpr float HistoryTestRadius = 30.0f;
+static constexpr float HistoryTestHalfHeight = 90.0f;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FS_MovementHistorySegmentTest, "Combax.Movement.Rewind.Segment", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+//~ Shoots at recorded capsules from the side, from above, from inside and past them, and expects the point each shot
+//~ enters the capsule, including for a capsule far enough out that float locations would be off by units
+bool FS_MovementHistorySegmentTest::RunTest(const FString &Parameters)
+{
+	float Fraction = 0.0f;
+	FVector Location;
+
+	FS_MovementHistory History;
+	History.Record(0.0, FVector::ZeroVector, HistoryTestHalfHeight, HistoryTestRadius);
+	History.Record(1.0, FVector(100.0, 0.0, 0.0), HistoryTestHalfHeight, HistoryTestRadius);
+
+	TestTrue(TEXT("Side shot hits"), History.IntersectSegment(FVector(-100.0, 0.0, 0.0), FVector(100.0, 0.0, 0.0), 0.0, Fraction, Location));
+	TestEqual(TEXT("Side shot enters at the surface"), Location, FVector(-30.0, 0.0, 0.0), 0.001);
+	TestEqual(TEXT("Side shot fraction"), Fraction, 0.35f, 0.0001f);
+
+	TestTrue(TEXT("Shot from above hits"), History.IntersectSegment(FVector(0.0, 0.0, 200.0), FVector(0.0, 0.0, -200.0), 0.0, Fraction, Location));
+	TestEqual(TEXT("Shot from above enters at the top"), Location, FVector(0.0, 0.0, 90.0), 0.001);
+
+	TestTrue(TEXT("Shot through the lower sphere hits"), History.IntersectSegment(FVector(-100.0, 0.0, -80.0), FVector(100.0, 0.0, -80.0), 0.0, Fraction, Location));
+	TestEqual(TEXT("Shot through the lower sphere enters on it"), Location.Size2D(), FMath::Sqrt(30.0 * 30.0 - 20.0 * 20.0), 0.001);
+
+	TestTrue(TEXT("Shot ending on the surface hits"), History.IntersectSegment(FVector(-100.0, 0.0, 0.0), FVector(-30.0, 0.0, 0.0), 0.0, Fraction, Location));
+	TestEqual(TEXT("Shot ending on the surface fraction"), Fraction, 1.0f);
+
+	TestTrue(TEXT("Shot from inside hits"), History.IntersectSegment(FVector(10.0, 0.0, 0.0), FVector(100.0, 0.0, 0.0), 0.0, Fraction, Location));
+	TestEqual(TEXT("Shot from inside enters at its start"), Fraction, 0.0f);
+
+	TestFalse(TEXT("Shot past the side misses"), History.IntersectSegment(FVector(-100.0, 31.0, 0.0), FVector(100.0, 31.0, 0.0), 0.0, Fraction, Location));
+	TestFalse(TEXT("Shot over the top misses"), History.IntersectSegment(FVector(-100.0, 0.0, 121.0), FVector(100.0, 0.0, 121.0), 0.0, Fraction, Location));
+	TestFalse(TEXT("Shot stopping short misses"), History.IntersectSegment(FVector(-100.0, 0.0, 0.0), FVector(-31.0, 0.0, 0.0), 0.0, Fraction, Location));
+
+	//: Half way between the samples the capsule is at x 50
+	TestTrue(TEXT("Shot between samples hits"), History.IntersectSegment(FVector(-100.0, 0.0, 0.0), FVector(200.0, 0.0, 0.0), 0.5, Fraction, Location));
+	TestEqual(TEXT("Shot between samples enters the interpolated capsule"), Location, FVector(20.0, 0.0, 0.0), 0.001);
+
+	//: 200 km out, where a float only has a couple of units of precision
+	const FVector Far(2.0e7, -2.0e7, 1.0e5);
+	FS_MovementHistory FarHistory;
+	FarHistory.Record(0.0, Far, HistoryTestHalfHeight, HistoryTestRadius);
+	FarHistory.Record(1.0, Far + FVector(1.0, 0.0, 0.0), HistoryTestHalfHeight, HistoryTestRadius);
+	TestTrue(TEXT("Far shot hits"), FarHistory.IntersectSegment(Far - FVector(100.0, 0.0, 0.0), Far + FVector(100.0, 0.0, 0.0), 0.25, Fraction, Location));
+	TestEqual(TEXT("Far shot enters at the surface"), Location, Far + FVector(-29.75, 0.0, 0.0), 0.001);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FS_MovementRewindTest, "Combax.Movement.Rewind.Manager", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+//~ Rewinds shots against a pawn the server recorded, including one that ends exactly on its capsule
+bool FS_MovementRewindTest::RunTest(const FString &Parameters)
+{
+	FCombaxTestWorld World;
+	AS_Character *Character = World.SpawnPawn(FVector(0.0f, 0.0f, 1000.0f));
+	US_CharacterMovement *Movement = Character ? Character->GetMovementPtr() : nullptr;
+	US_MovementManager *Manager = World.Get()->GetSubsystem<US_MovementManager>();
+	if (!TestNotNull(TEXT("Spawned pawn"), Movement) || !TestNotNull(TEXT("Movement manager"), Manager))
+	{
+		return false;
+	}
+
+	World.Tick(1.0f / 60.0f, 10);
+	const FS_MovementHistory &History = Movement->GetMovementHistory();
+	if (!TestTrue(TEXT("Server recorded the pawn"), History.Num() >= 3))
+	{
+		return false;
+	}
+
+	//: Part way between two frames, so the capsule is interpolated
+	const double ViewTime = (History.GetSample(History.Num() - 3).Time + History.GetSample(History.Num() - 2).Time) * 0.5;
+	FVector Center;
+	float HalfHeight;
+	History.GetCapsuleAt(ViewTime, Center, HalfHeight);
+	const FVector Surface = Center - FVector(History.GetRadius(), 0.0, 0.0);
+
+	FS_RewindHit Hit;
+	TestTrue(TEXT("Shot through the pawn hits"), Manager->RewindSegmentTest(Surface - FVector(500.0, 0.0, 0.0), Center, ViewTime, nullptr, Hit));
+	TestTrue(TEXT("Shot through the pawn hits it"), Hit.Movement == Movement);
+	TestEqual(TEXT("Shot through the pawn enters at the surface"), Hit.Location, Surface, 0.01);
+
+	TestTrue(TEXT("Shot ending on the pawn hits"), Manager->RewindSegmentTest(Surface - FVector(500.0, 0.0, 0.0), Surface, ViewTime, nullptr, Hit));
+	TestEqual(TEXT("Shot ending on the pawn fraction"), Hit.Fraction, 1.0f);
+
+	TestFalse(TEXT("Shooter's own pawn is ignored"), Manager->RewindSegmentTest(Surface - FVector(500.0, 0.0, 0.0), Center, ViewTime, Character, Hit));
+	return true;
+}
+
+#endif
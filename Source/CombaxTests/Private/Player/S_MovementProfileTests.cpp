@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CombaxTestWorld.h"
+#include "Player/S_Character.h"
+#include "Player/S_CharacterMovement.h"
+#include "Player/S_MovementProfile.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+//: Any value the HL2 defaults don't use
+static constexpr float ProfileTestRunSpeed = 400.0f;
+static constexpr float ProfileTestAirSpeedCap = 80.0f;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FS_MovementProfileMigrationTest, "Combax.Movement.Profile.Migration", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+//~ Spawns a pawn whose component carries old tunables, the way a blueprint saved before profiles would, and expects them
+//~ to run as its own profile until the pawn is given a real one
+bool FS_MovementProfileMigrationTest::RunTest(const FString &Parameters)
+{
+	FCombaxTestWorld World;
+
+	const FTransform SpawnTransform(FVector(0.0f, 0.0f, 10000.0f));
+	AS_Character *Character = World.Get()->SpawnActorDeferred<AS_Character>(AS_Character::StaticClass(), SpawnTransform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+	US_CharacterMovement *Movement = Character ? Character->GetMovementPtr() : nullptr;
+	if (!TestNotNull(TEXT("Spawned pawn"), Movement))
+	{
+		return false;
+	}
+	TestTrue(TEXT("Set old run speed"), SetTestProperty(Movement, TEXT("RunSpeed_DEPRECATED"), ProfileTestRunSpeed));
+	TestTrue(TEXT("Set old air speed cap"), SetTestProperty(Movement, TEXT("AirSpeedCap_DEPRECATED"), ProfileTestAirSpeedCap));
+	Character->FinishSpawning(SpawnTransform);
+
+	const FS_MovementProfileSettings Defaults;
+	TestNull(TEXT("Pawn profile"), Character->GetMovementProfile());
+	TestNotNull(TEXT("Migrated profile in use"), Movement->GetMovementProfile());
+	TestEqual(TEXT("Migrated run speed"), Movement->GetProfileSettings().RunSpeed, ProfileTestRunSpeed);
+	TestEqual(TEXT("Migrated air speed cap"), Movement->GetProfileSettings().AirSpeedCap, ProfileTestAirSpeedCap);
+	TestEqual(TEXT("Engine run speed"), Movement->MaxWalkSpeed, ProfileTestRunSpeed);
+	TestEqual(TEXT("Untouched tunable"), Movement->GetProfileSettings().SprintSpeed, Defaults.SprintSpeed);
+
+	US_MovementProfile *Profile = NewObject<US_MovementProfile>();
+	Character->SetMovementProfile(Profile);
+	TestEqual(TEXT("Run speed with a profile on the pawn"), Movement->GetProfileSettings().RunSpeed, Defaults.RunSpeed);
+
+	Character->SetMovementProfile(nullptr);
+	TestEqual(TEXT("Run speed after dropping the pawn's profile"), Movement->GetProfileSettings().RunSpeed, ProfileTestRunSpeed);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FS_MovementProfileDefaultTest, "Combax.Movement.Profile.Default", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+//~ A pawn that never set the old tunables has nothing to migrate and runs the HL2 defaults
+bool FS_MovementProfileDefaultTest::RunTest(const FString &Parameters)
+{
+	FCombaxTestWorld World;
+	AS_Character *Character = World.SpawnPawn(FVector(0.0f, 0.0f, 10000.0f));
+	US_CharacterMovement *Movement = Character ? Character->GetMovementPtr() : nullptr;
+	if (!TestNotNull(TEXT("Spawned pawn"), Movement))
+	{
+		return false;
+	}
+
+	TestNull(TEXT("Movement profile"), Movement->GetMovementProfile());
+	TestEqual(TEXT("Run speed"), Movement->GetProfileSettings().RunSpeed, FS_MovementProfileSettings().RunSpeed);
+	return true;
+}
+
+#endif
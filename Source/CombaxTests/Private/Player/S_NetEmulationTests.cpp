@@ -0,0 +1,196 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
+
+#include "Editor.h"
+#include "EngineUtils.h"
+#include "Settings/LevelEditorPlaySettings.h"
+#include "Tests/AutomationCommon.h"
+#include "Tests/AutomationEditorCommon.h"
+#include "Player/S_Character.h"
+#include "Player/S_CharacterMovement.h"
+
+static const TCHAR *NetTestMap = TEXT("/Game/Mine/Map/MAP_Cannons");
+
+//: A listen server and two remote clients, all in this editor process
+static constexpr int32 NetTestPlayers = 3;
+static constexpr float NetTestSeconds = 20.0f;
+static constexpr float NetTestStartTimeout = 30.0f;
+
+//: Lag in each direction and loss on top, roughly a bad cross country connection
+static constexpr int32 NetTestMinLatencyMs = 60;
+static constexpr int32 NetTestMaxLatencyMs = 90;
+static constexpr int32 NetTestPacketLossPercent = 1;
+
+//: Strafe jumping at sprint speed shouldn't need correcting more than one server move in twenty
+static constexpr float NetTestMaxCorrectionRatio = 0.05f;
+
+//? Shared between the latent commands of one run
+struct FS_NetTestRun
+{
+	double StartTime = 0.0;
+	int32 DrivenFrames = 0;
+};
+
+static void ForEachPlayWorld(ENetMode NetMode, TFunctionRef<void(UWorld *)> Function)
+{
+	for (const FWorldContext &Context : GEngine->GetWorldContexts())
+	{
+		UWorld *World = Context.World();
+		if (Context.WorldType == EWorldType::PIE && World && World->GetNetMode() == NetMode)
+		{
+			Function(World);
+		}
+	}
+}
+
+//~ Locally controlled pawns of every remote client
+static TArray<AS_Character *> GetClientPawns()
+{
+	TArray<AS_Character *> Pawns;
+	ForEachPlayWorld(NM_Client, [&Pawns](UWorld *World)
+	{
+		for (TActorIterator<AS_Character> It(World); It; ++It)
+		{
+			if (It->IsLocallyControlled())
+			{
+				Pawns.Add(*It);
+			}
+		}
+	});
+	return Pawns;
+}
+
+DEFINE_LATENT_AUTOMATION_COMMAND(FS_StartNetEmulatedPlay);
+
+//~ Listen server plus clients in one process, with the editor's network emulation on every connection
+bool FS_StartNetEmulatedPlay::Update()
+{
+	ULevelEditorPlaySettings *PlaySettings = NewObject<ULevelEditorPlaySettings>();
+	PlaySettings->SetPlayNetMode(EPlayNetMode::PIE_ListenServer);
+	PlaySettings->SetPlayNumberOfClients(NetTestPlayers);
+	PlaySettings->SetRunUnderOneProcess(true);
+	PlaySettings->bLaunchSeparateServer = false;
+
+	FLevelEditorPlayNetworkEmulationSettings &Emulation = PlaySettings->NetworkEmulationSettings;
+	Emulation.bIsNetworkEmulationEnabled = true;
+	Emulation.EmulationTarget = NetworkEmulationTarget::Any;
+	for (FNetworkEmulationPacketSettings *Packets : {&Emulation.OutPackets, &Emulation.InPackets})
+	{
+		Packets->MinLatency = NetTestMinLatencyMs;
+		Packets->MaxLatency = NetTestMaxLatencyMs;
+		Packets->PacketLossPercentage = NetTestPacketLossPercent;
+	}
+
+	FRequestPlaySessionParams Params;
+	Params.WorldType = EPlaySessionWorldType::PlayInEditor;
+	Params.EditorPlaySettings = PlaySettings;
+	GEditor->RequestPlaySession(Params);
+	return true;
+}
+
+DEFINE_LATENT_AUTOMATION_COMMAND_TWO_PARAMETER(FS_WaitForNetClients, FAutomationTestBase *, Test, TSharedRef<FS_NetTestRun>, Run);
+
+bool FS_WaitForNetClients::Update()
+{
+	const double Now = FPlatformTime::Seconds();
+	if (Run->StartTime == 0.0)
+	{
+		Run->StartTime = Now;
+	}
+
+	if (GetClientPawns().Num() >= NetTestPlayers - 1)
+	{
+		Run->StartTime = 0.0;
+		return true;
+	}
+	if (Now - Run->StartTime > NetTestStartTimeout)
+	{
+		Test->AddError(TEXT("Clients never got a pawn"));
+		return true;
+	}
+	return false;
+}
+
+DEFINE_LATENT_AUTOMATION_COMMAND_ONE_PARAMETER(FS_DriveNetClients, TSharedRef<FS_NetTestRun>, Run);
+
+//~ Strafe jumps every client pawn around, switching sprint on and off so the compressed flags change, until the time is up
+bool FS_DriveNetClients::Update()
+{
+	const double Now = FPlatformTime::Seconds();
+	if (Run->StartTime == 0.0)
+	{
+		Run->StartTime = Now;
+	}
+	const float Time = float(Now - Run->StartTime);
+
+	for (AS_Character *Character : GetClientPawns())
+	{
+		const FRotator Facing(0.0f, Time * 45.0f, 0.0f);
+		Character->AddMovementInput(Facing.Vector(), 1.0f);
+		Character->AddMovementInput(FRotationMatrix(Facing).GetScaledAxis(EAxis::Y), FMath::Sin(Time * 3.0f));
+		Character->SetSprinting(FMath::Fmod(Time, 4.0f) < 2.0f);
+		if (FMath::Fmod(Time, 1.5f) < 0.1f)
+		{
+			Character->Jump();
+		}
+		else
+		{
+			Character->StopJumping();
+		}
+	}
+
+	++Run->DrivenFrames;
+	return Time >= NetTestSeconds;
+}
+
+DEFINE_LATENT_AUTOMATION_COMMAND_TWO_PARAMETER(FS_CheckNetCorrections, FAutomationTestBase *, Test, TSharedRef<FS_NetTestRun>, Run);
+
+//~ Sums what the server did with the remote clients' moves and fails when it corrected too many of them
+bool FS_CheckNetCorrections::Update()
+{
+	FS_MovementCounters Totals;
+	int32 RemotePawns = 0;
+	ForEachPlayWorld(NM_ListenServer, [&Totals, &RemotePawns](UWorld *World)
+	{
+		for (TActorIterator<AS_Character> It(World); It; ++It)
+		{
+			if (It->GetRemoteRole() == ROLE_AutonomousProxy && It->GetMovementPtr())
+			{
+				Totals += It->GetMovementPtr()->GetMovementCounters();
+				++RemotePawns;
+			}
+		}
+	});
+
+	const float CorrectionRatio = Totals.ServerMoveResponses > 0 ? float(Totals.Corrections) / Totals.ServerMoveResponses : 1.0f;
+	Test->AddInfo(FString::Printf(TEXT("%d remote pawns over %d frames: %d server moves, %d corrections (%.2f%%), %d deferred, %d client positions accepted"), RemotePawns, Run->DrivenFrames,
+								  Totals.ServerMoveResponses, Totals.Corrections, CorrectionRatio * 100.0f, Totals.CorrectionsDeferred, Totals.ClientPositionsAccepted));
+
+	Test->TestEqual(TEXT("Remote pawns on the server"), RemotePawns, NetTestPlayers - 1);
+	Test->TestTrue(TEXT("Server received moves"), Totals.ServerMoveResponses > 0);
+	Test->TestTrue(FString::Printf(TEXT("Correction ratio %.3f under %.3f"), CorrectionRatio, NetTestMaxCorrectionRatio), CorrectionRatio <= NetTestMaxCorrectionRatio);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FS_NetEmulationTest, "Combax.Movement.Net.EmulatedLag", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+//~ Plays a listen server with two clients under emulated lag and loss, drives the clients and checks how often the
+//~ server had to correct them
+bool FS_NetEmulationTest::RunTest(const FString &Parameters)
+{
+	FAutomationEditorCommonUtils::LoadMap(NetTestMap);
+
+	const TSharedRef<FS_NetTestRun> Run = MakeShared<FS_NetTestRun>();
+	ADD_LATENT_AUTOMATION_COMMAND(FS_StartNetEmulatedPlay());
+	ADD_LATENT_AUTOMATION_COMMAND(FS_WaitForNetClients(this, Run));
+	ADD_LATENT_AUTOMATION_COMMAND(FS_DriveNetClients(Run));
+	ADD_LATENT_AUTOMATION_COMMAND(FS_CheckNetCorrections(this, Run));
+	ADD_LATENT_AUTOMATION_COMMAND(FEndPlayMapCommand());
+	return true;
+}
+
+#endif
@@ -0,0 +1,231 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Player/S_MovementProfile.h"
+#include "Player/S_RepMovement.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+//: Updates a second a pawn is sent at, and how long the trace runs
+static constexpr float RepTestUpdateRate = 30.0f;
+static constexpr float RepTestSeconds = 10.0f;
+
+//? One server update of a pawn strafe jumping in circles, far enough from the origin that whole locations aren't small
+struct FS_RepTestTrace
+{
+	FVector Location = FVector(12000.0, -3500.0, 200.0);
+	FVector Velocity = FVector::ZeroVector;
+	float Time = 0.0f;
+
+	FRepMovement Advance()
+	{
+		const float DeltaTime = 1.0f / RepTestUpdateRate;
+		Time += DeltaTime;
+
+		const FRotator Facing(0.0f, Time * 45.0f, 0.0f);
+		const float Speed = FMath::Min(400.0f + Time * 30.0f, 700.0f);
+		const float JumpTime = FMath::Fmod(Time, 1.0f);
+		Velocity = FVector(Facing.Vector() * Speed) + FVector(0.0, 0.0, JumpTime < 0.55f ? 270.0f - 980.0f * JumpTime : 0.0f);
+		Location += Velocity * DeltaTime;
+
+		FRepMovement Movement;
+		Movement.Location = Location;
+		Movement.LinearVelocity = Velocity;
+		Movement.Rotation = FRotator(0.0f, Facing.Yaw + 20.0f * FMath::Sin(Time), 0.0f);
+		return Movement;
+	}
+};
+
+//~ Writes Server's state the way the replication system would, against the base it kept for the connection. Returns
+//~ the bits written, zero when nothing changed.
+static int64 WriteRepUpdate(FS_RepMovement &Server, TSharedPtr<INetDeltaBaseState> &Base, FNetBitWriter &Writer)
+{
+	TSharedPtr<INetDeltaBaseState> NewState;
+	FNetDeltaSerializeInfo DeltaParms;
+	DeltaParms.Writer = &Writer;
+	DeltaParms.OldState = Base.Get();
+	DeltaParms.NewState = &NewState;
+	if (!Server.NetDeltaSerialize(DeltaParms))
+	{
+		return 0;
+	}
+	Base = NewState;
+	return Writer.GetNumBits();
+}
+
+static bool ReadRepUpdate(FS_RepMovement &Client, FNetBitWriter &Writer)
+{
+	FNetBitReader Reader(nullptr, Writer.GetData(), Writer.GetNumBits());
+	FNetDeltaSerializeInfo DeltaParms;
+	DeltaParms.Reader = &Reader;
+	return Client.NetDeltaSerialize(DeltaParms) && !Reader.IsError();
+}
+
+static bool IsSameMovement(const FS_RepMovement &A, const FS_RepMovement &B)
+{
+	FRepMovement MovementA;
+	FRepMovement MovementB;
+	A.Get(MovementA);
+	B.Get(MovementB);
+	return MovementA.Location == MovementB.Location && MovementA.LinearVelocity == MovementB.LinearVelocity && MovementA.Rotation == MovementB.Rotation;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FS_RepMovementRoundTripTest, "Combax.Movement.RepMovement.RoundTrip", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+//~ Sends a strafe jumping trace through the delta encoding, expects the client to decode exactly what the server quantized,
+//~ and logs the bytes per update next to whole states and the engine's FRepMovement at its default quantization
+bool FS_RepMovementRoundTripTest::RunTest(const FString &Parameters)
+{
+	const float AxisSpeedLimit = FS_MovementProfileSettings().AxisSpeedLimit;
+
+	FS_RepTestTrace Trace;
+	FS_RepMovement Server;
+	FS_RepMovement Client;
+	TSharedPtr<INetDeltaBaseState> Base;
+
+	int32 Updates = 0;
+	int32 Mismatches = 0;
+	double MaxLocationError = 0.0;
+	double MaxVelocityError = 0.0;
+	int64 DeltaBits = 0;
+	int64 WholeBits = 0;
+	int64 EngineBits = 0;
+	for (int32 Update = 0; Update < FMath::RoundToInt(RepTestSeconds * RepTestUpdateRate); ++Update)
+	{
+		FRepMovement Movement = Trace.Advance();
+		Server.Set(Movement, false, false, AxisSpeedLimit);
+
+		FNetBitWriter Writer(nullptr, 1024);
+		const int64 Bits = WriteRepUpdate(Server, Base, Writer);
+		if (!TestTrue(TEXT("Update written"), Bits > 0) || !TestTrue(TEXT("Update read"), ReadRepUpdate(Client, Writer)))
+		{
+			return false;
+		}
+		TestTrue(TEXT("Client has a new state"), Client.ConsumeReceivedState());
+
+		++Updates;
+		Mismatches += IsSameMovement(Client, Server) ? 0 : 1;
+		FRepMovement Received;
+		Client.Get(Received);
+		MaxLocationError = FMath::Max(MaxLocationError, (Received.Location - Movement.Location).GetAbsMax());
+		MaxVelocityError = FMath::Max(MaxVelocityError, (Received.LinearVelocity - Movement.LinearVelocity).GetAbsMax());
+
+		//: The first update has no base and goes out whole
+		DeltaBits += Update > 0 ? Bits : 0;
+		WholeBits += Server.GetWholeStateBits();
+		FNetBitWriter EngineWriter(nullptr, 1024);
+		bool bSuccess = true;
+		Movement.NetSerialize(EngineWriter, nullptr, bSuccess);
+		EngineBits += EngineWriter.GetNumBits();
+	}
+
+	const double DeltaBytes = DeltaBits / 8.0 / (Updates - 1);
+	const double WholeBytes = WholeBits / 8.0 / Updates;
+	const double EngineBytes = EngineBits / 8.0 / Updates;
+	AddInfo(FString::Printf(TEXT("%d updates at %.0f Hz: %.2f bytes per delta, %.2f per whole state, %.2f with FRepMovement, %.0f bytes a second per connection"), Updates,
+							RepTestUpdateRate, DeltaBytes, WholeBytes, EngineBytes, DeltaBytes * RepTestUpdateRate));
+
+	TestEqual(TEXT("Updates decoded differently from the server"), Mismatches, 0);
+	TestTrue(FString::Printf(TEXT("Location error %.3f within a twentieth of a unit"), MaxLocationError), MaxLocationError <= 0.05 + KINDA_SMALL_NUMBER);
+	TestTrue(FString::Printf(TEXT("Velocity error %.3f within half a fixed point step"), MaxVelocityError), MaxVelocityError <= AxisSpeedLimit / 32767.0 * 0.5 + KINDA_SMALL_NUMBER);
+	TestTrue(TEXT("Deltas smaller than whole states"), DeltaBytes < WholeBytes);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FS_RepMovementDroppedTest, "Combax.Movement.RepMovement.DroppedPacket", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+//~ Drops an update, expects the client to skip the delta built on it, then to take the next one once the server base is
+//~ rolled back to what the client has, as the replication system does when the packet is nacked
+bool FS_RepMovementDroppedTest::RunTest(const FString &Parameters)
+{
+	const float AxisSpeedLimit = FS_MovementProfileSettings().AxisSpeedLimit;
+
+	FS_RepTestTrace Trace;
+	FS_RepMovement Server;
+	FS_RepMovement Client;
+	TSharedPtr<INetDeltaBaseState> Base;
+
+	//: Arrives
+	Server.Set(Trace.Advance(), false, false, AxisSpeedLimit);
+	FNetBitWriter First(nullptr, 1024);
+	WriteRepUpdate(Server, Base, First);
+	TestTrue(TEXT("First update read"), ReadRepUpdate(Client, First));
+	TestTrue(TEXT("First update applied"), Client.ConsumeReceivedState());
+	const TSharedPtr<INetDeltaBaseState> AckedBase = Base;
+	const FS_RepMovement Acked = Server;
+
+	//: Lost
+	Server.Set(Trace.Advance(), true, false, AxisSpeedLimit);
+	FNetBitWriter Dropped(nullptr, 1024);
+	WriteRepUpdate(Server, Base, Dropped);
+
+	//: Built on the lost one, so it can't be applied
+	Server.Set(Trace.Advance(), true, false, AxisSpeedLimit);
+	FNetBitWriter OnDropped(nullptr, 1024);
+	WriteRepUpdate(Server, Base, OnDropped);
+	TestTrue(TEXT("Update on a lost base read"), ReadRepUpdate(Client, OnDropped));
+	TestFalse(TEXT("Update on a lost base applied"), Client.ConsumeReceivedState());
+	TestTrue(TEXT("Client kept the acked state"), IsSameMovement(Client, Acked) && !Client.IsSprinting());
+
+	//: Nacked, the base goes back to the acked state and the next update is built on that
+	Base = AckedBase;
+	Server.Set(Trace.Advance(), true, false, AxisSpeedLimit);
+	FNetBitWriter Resent(nullptr, 1024);
+	WriteRepUpdate(Server, Base, Resent);
+	TestTrue(TEXT("Update after the roll back read"), ReadRepUpdate(Client, Resent));
+	TestTrue(TEXT("Update after the roll back applied"), Client.ConsumeReceivedState());
+	TestTrue(TEXT("Client caught up with the server"), IsSameMovement(Client, Server) && Client.IsSprinting());
+
+	//: And later ones follow on from it
+	Server.Set(Trace.Advance(), false, false, AxisSpeedLimit);
+	FNetBitWriter Next(nullptr, 1024);
+	WriteRepUpdate(Server, Base, Next);
+	TestTrue(TEXT("Following update read"), ReadRepUpdate(Client, Next));
+	TestTrue(TEXT("Following update applied"), Client.ConsumeReceivedState() && IsSameMovement(Client, Server));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FS_RepMovementFlagsTest, "Combax.Movement.RepMovement.Flags", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+//~ Toggles sprint and walk across deltas and expects the client to follow, with the flags only on the wire when they change
+bool FS_RepMovementFlagsTest::RunTest(const FString &Parameters)
+{
+	const float AxisSpeedLimit = FS_MovementProfileSettings().AxisSpeedLimit;
+
+	FS_RepMovement Server;
+	FS_RepMovement Client;
+	TSharedPtr<INetDeltaBaseState> Base;
+
+	//: Same movement every time, so only the flags differ between the sizes
+	FRepMovement Movement;
+	Movement.Location = FVector(12000.0, -3500.0, 200.0);
+	Movement.LinearVelocity = FVector(300.0, 0.0, 0.0);
+
+	const bool Sprinting[] = {false, true, true, false, false};
+	const bool WantsToWalk[] = {false, false, false, true, true};
+	int64 LastBits = 0;
+	for (int32 Update = 0; Update < int32(UE_ARRAY_COUNT(Sprinting)); ++Update)
+	{
+		Movement.Location.X += 10.0;
+		Server.Set(Movement, Sprinting[Update], WantsToWalk[Update], AxisSpeedLimit);
+
+		FNetBitWriter Writer(nullptr, 1024);
+		const int64 Bits = WriteRepUpdate(Server, Base, Writer);
+		if (!TestTrue(TEXT("Update read"), ReadRepUpdate(Client, Writer)) || !TestTrue(TEXT("Update applied"), Client.ConsumeReceivedState()))
+		{
+			return false;
+		}
+		TestEqual(FString::Printf(TEXT("Sprinting after update %d"), Update), Client.IsSprinting(), Sprinting[Update]);
+		TestEqual(FString::Printf(TEXT("Wants to walk after update %d"), Update), Client.WantsToWalk(), WantsToWalk[Update]);
+
+		//: Updates 1 and 3 change the flags, 2 and 4 repeat them
+		if (Update == 2 || Update == 4)
+		{
+			TestEqual(FString::Printf(TEXT("Bits saved by unchanged flags in update %d"), Update), LastBits - Bits, int64(FS_RepMovement::NumFlagBits));
+		}
+		LastBits = Bits;
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CombaxTestWorld.h"
+#include "Player/S_Character.h"
+#include "Player/S_CharacterMovement.h"
+#include "Player/S_MoveKernel.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+//? Step limits the inline formula CalcVelocity used to run wrote at one speed, with the default tunables
+struct FS_StepLimitsBaseline
+{
+	float Speed;
+	float SurfaceFriction;
+	bool bFalling;
+	float StepHeight;
+	float WalkableFloorZ;
+};
+
+//: Worked out by hand from the old formula. Walk, run and sprint are all below SpeedMultMin (1036.32), the ramp ends at
+//: SpeedMultMax (1524) and full friction ground never scales down.
+static const FS_StepLimitsBaseline StepLimitsBaselines[] = {
+	{0.0f, 0.0f, true, 34.29f, 0.7f},
+	{285.75f, 0.0f, true, 34.29f, 0.7f},
+	{361.9f, 0.0f, true, 34.29f, 0.7f},
+	{609.6f, 0.0f, true, 34.29f, 0.7f},
+	{1158.24f, 0.0f, true, 32.771875f, 0.7178f},
+	{1280.16f, 0.0f, true, 28.2175f, 0.7712f},
+	{1280.16f, 0.5f, false, 31.25375f, 0.7356f},
+	{1524.0f, 0.5f, false, 22.145f, 0.8424f},
+	{2000.0f, 0.0f, true, 10.0f, 0.9848f},
+	{2000.0f, 1.0f, false, 34.29f, 0.7f},
+};
+
+static constexpr float StepLimitsTolerance = 1e-4f;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FS_StepLimitsBaselineTest, "Combax.Movement.StepLimits.Baseline", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+//~ Expects the kernel to give the old formula's limits at rest, walking, running, sprinting, on the ramp and past the cap
+bool FS_StepLimitsBaselineTest::RunTest(const FString &Parameters)
+{
+	const FSourceStepLimitSettings Settings = GetDefault<US_CharacterMovement>()->GetStepLimitSettings();
+	for (const FS_StepLimitsBaseline &Baseline : StepLimitsBaselines)
+	{
+		const float Multiplier = FSourceMoveKernel::GetSlopeSpeedMultiplier(Baseline.Speed, Settings.SpeedMultMin, Settings.SpeedMultMax, Baseline.SurfaceFriction, Baseline.bFalling);
+		const FSourceStepLimits Limits = FSourceMoveKernel::GetStepLimits(Settings, Multiplier);
+
+		const FString Where = FString::Printf(TEXT("at %.2f with friction %.1f%s"), Baseline.Speed, Baseline.SurfaceFriction, Baseline.bFalling ? TEXT(" falling") : TEXT(""));
+		TestEqual(FString::Printf(TEXT("Step height %s"), *Where), Limits.StepHeight, Baseline.StepHeight, StepLimitsTolerance);
+		TestEqual(FString::Printf(TEXT("Walkable floor Z %s"), *Where), Limits.WalkableFloorZ, Baseline.WalkableFloorZ, StepLimitsTolerance);
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FS_StepLimitsComponentTest, "Combax.Movement.StepLimits.Component", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+//~ Throws a pawn through the air at the baseline speeds and checks the limits its tick leaves behind, including when the
+//~ walkable floor setter is skipped because nothing changed
+bool FS_StepLimitsComponentTest::RunTest(const FString &Parameters)
+{
+	FCombaxTestWorld World;
+	AS_Character *Character = World.SpawnPawn(FVector(0.0f, 0.0f, 100000.0f));
+	if (!TestNotNull(TEXT("Spawned pawn"), Character))
+	{
+		return false;
+	}
+	US_CharacterMovement *Movement = Character->GetMovementPtr();
+	Movement->SetMovementMode(MOVE_Falling);
+
+	for (const FS_StepLimitsBaseline &Baseline : StepLimitsBaselines)
+	{
+		if (!Baseline.bFalling)
+		{
+			continue;
+		}
+
+		Character->SetActorLocation(FVector(0.0f, 0.0f, 100000.0f));
+		Movement->Velocity = FVector(Baseline.Speed, 0.0f, 0.0f);
+		World.Tick(1.0f / 60.0f);
+
+		TestTrue(FString::Printf(TEXT("Still falling at %.2f"), Baseline.Speed), Movement->IsFalling());
+		TestEqual(FString::Printf(TEXT("Step height at %.2f"), Baseline.Speed), Movement->MaxStepHeight, Baseline.StepHeight, StepLimitsTolerance);
+		TestEqual(FString::Printf(TEXT("Walkable floor Z at %.2f"), Baseline.Speed), Movement->GetWalkableFloorZ(), Baseline.WalkableFloorZ, StepLimitsTolerance);
+	}
+	return true;
+}
+
+#endif
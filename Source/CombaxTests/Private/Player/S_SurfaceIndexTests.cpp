@@ -0,0 +1,132 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CombaxTestWorld.h"
+#include "Components/BoxComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "Engine/Level.h"
+#include "Player/S_CharacterMovement.h"
+#include "Player/S_SurfaceIndex.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+//: Far enough out that a float only resolves every other unit, and off the grid of representable floats
+static const FVector SurfaceTestLocation(20000000.75, -15000000.25, 1000.0);
+static constexpr float SurfaceTestExtent = 50.0f;
+
+//~ Static pawn blocking box at Location, added after the index was built
+static UBoxComponent *SpawnStaticBox(FCombaxTestWorld &World, const FVector &Location, const FVector &Extent)
+{
+	AActor *Actor = World.Get()->SpawnActor<AActor>(AActor::StaticClass(), FTransform(Location));
+	if (!Actor)
+	{
+		return nullptr;
+	}
+
+	UBoxComponent *Box = NewObject<UBoxComponent>(Actor);
+	Box->SetMobility(EComponentMobility::Static);
+	Box->SetBoxExtent(Extent);
+	Box->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+	Actor->SetRootComponent(Box);
+	Box->SetWorldLocation(Location);
+	Box->RegisterComponent();
+	return Box;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FS_SurfaceIndexLevelTest, "Combax.Movement.SurfaceIndex.Level", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+//~ Indexes a box far from the origin with its level, finds its top face as one quad under a capsule standing across the
+//~ face's diagonal, then drops it with the level
+bool FS_SurfaceIndexLevelTest::RunTest(const FString &Parameters)
+{
+	FCombaxTestWorld World;
+	US_SurfaceIndex *Index = World.Get()->GetSubsystem<US_SurfaceIndex>();
+	UBoxComponent *Box = SpawnStaticBox(World, SurfaceTestLocation, FVector(SurfaceTestExtent));
+	if (!TestNotNull(TEXT("Surface index"), Index) || !TestNotNull(TEXT("Spawned box"), Box))
+	{
+		return false;
+	}
+
+	ULevel *Level = World.Get()->PersistentLevel;
+	Index->AddLevel(Level);
+	Index->AddLevel(Level);
+	TestEqual(TEXT("Upward faces after indexing the level twice"), Index->NumFaces(), 1);
+
+	//: Centred on the face with half a unit to spare, which rounding the corners to floats out here would eat
+	const FVector Top = SurfaceTestLocation + FVector(0.0, 0.0, SurfaceTestExtent);
+	const FS_SurfaceFace *Face = Index->FindFace(Box, Top, Top + FVector(0.0, 0.0, 90.0), SurfaceTestExtent - 0.5f);
+	if (TestNotNull(TEXT("Face under a capsule covering most of the top"), Face))
+	{
+		TestEqual(TEXT("Top face vertices"), Face->NumVertices, 4);
+		TestEqual(TEXT("Top face normal"), Face->Normal, FVector::UpVector, 1e-6f);
+	}
+	TestNull(TEXT("Face under a capsule hanging over the edge"), Index->FindFace(Box, Top, Top + FVector(1.0, 0.0, 90.0), SurfaceTestExtent - 0.5f));
+
+	Index->RemoveLevel(Level);
+	TestEqual(TEXT("Faces after removing the level"), Index->NumFaces(), 0);
+	TestEqual(TEXT("Cells after removing the level"), Index->NumCells(), 0);
+	TestNull(TEXT("Face after removing the level"), Index->FindFace(Box, Top, Top, 1.0f));
+	return true;
+}
+
+//~ Drops a pawn onto a floor with its top at Z 0, either a static box the index knows or a movable cube it skips, and
+//~ returns its movement once it has landed
+static US_CharacterMovement *DropOnFloor(FAutomationTestBase &Test, FCombaxTestWorld &World, bool bIndexedFloor)
+{
+	US_SurfaceIndex *Index = World.Get()->GetSubsystem<US_SurfaceIndex>();
+	if (!Test.TestNotNull(TEXT("Surface index"), Index))
+	{
+		return nullptr;
+	}
+
+	const bool bSpawnedFloor = bIndexedFloor ? SpawnStaticBox(World, FVector(0.0, 0.0, -50.0), FVector(500.0, 500.0, 50.0)) != nullptr
+											 : World.SpawnFloor(FVector(10.0f, 10.0f, 1.0f)) != nullptr;
+	if (!Test.TestTrue(TEXT("Spawned floor"), bSpawnedFloor))
+	{
+		return nullptr;
+	}
+	Index->AddLevel(World.Get()->PersistentLevel);
+	Test.TestEqual(TEXT("Upward faces indexed"), Index->NumFaces(), bIndexedFloor ? 1 : 0);
+
+	AS_Character *Character = World.SpawnPawn(FVector(0.0f, 0.0f, 300.0f));
+	if (!Test.TestNotNull(TEXT("Spawned pawn"), Character))
+	{
+		return nullptr;
+	}
+	US_CharacterMovement *Movement = Character->GetMovementPtr();
+	Movement->SetMovementMode(MOVE_Falling);
+	Movement->ResetMovementCounters();
+
+	World.TickFor(1.0f, 1.0f / 60.0f);
+	Test.TestTrue(TEXT("Pawn landed"), Movement->IsMovingOnGround());
+	return Movement;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FS_SurfaceIndexLandingTest, "Combax.Movement.SurfaceIndex.Landing", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+//~ A landing on an indexed box face is answered by the index, a landing on a mesh the index skips falls back to the floor
+//~ query, and the pawn ends up standing either way
+bool FS_SurfaceIndexLandingTest::RunTest(const FString &Parameters)
+{
+	FS_ScopedConsoleVariable SurfaceIndex(TEXT("sv.surfaceindex"), 1);
+
+	{
+		FCombaxTestWorld World;
+		if (const US_CharacterMovement *Movement = DropOnFloor(*this, World, true))
+		{
+			TestTrue(TEXT("Landings on the indexed box answered by the index"), Movement->GetMovementCounters().SurfaceIndexHits > 0);
+		}
+	}
+
+	{
+		FCombaxTestWorld World;
+		if (const US_CharacterMovement *Movement = DropOnFloor(*this, World, false))
+		{
+			TestEqual(TEXT("Landings on the unindexed mesh answered by the index"), Movement->GetMovementCounters().SurfaceIndexHits, 0);
+			TestTrue(TEXT("Landings on the unindexed mesh sent to the floor query"), Movement->GetMovementCounters().SurfaceIndexMisses > 0);
+		}
+	}
+	return true;
+}
+
+#endif